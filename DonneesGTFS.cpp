@@ -2,7 +2,15 @@
 // Created by Mario Marchand on 16-12-29.
 //
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <future>
+#include <unistd.h>
 #include "DonneesGTFS.h"
+#include "schemas_gtfs.h"
 
 using namespace std;
 
@@ -12,7 +20,10 @@ using namespace std;
 //! \param[in] p_now2: l'heure de fin de l'intervalle considéré
 //! \brief Ces deux heures définissent l'intervalle de temps du GTFS; seuls les moments de [p_now1, p_now2) sont considérés
 DonneesGTFS::DonneesGTFS(const Date &p_date, const Heure &p_now1, const Heure &p_now2)
-        : m_date(p_date), m_now1(p_now1), m_now2(p_now2), m_nbArrets(0), m_tousLesArretsPresents(false)
+        : m_date(p_date), m_now1(p_now1), m_now2(p_now2), m_nbArrets(0), m_tousLesArretsPresents(false), m_version(0),
+          m_stations(std::less<unsigned int>(), TableStations::allocator_type(&m_arene)),
+          m_voyages(std::less<string>(), TableVoyages::allocator_type(&m_arene)),
+          m_lignes_par_numero(std::less<string>(), decltype(m_lignes_par_numero)::allocator_type(&m_arene))
 {
 }
 
@@ -41,33 +52,7 @@ void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
         ifstream file(p_nomFichier);
 
         if (file.good()) {
-            string line;
-            getline(file, line);
-
-            vector<string> headers = string_to_vector(line, ',');
-            std::unordered_map<string, unsigned int> headers_map = {
-                    {"route_id",         0},
-                    {"route_short_name", 2},
-                    {"route_desc",       4},
-                    {"route_color",      7}
-            };
-
-            for (line; getline(file, line);) {
-                vector<string> champs = string_to_vector(line, ',');
-
-                line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-
-                Ligne ligne(
-                        (unsigned) stoi(champs[headers_map.at("route_id")]),
-                        champs[headers_map.at("route_short_name")],
-                        champs[headers_map.at("route_desc")],
-                        Ligne::couleurToCategorie(champs[headers_map.at("route_color")])
-                );
-
-                m_lignes.insert({ligne.getId(), ligne});
-                m_lignes_par_numero.insert({ligne.getNumero(), ligne});
-            }
+            lireLignes(file, m_statistiques);
         } else {
 
         }
@@ -76,50 +61,82 @@ void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
     }
 }
 
+//! \brief lit les données d'un flux au format routes.txt déjà positionné au début de l'en-tête
+//! \brief une couleur inconnue donne la catégorie CategorieBus::LEBUS; ValidateurGTFS la rapporte (COULEUR_INCONNUE)
+//! \param[in] file: le flux à lire
+//! \param[in,out] p_statistiques: les mesures de chargement à compléter
+void DonneesGTFS::lireLignes(std::istream &file, StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "lignes");
+
+    LecteurTable<RangeeRoutes> lecteur(file);
+    lecteur.signalerA(m_diagnostics, "routes.txt");
+    RangeeRoutes rangee;
+
+    while (lecteur.suivante(rangee)) {
+        CategorieBus categorie = CategorieBus::LEBUS;
+        Ligne::couleurConnue(rangee.route_color, categorie);
+        Ligne ligne(
+                rangee.route_id,
+                rangee.route_short_name,
+                rangee.route_desc,
+                categorie
+        );
+
+        m_lignes.insert({ligne.getId(), ligne});
+        m_lignes_par_numero.insert({ligne.getNumero(), ligne});
+        RTC_LIGNE_RETENUE(phase);
+    }
+    RTC_LIGNES_LUES(phase, lecteur.getNbLignes(), lecteur.getNbOctets());
+}
+
 //! \brief ajoute les stations dans l'objet GTFS
 //! \param[in] p_nomFichier: le nom du fichier contenant les station
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterStations(const std::string &p_nomFichier)
 {
+    ++m_version;
+
     try {
         ifstream file(p_nomFichier);
 
         if (file.good()) {
-            string line;
-            getline(file, line);
-
-            vector<string> headers = string_to_vector(line, ',');
-            std::unordered_map<string, unsigned int> headers_map = {
-                    {"stop_id",   0},
-                    {"stop_name", 1},
-                    {"stop_desc", 2},
-                    {"stop_lat",  3},
-                    {"stop_lon",  4}
-            };
-
-            for (line; getline(file, line);) {
-                vector<string> champs = string_to_vector(line, ',');
-
-                line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-
-                Coordonnees coord(stod(champs[headers_map.at("stop_lat")]), stod(champs[headers_map.at("stop_lon")]));
-
-                Station station(
-                        (unsigned) stoi(champs[headers_map.at("stop_id")]),
-                        champs[headers_map.at("stop_name")],
-                        champs[headers_map.at("stop_desc")],
-                        coord
-                );
-
-                m_stations.insert({station.getId(), station});
-            }
+            lireStations(file, m_statistiques);
         }
     } catch(const ifstream::failure& e) {
         throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
     }
 }
 
+//! \brief lit les données d'un flux au format stops.txt déjà positionné au début de l'en-tête
+//! \param[in] file: le flux à lire
+//! \param[in,out] p_statistiques: les mesures de chargement à compléter
+void DonneesGTFS::lireStations(std::istream &file, StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "stations");
+    LecteurTable<RangeeStops> lecteur(file);
+    lecteur.signalerA(m_diagnostics, "stops.txt");
+    RangeeStops rangee;
+
+    while (lecteur.suivante(rangee)) {
+        Coordonnees coord(rangee.stop_lat, rangee.stop_lon);
+
+        Station station(
+                rangee.stop_id,
+                rangee.stop_name,
+                rangee.stop_desc,
+                coord
+        );
+
+        m_stations.insert({station.getId(), station});
+        RTC_LIGNE_RETENUE(phase);
+    }
+    RTC_LIGNES_LUES(phase, lecteur.getNbLignes(), lecteur.getNbOctets());
+
+    RTC_PHASE_SUIVANTE(phase, "stations.index_noms");
+    m_index_stations = IndexStations(m_stations);
+}
+
 //! \brief ajoute les transferts dans l'objet GTFS
 //! \breif Cette méthode doit âtre utilisée uniquement après que tous les arrêts ont été ajoutés
 //! \brief les transferts (entre stations) ajoutés sont uniquement ceux pour lesquelles les stations sont prensentes dans l'objet GTFS
@@ -129,38 +146,14 @@ void DonneesGTFS::ajouterStations(const std::string &p_nomFichier)
 //! \throws logic_error si tous les arrets de la date et de l'intervalle n'ont pas été ajoutés
 void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier)
 {
+    ++m_version;
+
     try {
         if (m_tousLesArretsPresents) {
             ifstream file(p_nomFichier);
 
             if (file.good()) {
-                string line;
-                getline(file, line);
-
-                vector<string> headers = string_to_vector(line, ',');
-                std::unordered_map<string, unsigned int> headers_map = {
-                        {"from_stop_id",      0},
-                        {"to_stop_id",        1},
-                        {"min_transfer_time", 3}
-                };
-
-                for (line; getline(file, line);) {
-                    vector<string> champs = string_to_vector(line, ',');
-
-                    line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                    line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-
-                    const unsigned int from_stop_id = (unsigned) stoi(champs[headers_map.at("from_stop_id")]);
-                    const unsigned int to_stop_id = (unsigned) stoi(champs[headers_map.at("to_stop_id")]);
-                    unsigned int min_transfer_time = (unsigned) stoi(champs[headers_map.at("min_transfer_time")]);
-
-                    if (from_stop_id != to_stop_id && m_stations.count(from_stop_id) && m_stations.count(to_stop_id)) {
-                        if (min_transfer_time == 0)
-                            min_transfer_time = 1;
-
-                        m_transferts.push_back(make_tuple(from_stop_id, to_stop_id, min_transfer_time));
-                    }
-                }
+                lireTransferts(file, m_statistiques);
             }
         } else {
             throw logic_error("Tous les arrêts de la date et de l'intervalle n'ont pas été ajoutés.");
@@ -170,6 +163,33 @@ void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier)
     }
 }
 
+//! \brief lit les données d'un flux au format transfers.txt déjà positionné au début de l'en-tête
+//! \param[in] file: le flux à lire
+//! \param[in,out] p_statistiques: les mesures de chargement à compléter
+void DonneesGTFS::lireTransferts(std::istream &file, StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "transferts");
+
+    LecteurTable<RangeeTransfers> lecteur(file);
+    lecteur.signalerA(m_diagnostics, "transfers.txt");
+    RangeeTransfers rangee;
+
+    while (lecteur.suivante(rangee)) {
+        const unsigned int from_stop_id = rangee.from_stop_id;
+        const unsigned int to_stop_id = rangee.to_stop_id;
+        unsigned int min_transfer_time = rangee.min_transfer_time;
+
+        if (from_stop_id != to_stop_id && m_stations.count(from_stop_id) && m_stations.count(to_stop_id)) {
+            if (min_transfer_time == 0)
+                min_transfer_time = 1;
+
+            m_transferts.push_back(make_tuple(from_stop_id, to_stop_id, min_transfer_time));
+            RTC_LIGNE_RETENUE(phase);
+        }
+    }
+    RTC_LIGNES_LUES(phase, lecteur.getNbLignes(), lecteur.getNbOctets());
+}
+
 
 //! \brief ajoute les services de la date du GTFS (m_date)
 //! \param[in] p_nomFichier: le nom du fichier contenant les services
@@ -180,87 +200,91 @@ void DonneesGTFS::ajouterServices(const std::string &p_nomFichier)
         ifstream file(p_nomFichier);
 
         if (file.good()) {
-            string line;
-            getline(file, line);
-
-            vector<string> headers = string_to_vector(line, ',');
-            std::unordered_map<string, unsigned int> headers_map = {
-                    {"service_id",     0},
-                    {"date",           1},
-                    {"exception_type", 2}
-            };
-
-            for (line; getline(file, line);) {
-                vector<string> champs = string_to_vector(line, ',');
-
-                line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-
-                string str_date = champs[headers_map.at("date")];
-                Date date(
-                        (unsigned) stoi(str_date.substr(0, 4)),
-                        (unsigned) stoi(str_date.substr(4, 2)),
-                        (unsigned) stoi(str_date.substr(6, 2))
-                );
-
-                if (stoi(champs[headers_map.at("exception_type")]) == 1 && m_date == date) {
-                    m_services.insert({champs[headers_map.at("service_id")]});
-                }
-            }
+            lireServices(file, m_statistiques);
         }
     } catch (const ifstream::failure& e) {
         throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
     }
 }
 
+//! \brief lit les données d'un flux au format calendar_dates.txt déjà positionné au début de l'en-tête
+//! \param[in] file: le flux à lire
+//! \param[in,out] p_statistiques: les mesures de chargement à compléter
+void DonneesGTFS::lireServices(std::istream &file, StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "services");
+
+    LecteurTable<RangeeCalendarDates> lecteur(file);
+    lecteur.signalerA(m_diagnostics, "calendar_dates.txt");
+    RangeeCalendarDates rangee;
+
+    while (lecteur.suivante(rangee)) {
+        // La date est lue comme un entier AAAAMMJJ
+        Date date(rangee.date / 10000, rangee.date / 100 % 100, rangee.date % 100);
+
+        if (rangee.exception_type == 1 && m_date == date) {
+            m_services.insert(rangee.service_id);
+            RTC_LIGNE_RETENUE(phase);
+        }
+    }
+    RTC_LIGNES_LUES(phase, lecteur.getNbLignes(), lecteur.getNbOctets());
+}
+
 //! \brief ajoute les voyages de la date
 //! \brief seuls les voyages dont le service est présent dans l'objet GTFS sont ajoutés
 //! \param[in] p_nomFichier: le nom du fichier contenant les voyages
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier)
 {
+    ++m_version;
+
     try {
         ifstream file(p_nomFichier);
 
         if (file.good()) {
-            string line;
-            getline(file, line);
-
-            vector<string> headers = string_to_vector(line, ',');
-            std::unordered_map<string, unsigned int> headers_map = {
-                    {"route_id",      0},
-                    {"service_id",    1},
-                    {"trip_id",       2},
-                    {"trip_headsign", 3}
-            };
-
-            for (line; getline(file, line);) {
-                vector<string> champs = string_to_vector(line, ',');
-
-                line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-
-                string service_id = champs[headers_map.at("service_id")];
-
-                if (m_services.count(service_id)) {
-                    string trip_id = champs[headers_map.at("trip_id")];
-
-                    Voyage voyage = Voyage(
-                            trip_id,
-                            (unsigned) stoi(champs[headers_map.at("route_id")]),
-                            service_id,
-                            champs[headers_map.at("trip_headsign")]
-                    );
-
-                    m_voyages.insert({trip_id, voyage});
-                }
-            }
+            lireVoyages(file, m_statistiques);
         }
     } catch (const ifstream::failure& e) {
         throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
     }
 }
 
+//! \brief lit les données d'un flux au format trips.txt déjà positionné au début de l'en-tête
+//! \param[in] file: le flux à lire
+//! \param[in,out] p_statistiques: les mesures de chargement à compléter
+void DonneesGTFS::lireVoyages(std::istream &file, StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "voyages");
+
+    // Seules les lignes d'un service de la date sont découpées jusqu'au bout et converties
+    LecteurTable<RangeeTrips> lecteur(file, "service_id");
+    lecteur.signalerA(m_diagnostics, "trips.txt");
+    RangeeTrips rangee;
+    string service_id;
+    auto serviceDeLaDate = [&](const LecteurCSV::Champ &p_champ) {
+        service_id.assign(p_champ.debut, p_champ.longueur);
+        return m_services.count(service_id) != 0;
+    };
+
+    while (lecteur.suivante(rangee, serviceDeLaDate)) {
+        Voyage voyage = Voyage(
+                rangee.trip_id,
+                rangee.route_id,
+                rangee.service_id,
+                rangee.trip_headsign,
+                rangee.direction_id,
+                rangee.block_id
+        );
+
+        m_voyages.insert({rangee.trip_id, voyage});
+        RTC_LIGNE_RETENUE(phase);
+    }
+    RTC_LIGNES_LUES(phase, lecteur.getNbLignes(), lecteur.getNbOctets());
+
+    RTC_PHASE_SUIVANTE(phase, "voyages.index");
+    m_index_voyages = IndexVoyages(m_voyages);
+}
+
 //! \brief ajoute les arrets aux voyages présents dans le GTFS si l'heure du voyage appartient à l'intervalle de temps du GTFS
 //! \brief De plus, on enlève les voyages qui n'ont pas d'arrêts dans l'intervalle de temps du GTFS
 //! \brief De plus, on enlève les stations qui n'ont pas d'arrets dans l'intervalle de temps du GTFS
@@ -269,104 +293,581 @@ void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichier)
 {
+    ++m_version;
+
     try {
         ifstream file(p_nomFichier);
 
         if (file.good()) {
-            string line;
-            getline(file, line);
+            lireArrets(file, m_statistiques);
+            finaliserArrets(m_statistiques);
+        }
+    } catch(const ifstream::failure& e) {
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+    }
+}
 
-            vector<string> headers = string_to_vector(line, ',');
-            std::unordered_map<string, unsigned int> headers_map = {
-                    {"trip_id",        0},
-                    {"arrival_time",   1},
-                    {"departure_time", 2},
-                    {"stop_id",        3},
-                    {"stop_sequence",  4}
-            };
+//! \brief lit les données d'un flux au format stop_times.txt déjà positionné au début de l'en-tête
+//! \param[in] file: le flux à lire
+//! \param[in,out] p_statistiques: les mesures de chargement à compléter
+void DonneesGTFS::lireArrets(std::istream &file, StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "arrets.lecture");
+
+    // Le trip_id est vérifié avant tout découpage: les lignes des voyages d'autres dates sont sautées d'un coup.
+    // Une seule sonde dans m_index_voyages, sans copie du champ, donne à la fois le trip_id et son Voyage.
+    LecteurTable<RangeeStopTimes> lecteur(file, "trip_id");
+    lecteur.signalerA(m_diagnostics, "stop_times.txt");
+    RangeeStopTimes rangee;
+    TableVoyages::value_type *voyage = nullptr;
+    auto voyageDeLaDate = [&](const LecteurCSV::Champ &p_champ) {
+        voyage = m_index_voyages.trouver(p_champ.debut, p_champ.longueur);
+        return voyage != nullptr;
+    };
+
+    while (lecteur.suivante(rangee, voyageDeLaDate)) {
+        const HeureGTFS &arrivee = rangee.arrival_time;
+        const HeureGTFS &depart = rangee.departure_time;
+        Heure arrival_hour(arrivee.heures, arrivee.minutes, arrivee.secondes);
+        Heure departure_hour(depart.heures, depart.minutes, depart.secondes);
+
+        if (departure_hour >= m_now1 && arrival_hour < m_now2) {
+            m_nbArrets++;
+            voyage->second.ajouterArret(Arret(rangee.stop_id, arrival_hour, departure_hour, rangee.stop_sequence,
+                                              voyage->first));
+            RTC_LIGNE_RETENUE(phase);
+        }
+    }
+    RTC_LIGNES_LUES(phase, lecteur.getNbLignes(), lecteur.getNbOctets());
+}
 
-            for (line; getline(file, line);) {
-                vector<string> champs = string_to_vector(line, ',');
+//! \brief termine l'ajout des arrêts: enlève les voyages sans arrêts, compresse les horaires des autres, ajoute
+//! \brief leurs arrêts aux stations, chaîne les blocs et enlève les stations sans arrêts
+//! \pre les arrêts ont été lus par lireArrets et toutes les stations ont été ajoutées
+//! \post assigne m_tousLesArretsPresents à true
+void DonneesGTFS::finaliserArrets(StatistiquesChargement &p_statistiques)
+{
+    RTC_PHASE(phase, p_statistiques, "arrets.suppression_voyages");
+    auto it = m_voyages.begin();
 
-                line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+    // On enlève les voyages n'ayant aucun arrêt
+    while (it != m_voyages.end()) {
+        if (it->second.getNbArrets() == 0) {
+            it = m_voyages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_index_voyages = IndexVoyages(m_voyages);
 
-                string trip_id = champs[headers_map.at("trip_id")];
+    RTC_PHASE_SUIVANTE(phase, "arrets.compression");
+    for (auto &voyageM : m_voyages) {
+        m_horaires.compresser(voyageM.second);
+    }
 
-                if (m_voyages.count(trip_id)) {
-                    string arrival_time = champs[headers_map.at("arrival_time")];
-                    string departure_time = champs[headers_map.at("departure_time")];
+    RTC_PHASE_SUIVANTE(phase, "arrets.indexation_stations");
+    it = m_voyages.begin();
 
-                    vector<unsigned int> arrival_tokens;
-                    vector<unsigned int> departure_tokens;
+    // Pour chaque voyage, on ajoute les arrêts aux arrêts de la station concernée
+    while (it != m_voyages.end()) {
+        unsigned int position = 0;
+        for (const Arret &f : it->second.getArrets()) {
+            m_stations[f.getStationId()].addArret(it->second, position++, f.getHeureArrivee());
+        }
+        it++;
+    }
 
-                    // On récupère les différentes partie de l'heure d'arrivée
-                    for(string &token : string_to_vector(champs[headers_map.at("arrival_time")], ':')) {
-                        arrival_tokens.push_back((unsigned) stoi(token));
-                    }
+    RTC_PHASE_SUIVANTE(phase, "arrets.chainage_blocs");
+    chainerBlocs();
 
-                    // On récupère les différentes partie de l'heure de départ
-                    for(string &token : string_to_vector(champs[headers_map.at("departure_time")], ':')) {
-                        departure_tokens.push_back((unsigned) stoi(token));
-                    }
+    RTC_PHASE_SUIVANTE(phase, "arrets.suppression_stations");
+    auto it2 = m_stations.begin();
+
+    // On enlève les stations n'ayant aucun arrêt
+    while (it2 != m_stations.end()) {
+        if (it2->second.getNbArrets() == 0) {
+            it2 = m_stations.erase(it2);
+        } else {
+            ++it2;
+        }
+    }
+
+    RTC_PHASE_SUIVANTE(phase, "arrets.index_noms");
+    m_index_stations = IndexStations(m_stations);
+
+    m_tousLesArretsPresents = true;
+}
+
+//! \brief charge tous les fichiers GTFS d'un dossier en exécutant en parallèle les étapes indépendantes
+//! \brief Dépendances: routes.txt, stops.txt et calendar_dates.txt sont indépendants; trips.txt dépend des services;
+//! \brief la lecture de stop_times.txt dépend des voyages, et sa finalisation des stations; transfers.txt dépend des arrêts.
+//! \brief Les lignes et les stations sont lues sur leurs propres fils pendant que le fil appelant enchaîne services,
+//! \brief voyages et arrêts; la lecture anticipée de stop_times.txt est demandée au système dès le départ.
+//! \brief Le résultat est le même qu'avec les appels ajouter* successifs.
+//! \param[in] p_dossier: le dossier contenant routes.txt, stops.txt, calendar_dates.txt, trips.txt, stop_times.txt et transfers.txt
+//! \throws logic_error si un problème survient avec la lecture d'un fichier
+void DonneesGTFS::charger(const std::string &p_dossier)
+{
+    prechargerFichier(p_dossier + "/stop_times.txt");
+    chargerDepuis([&p_dossier](const string &p_nom) {
+        unique_ptr<istream> file(new ifstream(p_dossier + "/" + p_nom));
+        if (!file->good()) {
+            file.reset();
+        }
+        return file;
+    });
+}
+
+//! \brief charge tous les fichiers GTFS d'une archive .zip, sans extraction, comme charger() pour un dossier
+//! \brief Les fichiers sont décompressés à la volée (voir ArchiveZip); ils peuvent être dans un sous-dossier de l'archive.
+//! \param[in] p_archive: le chemin de l'archive .zip
+//! \throws logic_error si l'archive est illisible ou corrompue, ou si un problème survient avec la lecture d'un fichier
+void DonneesGTFS::chargerZip(const std::string &p_archive)
+{
+    ArchiveZip archive(p_archive);
+    prechargerFichier(p_archive);
+    chargerDepuis([&archive](const string &p_nom) {
+        return archive.ouvrir(p_nom);
+    });
+}
 
-                    Heure *arrival_hour = new Heure(arrival_tokens[0], arrival_tokens[1], arrival_tokens[2]);
-                    Heure *departure_hour = new Heure(departure_tokens[0], departure_tokens[1], departure_tokens[2]);
+/*!
+ * \brief Charge plusieurs réseaux GTFS (ex.: le RTC et les sociétés voisines) dans cet objet, qui les sert comme un seul
+ *
+ * Chaque réseau est chargé en parallèle dans son propre DonneesGTFS, avec la date, l'intervalle de temps et la
+ * politique d'erreurs de cet objet, puis ses données sont reprises ici dans l'espace de noms de sa source: les
+ * identifiants numériques (stop_id, route_id) du réseau k deviennent identifiantGlobal(k, id), et les identifiants
+ * textuels (trip_id, service_id, block_id, numéro de ligne) sont préfixés par "espace:". Enfin, des transferts à
+ * pied sont ajoutés, dans les deux sens, entre les stations de réseaux différents distantes d'au plus
+ * p_distanceTransfert km.
+ * \param[in] p_sources: les réseaux, au plus NB_RESEAUX_MAX; le premier a le numéro 0
+ * \param[in] p_distanceTransfert: la distance maximale, en km, d'un transfert entre deux réseaux
+ * \post le contenu précédent de cet objet est remplacé
+ * \throws logic_error si un réseau ne se charge pas, ou si un stop_id ou route_id ne tient pas sur
+ * NB_BITS_IDENTIFIANT_LOCAL bits
+ */
+void DonneesGTFS::chargerReseaux(const std::vector<SourceGTFS> &p_sources, double p_distanceTransfert)
+{
+    if (p_sources.size() > NB_RESEAUX_MAX) {
+        throw logic_error("Trop de réseaux: au plus " + to_string(NB_RESEAUX_MAX) + " peuvent être chargés ensemble.");
+    }
+    vider();
+
+    vector<unique_ptr<DonneesGTFS> > reseaux;
+    vector<future<void> > chargements;
+    for (const SourceGTFS &source : p_sources) {
+        reseaux.emplace_back(new DonneesGTFS(m_date, m_now1, m_now2));
+        reseaux.back()->setPolitiqueErreurs(m_diagnostics.getPolitique());
+        DonneesGTFS *reseau = reseaux.back().get();
+        chargements.push_back(async(launch::async, [reseau, &source]() {
+            const string &chemin = source.chemin;
+            if (chemin.size() >= 4 && chemin.compare(chemin.size() - 4, 4, ".zip") == 0)
+                reseau->chargerZip(chemin);
+            else
+                reseau->charger(chemin);
+        }));
+    }
+    exception_ptr erreur;
+    for (future<void> &chargement : chargements) {
+        try {
+            chargement.get();
+        } catch (...) {
+            if (!erreur) erreur = current_exception();
+        }
+    }
+    if (erreur) rethrow_exception(erreur);
 
-                    if (*departure_hour >= m_now1 && *arrival_hour < m_now2) {
-                        Arret::Ptr a_ptr = make_shared<Arret>(
-                                (unsigned) stoi(champs[headers_map.at("stop_id")]),
-                                *arrival_hour,
-                                *departure_hour,
-                                (unsigned) stoi(champs[headers_map.at("stop_sequence")]),
-                                trip_id
-                        );
+    for (unsigned int k = 0; k < reseaux.size(); ++k) {
+        fusionnerReseau(*reseaux[k], k, p_sources[k].espace + ":");
+        reseaux[k].reset(); //rend la mémoire du réseau avant de reprendre le suivant
+    }
 
-                        m_nbArrets++;
-                        m_voyages[trip_id].ajouterArret(a_ptr);
+    RTC_PHASE(phase, m_statistiques, "reseaux.index");
+    m_index_voyages = IndexVoyages(m_voyages);
+    chainerBlocs();
+    m_index_stations = IndexStations(m_stations);
+    m_tousLesArretsPresents = true;
+
+    RTC_PHASE_SUIVANTE(phase, "reseaux.transferts");
+    ajouterTransfertsEntreReseaux(p_distanceTransfert);
+}
+
+//! \brief reprend les lignes, stations, services, voyages, arrêts et transferts d'un réseau chargé, dans l'espace de
+//! \brief noms du réseau p_reseau; les mesures et les diagnostics du réseau sont aussi repris
+//! \param[in] p_source: le réseau, entièrement chargé
+//! \param[in] p_reseau: le numéro du réseau, qui préfixe ses identifiants numériques
+//! \param[in] p_prefixe: le préfixe de ses identifiants textuels
+void DonneesGTFS::fusionnerReseau(DonneesGTFS &p_source, unsigned int p_reseau, const std::string &p_prefixe)
+{
+    RTC_PHASE(phase, m_statistiques, "reseaux.fusion");
+
+    for (const auto &l : p_source.m_lignes) {
+        const Ligne &ligne = l.second;
+        Ligne globale(identifiantGlobal(p_reseau, ligne.getId()), p_prefixe + ligne.getNumero(), ligne.getDescription(),
+                      ligne.getCategorie());
+        m_lignes.insert({globale.getId(), globale});
+        m_lignes_par_numero.insert({globale.getNumero(), globale});
+    }
+    for (const auto &s : p_source.m_stations) {
+        const Station &station = s.second;
+        const unsigned int id = identifiantGlobal(p_reseau, station.getId());
+        m_stations.insert({id, Station(id, station.getNom(), station.getDescription(), station.getCoords())});
+    }
+    for (const string &service : p_source.m_services) {
+        m_services.insert(p_prefixe + service);
+    }
+    for (const auto &v : p_source.m_voyages) {
+        const Voyage &voyage = v.second;
+        const string id = p_prefixe + v.first;
+        auto insertion = m_voyages.insert({id, Voyage(id, identifiantGlobal(p_reseau, voyage.getLigne()),
+                                                      p_prefixe + voyage.getServiceId(), voyage.getDestination(),
+                                                      voyage.getDirection(),
+                                                      voyage.getBloc().empty() ? "" : p_prefixe + voyage.getBloc())});
+        Voyage &global = insertion.first->second;
+        for (const Arret &a : voyage.getArrets()) {
+            global.ajouterArret(Arret(identifiantGlobal(p_reseau, a.getStationId()), a.getHeureArrivee(),
+                                      a.getHeureDepart(), a.getNumeroSequence(), global.getId()));
+            ++m_nbArrets;
+        }
+        m_horaires.compresser(global);
+        unsigned int position = 0;
+        for (const Arret &a : global.getArrets()) {
+            m_stations[a.getStationId()].addArret(global, position++, a.getHeureArrivee());
+        }
+        RTC_LIGNE_RETENUE(phase);
+    }
+    for (const auto &t : p_source.m_transferts) {
+        m_transferts.push_back(make_tuple(identifiantGlobal(p_reseau, get<0>(t)), identifiantGlobal(p_reseau, get<1>(t)),
+                                          get<2>(t)));
+    }
+
+    for (const StatistiquesPhase &mesure : p_source.m_statistiques.getPhases()) {
+        m_statistiques.ajouter(mesure);
+    }
+    for (DiagnosticChamp diagnostic : p_source.m_diagnostics.getDiagnostics()) {
+        diagnostic.fichier = p_prefixe + diagnostic.fichier;
+        m_diagnostics.signaler(diagnostic);
+    }
+}
+
+//! \brief ajoute un transfert à pied, dans les deux sens, entre chaque paire de stations de réseaux différents
+//! \brief distantes d'au plus p_distance km; sa durée est celle de la marche à 1,2 m/s
+//! \brief Les stations sont réparties dans une grille dont les cellules mesurent au moins p_distance de côté: seules
+//! \brief les stations des cellules voisines sont comparées.
+void DonneesGTFS::ajouterTransfertsEntreReseaux(double p_distance)
+{
+    const double VITESSE_MARCHE = 1.2;              //m/s
+    const double KM_PAR_DEGRE_LATITUDE = 111.32;
+    if (p_distance <= 0 || m_stations.empty()) return;
+
+    // Une cellule fait p_distance en latitude; en longitude, elle est élargie selon la latitude la plus au nord
+    double latitudeMax = 0;
+    for (const auto &s : m_stations) {
+        latitudeMax = max(latitudeMax, s.second.getCoords().getLatitude());
+    }
+    const double pasLatitude = p_distance / KM_PAR_DEGRE_LATITUDE;
+    const double pasLongitude = pasLatitude / max(0.01, cos(min(latitudeMax, 89.0) * 3.14159265358979323846 / 180.0));
+
+    auto cellule = [&](const Coordonnees &p_coords) {
+        return make_pair((long long) floor(p_coords.getLatitude() / pasLatitude),
+                         (long long) floor(p_coords.getLongitude() / pasLongitude));
+    };
+    map<pair<long long, long long>, vector<const Station *> > grille;
+    for (const auto &s : m_stations) {
+        grille[cellule(s.second.getCoords())].push_back(&s.second);
+    }
+
+    for (const auto &c : grille) {
+        for (long long dLat = -1; dLat <= 1; ++dLat) {
+            for (long long dLon = -1; dLon <= 1; ++dLon) {
+                auto voisine = grille.find(make_pair(c.first.first + dLat, c.first.second + dLon));
+                if (voisine == grille.end()) continue;
+                for (const Station *a : c.second) {
+                    for (const Station *b : voisine->second) {
+                        if (reseauDe(a->getId()) == reseauDe(b->getId())) continue;
+                        const double distance = a->getCoords() - b->getCoords();
+                        if (distance > p_distance) continue;
+                        const unsigned int duree = max(1u, (unsigned int) ceil(distance * 1000 / VITESSE_MARCHE));
+                        m_transferts.push_back(make_tuple(a->getId(), b->getId(), duree));
                     }
                 }
             }
+        }
+    }
+}
 
-            auto it = m_voyages.begin();
+//! \return l'identifiant, unique parmi tous les réseaux, du stop_id ou route_id p_id du réseau p_reseau
+//! \throws logic_error si p_id ne tient pas sur NB_BITS_IDENTIFIANT_LOCAL bits
+unsigned int DonneesGTFS::identifiantGlobal(unsigned int p_reseau, unsigned int p_id)
+{
+    if (p_id >> NB_BITS_IDENTIFIANT_LOCAL) {
+        throw logic_error("L'identifiant " + to_string(p_id) + " est trop grand pour être combiné à d'autres réseaux.");
+    }
+    return (p_reseau << NB_BITS_IDENTIFIANT_LOCAL) | p_id;
+}
 
-            // On enlève les voyages n'ayant aucun arrêt
-            while (it != m_voyages.end()) {
-                if (it->second.getNbArrets() == 0) {
-                    it = m_voyages.erase(it);
-                } else {
-                    ++it;
-                }
-            }
+//! \return le numéro du réseau d'un identifiant global (0 pour un réseau chargé seul)
+unsigned int DonneesGTFS::reseauDe(unsigned int p_id_global)
+{
+    return p_id_global >> NB_BITS_IDENTIFIANT_LOCAL;
+}
 
-            it = m_voyages.begin();
+//! \return le stop_id ou route_id d'origine d'un identifiant global
+unsigned int DonneesGTFS::identifiantLocal(unsigned int p_id_global)
+{
+    return p_id_global & ((1u << NB_BITS_IDENTIFIANT_LOCAL) - 1);
+}
 
-            // Pour chaque voyage, on ajoute les arrêts aux arrêts de la station concernée
-            while (it != m_voyages.end()) {
-                for (const auto &f : it->second.getArrets()) {
-                    m_stations[f->getStationId()].addArret(f);
-                }
-                it++;
-            }
+//! \brief retire toutes les données chargées, avant un nouveau chargement par exemple
+//! \brief les nœuds des conteneurs sont rendus en une fois par l'arène, sans libération nœud par nœud
+void DonneesGTFS::vider()
+{
+    ++m_version;
+
+    m_lignes.clear();
+    m_lignes_par_numero.clear();
+    m_stations.clear();
+    m_services.clear();
+    m_voyages.clear();
+    m_index_voyages = IndexVoyages();
+    m_transferts.clear();
+    m_voyages_par_bloc.clear();
+    m_index_stations = IndexStations();
+    m_index_arrets = IndexArrets();
+    m_voyages_charges.clear();
+    m_stations_chargees.clear();
+    m_statistiques.vider();
+    m_diagnostics.vider();
+    m_nbArrets = 0;
+    m_tousLesArretsPresents = false;
+
+    m_horaires.vider();
+    m_arene.vider();
+}
+
+//! \brief exécute le graphe de chargement de charger() sur des flux fournis par p_ouvrir
+//! \param[in] p_ouvrir: retourne le flux d'un fichier GTFS (ex.: "stops.txt"), ou nullptr s'il est absent; appelée
+//! \brief depuis plusieurs fils
+void DonneesGTFS::chargerDepuis(const std::function<std::unique_ptr<std::istream>(const std::string &)> &p_ouvrir)
+{
+    ++m_version;
+
+    // Chaque fil a ses propres mesures, réunies à la fin
+    StatistiquesChargement statsLignes, statsStations, statsChaine;
+    auto lire = [&p_ouvrir](const string &p_nom, const function<void(istream &)> &p_lecteur) {
+        unique_ptr<istream> file = p_ouvrir(p_nom);
+        if (file) {
+            p_lecteur(*file);
+        }
+    };
+
+    future<void> lignes = async(launch::async, [&]() {
+        lire("routes.txt", [&](istream &file) { lireLignes(file, statsLignes); });
+    });
+    future<void> stations = async(launch::async, [&]() {
+        lire("stops.txt", [&](istream &file) { lireStations(file, statsStations); });
+    });
+
+    exception_ptr erreur;
+    bool arretsLus = false;
+    try {
+        lire("calendar_dates.txt", [&](istream &file) { lireServices(file, statsChaine); });
+        lire("trips.txt", [&](istream &file) { lireVoyages(file, statsChaine); });
+        lire("stop_times.txt", [&](istream &file) {
+            lireArrets(file, statsChaine);
+            arretsLus = true;
+        });
+    } catch (...) {
+        erreur = current_exception();
+    }
+
+    // Attendre les deux fils avant de rapporter une erreur: ils écrivent dans cet objet
+    for (future<void> *f : {&lignes, &stations}) {
+        try {
+            f->get();
+        } catch (...) {
+            if (!erreur) erreur = current_exception();
+        }
+    }
+    for (const StatistiquesChargement *stats : {&statsLignes, &statsStations, &statsChaine}) {
+        for (const StatistiquesPhase &phase : stats->getPhases()) {
+            m_statistiques.ajouter(phase);
+        }
+    }
+    if (erreur) rethrow_exception(erreur);
+
+    if (arretsLus) {
+        finaliserArrets(m_statistiques);
+    }
+    if (!m_tousLesArretsPresents) {
+        throw logic_error("Tous les arrêts de la date et de l'intervalle n'ont pas été ajoutés.");
+    }
+    lire("transfers.txt", [&](istream &file) { lireTransferts(file, m_statistiques); });
+}
+
+//! \brief demande au système de commencer à lire un fichier en arrière-plan (sans effet si non supporté)
+void DonneesGTFS::prechargerFichier(const std::string &p_nomFichier)
+{
+#ifdef POSIX_FADV_WILLNEED
+    int fd = open(p_nomFichier.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#else
+    (void) p_nomFichier;
+#endif
+}
 
-            auto it2 = m_stations.begin();
+//! \brief prépare le chargement à la demande des arrêts à partir de l'index de stop_times.txt
+//! \brief L'index est relu de p_nomFichier.idx s'il est à jour, sinon il est reconstruit et sauvegardé (voir IndexArrets).
+//! \brief Ensuite, getVoyageAvecArrets et ajouterArretsDesStations ne lisent que les lignes des voyages demandés,
+//! \brief au lieu de ajouterArretsDesVoyagesDeLaDate qui lit tout le fichier.
+//! \param[in] p_nomFichier: le nom du fichier stop_times.txt
+//! \throws logic_error si un problème survient avec la lecture du fichier
+void DonneesGTFS::utiliserIndexArrets(const std::string &p_nomFichier)
+{
+    m_index_arrets = IndexArrets::ouvrir(p_nomFichier);
+    m_voyages_charges.clear();
+    m_stations_chargees.clear();
+}
+
+//! \brief retourne un voyage de la date, après avoir chargé au premier accès ses arrêts de l'intervalle de temps
+//! \brief contrairement à ajouterArretsDesVoyagesDeLaDate, un voyage sans arrêt dans l'intervalle n'est pas enlevé
+//! \param[in] p_voyage_id: l'identifiant (trip_id) du voyage
+//! \pre utiliserIndexArrets a été appelée et les voyages de la date ont été ajoutés
+//! \throws logic_error si l'index n'est pas prêt ou si le voyage n'est pas un voyage de la date
+const Voyage &DonneesGTFS::getVoyageAvecArrets(const std::string &p_voyage_id)
+{
+    return chargerArretsDuVoyage(p_voyage_id);
+}
+
+//! \brief ajoute aux stations demandées leurs arrêts de la date et de l'intervalle, en ne lisant que les lignes
+//! \brief des voyages qui passent par ces stations; les arrêts de ces voyages sont aussi chargés
+//! \param[in] p_stations: les identifiants des stations
+//! \pre utiliserIndexArrets a été appelée, les stations et les voyages de la date ont été ajoutés
+//! \throws logic_error si l'index n'est pas prêt
+void DonneesGTFS::ajouterArretsDesStations(const std::vector<unsigned int> &p_stations)
+{
+    if (m_index_arrets.estVide()) {
+        throw logic_error("L'index des arrêts n'a pas été chargé.");
+    }
+    ++m_version;
 
-            // On enlève les stations n'ayant aucun arrêt
-            while (it2 != m_stations.end()) {
-                if (it2->second.getNbArrets() == 0) {
-                    it2 = m_stations.erase(it2);
-                } else {
-                    ++it2;
+    for (unsigned int station_id : p_stations) {
+        auto s_itr = m_stations.find(station_id);
+        if (s_itr == m_stations.end() || !m_stations_chargees.insert(station_id).second) {
+            continue;
+        }
+        for (const string &voyage_id : m_index_arrets.getVoyagesDeStation(station_id)) {
+            if (m_voyages.count(voyage_id)) {
+                const Voyage &voyage = chargerArretsDuVoyage(voyage_id);
+                unsigned int position = 0;
+                for (const Arret &a : voyage.getArrets()) {
+                    if (a.getStationId() == station_id) {
+                        s_itr->second.addArret(voyage, position, a.getHeureArrivee());
+                    }
+                    ++position;
                 }
             }
+        }
+    }
+}
 
-            m_tousLesArretsPresents = true;
+//! \brief lit une fois les lignes d'un voyage dans stop_times.txt, lui ajoute ses arrêts de l'intervalle et les
+//! \brief compresse
+Voyage &DonneesGTFS::chargerArretsDuVoyage(const std::string &p_voyage_id)
+{
+    if (m_index_arrets.estVide()) {
+        throw logic_error("L'index des arrêts n'a pas été chargé.");
+    }
+    auto v_itr = m_voyages.find(p_voyage_id);
+    if (v_itr == m_voyages.end()) {
+        throw logic_error("Le voyage " + p_voyage_id + " n'est pas un voyage de la date.");
+    }
+    if (m_voyages_charges.insert(p_voyage_id).second) {
+        ++m_version;
+        string lignes;
+        if (m_index_arrets.lireLignesDuVoyage(p_voyage_id, lignes)) {
+            istringstream file(lignes);
+            lireArrets(file, m_statistiques);
         }
-    } catch(const ifstream::failure& e) {
-        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+        m_horaires.compresser(v_itr->second);
+    }
+    return v_itr->second;
+}
+
+//! \brief construit, pour chaque bloc (block_id), la chaîne de ses voyages triés par heure de départ
+//! \brief chaque voyage connaît ensuite ses voisins de bloc (Voyage::getVoyagePrecedent, Voyage::getVoyageSuivant)
+//! \pre les voyages sans arrêts ont été enlevés de m_voyages
+void DonneesGTFS::chainerBlocs()
+{
+    std::unordered_map<std::string, std::vector<Voyage *> > chaines;
+    for (auto &voyageM : m_voyages) {
+        if (!voyageM.second.getBloc().empty()) {
+            chaines[voyageM.second.getBloc()].push_back(&voyageM.second);
+        }
+    }
+
+    m_voyages_par_bloc.clear();
+    for (auto &blocM : chaines) {
+        vector<Voyage *> &chaine = blocM.second;
+        stable_sort(chaine.begin(), chaine.end(), [](const Voyage *a, const Voyage *b) {
+            return a->getHeureDepart() < b->getHeureDepart();
+        });
+        for (size_t i = 0; i < chaine.size(); ++i) {
+            chaine[i]->setVoisinsDeBloc(i > 0 ? chaine[i - 1] : nullptr, i + 1 < chaine.size() ? chaine[i + 1] : nullptr);
+        }
+        m_voyages_par_bloc[blocM.first].assign(chaine.begin(), chaine.end());
     }
 }
 
+//! \brief retourne les mesures des phases de chargement (vides si compilé sans RTC_INSTRUMENTATION)
+const StatistiquesChargement &DonneesGTFS::getStatistiques() const
+{
+    return m_statistiques;
+}
+
+//! \brief choisit ce que font les prochains chargements d'une rangée dont un champ ne se convertit pas
+//! \param[in] p_politique: PolitiqueErreurs::ECHOUER (par défaut) lève une logic_error, PolitiqueErreurs::SAUTER
+//! \brief ignore la rangée; dans les deux cas, le champ est noté dans getDiagnostics()
+void DonneesGTFS::setPolitiqueErreurs(PolitiqueErreurs p_politique)
+{
+    m_diagnostics.setPolitique(p_politique);
+}
+
+//! \brief retourne les champs invalides rencontrés depuis la construction ou le dernier vider()
+const DiagnosticsChargement &DonneesGTFS::getDiagnostics() const
+{
+    return m_diagnostics;
+}
+
+//! \brief retourne l'arène des conteneurs à nœuds, pour en rapporter l'occupation
+//! \brief retourne les horaires compressés qui contiennent les arrêts des voyages
+const HorairesCompresses &DonneesGTFS::getHoraires() const
+{
+    return m_horaires;
+}
+
+const Arene &DonneesGTFS::getArene() const
+{
+    return m_arene;
+}
+
+//! \brief retourne l'index de recherche par nom et description des stations présentes dans l'objet GTFS
+const IndexStations &DonneesGTFS::getIndexStations() const
+{
+    return m_index_stations;
+}
+
+//! \brief retourne les voyages d'un bloc (block_id) triés par heure de départ; vide si le bloc est inconnu
+const std::vector<const Voyage *> &DonneesGTFS::getVoyagesDuBloc(const std::string &p_bloc) const
+{
+    static const std::vector<const Voyage *> aucun;
+    auto it = m_voyages_par_bloc.find(p_bloc);
+    return it == m_voyages_par_bloc.end() ? aucun : it->second;
+}
+
 unsigned int DonneesGTFS::getNbArrets() const
 {
     return m_nbArrets;
@@ -397,102 +898,155 @@ size_t DonneesGTFS::getNbVoyages() const
     return m_voyages.size();
 }
 
+//! \brief retourne un compteur incrémenté chaque fois que les stations, voyages, arrêts ou transferts sont modifiés
+unsigned long DonneesGTFS::getVersion() const
+{
+    return m_version;
+}
+
 void DonneesGTFS::afficherLignes() const
 {
-    std::cout << "======================" << std::endl;
-    std::cout << "   LIGNES GTFS   " << std::endl;
-    std::cout << "   COMPTE = " << m_lignes.size() << "   " << std::endl;
-    std::cout << "======================" << std::endl;
+    RedacteurRapport sortie(std::cout);
+    afficherLignes(sortie);
+}
+
+void DonneesGTFS::afficherLignes(RedacteurRapport &sortie) const
+{
+    sortie << "======================\n";
+    sortie << "   LIGNES GTFS   \n";
+    sortie << "   COMPTE = " << m_lignes.size() << "   \n";
+    sortie << "======================\n";
     for (const auto & ligneM : m_lignes_par_numero)
     {
-        cout << ligneM.second;
+        const Ligne &ligne = ligneM.second;
+        sortie << Ligne::categorieToString(ligne.getCategorie()) << ' ' << ligneM.first << " : "
+               << ligne.getDescription() << '\n';
     }
-    std::cout << std::endl;
+    sortie << '\n';
 }
 
 void DonneesGTFS::afficherStations() const
 {
-    std::cout << "========================" << std::endl;
-    std::cout << "   STATIONS GTFS   " << std::endl;
-    std::cout << "   COMPTE = " << m_stations.size() << "   " << std::endl;
-    std::cout << "========================" << std::endl;
+    RedacteurRapport sortie(std::cout);
+    afficherStations(sortie);
+}
+
+void DonneesGTFS::afficherStations(RedacteurRapport &sortie) const
+{
+    sortie << "========================\n";
+    sortie << "   STATIONS GTFS   \n";
+    sortie << "   COMPTE = " << m_stations.size() << "   \n";
+    sortie << "========================\n";
     for (const auto & stationM : m_stations)
     {
-        std::cout << stationM.second << endl;
+        sortie << texteStation(stationM.second) << '\n';
     }
-    std::cout << std::endl;
+    sortie << '\n';
 }
 
 void DonneesGTFS::afficherTransferts() const
 {
-    std::cout << "========================" << std::endl;
-    std::cout << "   TRANSFERTS GTFS   " << std::endl;
-    std::cout << "   COMPTE = " << m_transferts.size() << "   " << std::endl;
-    std::cout << "========================" << std::endl;
-    for (unsigned int i = 0; i < m_transferts.size(); ++i)
+    RedacteurRapport sortie(std::cout);
+    afficherTransferts(sortie);
+}
+
+void DonneesGTFS::afficherTransferts(RedacteurRapport &sortie) const
+{
+    sortie << "========================\n";
+    sortie << "   TRANSFERTS GTFS   \n";
+    sortie << "   COMPTE = " << m_transferts.size() << "   \n";
+    sortie << "========================\n";
+    for (const auto & transfert : m_transferts)
     {
-        std::cout << "De la station " << get<0>(m_transferts.at(i)) << " vers la station " << get<1>(m_transferts.at(i))
-        <<
-        " en " << get<2>(m_transferts.at(i)) << " secondes" << endl;
-        
+        sortie << "De la station " << get<0>(transfert) << " vers la station " << get<1>(transfert)
+               << " en " << get<2>(transfert) << " secondes\n";
     }
-    std::cout << std::endl;
-    
+    sortie << '\n';
 }
 
-
 void DonneesGTFS::afficherArretsParVoyages() const
 {
-    std::cout << "=====================================" << std::endl;
-    std::cout << "   VOYAGES DE LA JOURNÉE DU " << m_date << std::endl;
-    std::cout << "   " << m_now1 << " - " << m_now2 << std::endl;
-    std::cout << "   COMPTE = " << m_voyages.size() << "   " << std::endl;
-    std::cout << "=====================================" << std::endl;
-    
+    RedacteurRapport sortie(std::cout);
+    afficherArretsParVoyages(sortie);
+}
+
+void DonneesGTFS::afficherArretsParVoyages(RedacteurRapport &sortie) const
+{
+    sortie << "=====================================\n";
+    sortie << "   VOYAGES DE LA JOURNÉE DU " << m_date << '\n';
+    sortie << "   " << m_now1 << " - " << m_now2 << '\n';
+    sortie << "   COMPTE = " << m_voyages.size() << "   \n";
+    sortie << "=====================================\n";
+
+    // Le texte de chaque station est formaté une seule fois, et non à chacun de ses arrêts
+    std::unordered_map<unsigned int, std::string> textesStations;
+    textesStations.reserve(m_stations.size());
+    for (const auto & stationM : m_stations)
+    {
+        textesStations.insert({stationM.first, texteStation(stationM.second)});
+    }
+
     for (const auto & voyageM : m_voyages)
     {
-        unsigned int ligne_id = voyageM.second.getLigne();
-        auto l_itr = m_lignes.find(ligne_id);
-        cout << (l_itr->second).getNumero() << " ";
-        cout << voyageM.second << endl;
-        for (const auto & a: voyageM.second.getArrets())
+        auto l_itr = m_lignes.find(voyageM.second.getLigne());
+        sortie << (l_itr->second).getNumero() << " Vers " << voyageM.second.getDestination() << '\n';
+        for (const Arret & a: voyageM.second.getArrets())
         {
-            unsigned int station_id = a->getStationId();
-            auto s_itr = m_stations.find(station_id);
-            std::cout << a->getHeureArrivee() << " station " << s_itr->second << endl;
+            sortie << a.getHeureArrivee() << " station " << textesStations.find(a.getStationId())->second << '\n';
         }
     }
-    
-    std::cout << std::endl;
+
+    sortie << '\n';
 }
 
 void DonneesGTFS::afficherArretsParStations() const
 {
-    std::cout << "========================" << std::endl;
-    std::cout << "   ARRETS PAR STATIONS   " << std::endl;
-    std::cout << "   Nombre d'arrêts = " << m_nbArrets << std::endl;
-    std::cout << "========================" << std::endl;
+    RedacteurRapport sortie(std::cout);
+    afficherArretsParStations(sortie);
+}
+
+void DonneesGTFS::afficherArretsParStations(RedacteurRapport &sortie) const
+{
+    sortie << "========================\n";
+    sortie << "   ARRETS PAR STATIONS   \n";
+    sortie << "   Nombre d'arrêts = " << m_nbArrets << '\n';
+    sortie << "========================\n";
+
+    // Numéros des lignes résolus une fois; le voyage de chaque arrêt est trouvé en une sonde de m_index_voyages
+    std::unordered_map<unsigned int, std::string> numeros;
+    for (const auto & ligneM : m_lignes)
+    {
+        numeros.insert({ligneM.first, ligneM.second.getNumero()});
+    }
+
     for ( const auto & stationM : m_stations)
     {
-        std::cout << "Station " << stationM.second << endl;
+        sortie << "Station " << texteStation(stationM.second) << '\n';
         for ( const auto & arretM : stationM.second.getArrets())
         {
-            string voyage_id = arretM.second->getVoyageId();
-            auto v_itr = m_voyages.find(voyage_id);
-            unsigned int ligne_id = (v_itr->second).getLigne();
-            auto l_itr = m_lignes.find(ligne_id);
-            std::cout << arretM.first << " - " << (l_itr->second).getNumero() << " " << v_itr->second << std::endl;
+            const Voyage &voyage = m_index_voyages.trouver(arretM.second.getVoyageId())->second;
+            sortie << arretM.first << " - " << numeros.find(voyage.getLigne())->second << " Vers "
+                   << voyage.getDestination() << '\n';
         }
     }
-    std::cout << std::endl;
+    sortie << '\n';
+}
+
+//! \brief retourne le texte d'une station tel que l'écrit son opérateur <<
+std::string DonneesGTFS::texteStation(const Station &p_station)
+{
+    char coordonnees[80];
+    snprintf(coordonnees, sizeof(coordonnees), " (lat:%g, long:%g)", p_station.getCoords().getLatitude(),
+             p_station.getCoords().getLongitude());
+    return std::to_string(p_station.getId()) + " - " + p_station.getNom() + coordonnees;
 }
 
-const std::map<std::string, Voyage> &DonneesGTFS::getVoyages() const
+const TableVoyages &DonneesGTFS::getVoyages() const
 {
     return m_voyages;
 }
 
-const std::map<unsigned int, Station> &DonneesGTFS::getStations() const
+const TableStations &DonneesGTFS::getStations() const
 {
     return m_stations;
 }
@@ -517,5 +1071,11 @@ const std::unordered_map<unsigned int, Ligne> &DonneesGTFS::getLignes() const
     return m_lignes;
 }
 
+//! \brief retourne les identifiants des services de la date
+const std::unordered_set<std::string> &DonneesGTFS::getServices() const
+{
+    return m_services;
+}
+
 
 
@@ -5,6 +5,7 @@
 #ifndef TP1_GTFS_H
 #define TP1_GTFS_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
@@ -13,13 +14,34 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <functional>
+#include <memory>
 
+#include "arene.h"
+#include "diagnostics_chargement.h"
 #include "auxiliaires.h"
 #include "ligne.h"
 #include "station.h"
 #include "voyage.h"
 #include "arret.h"
 #include "coordonnees.h"
+#include "horaires_compresses.h"
+#include "index_stations.h"
+#include "index_voyages.h"
+#include "archive_zip.h"
+#include "index_arrets.h"
+#include "instrumentation.h"
+#include "redacteur_rapport.h"
+
+/*!
+ * \struct SourceGTFS
+ * \brief Un réseau à charger avec DonneesGTFS::chargerReseaux: son espace de noms et son dossier (ou archive .zip)
+ */
+struct SourceGTFS
+{
+    std::string espace;  //préfixe des identifiants textuels du réseau (ex.: "RTC", "STLevis")
+    std::string chemin;  //dossier GTFS, ou archive dont le nom se termine par .zip
+};
 
 class DonneesGTFS
 {
@@ -33,12 +55,26 @@ public:
     void ajouterVoyagesDeLaDate(const std::string &);
     void ajouterArretsDesVoyagesDeLaDate(const std::string&);
     void ajouterTransferts(const std::string&);
+    void charger(const std::string &);
+    void chargerZip(const std::string &);
+    void chargerReseaux(const std::vector<SourceGTFS> &, double p_distanceTransfert = 0.3);
+    void vider();
+    void setPolitiqueErreurs(PolitiqueErreurs);
+
+    void utiliserIndexArrets(const std::string &);
+    const Voyage & getVoyageAvecArrets(const std::string &);
+    void ajouterArretsDesStations(const std::vector<unsigned int> &);
 
     void afficherLignes() const;
     void afficherStations() const;
     void afficherArretsParVoyages() const;
     void afficherArretsParStations() const;
     void afficherTransferts() const;
+    void afficherLignes(RedacteurRapport &) const;
+    void afficherStations(RedacteurRapport &) const;
+    void afficherArretsParVoyages(RedacteurRapport &) const;
+    void afficherArretsParStations(RedacteurRapport &) const;
+    void afficherTransferts(RedacteurRapport &) const;
 
     Heure getTempsDebut() const;
     Heure getTempsFin() const;
@@ -48,14 +84,42 @@ public:
     size_t getNbServices() const;
     size_t getNbVoyages() const;
     size_t getNbTransferts() const;
-    const std::map<std::string, Voyage> & getVoyages() const;
-    const std::map<unsigned int, Station> & getStations() const;
+    unsigned long getVersion() const;
+    const TableVoyages & getVoyages() const;
+    const TableStations & getStations() const;
     const std::unordered_map<unsigned int, Ligne> & getLignes() const;
+    const std::unordered_set<std::string> & getServices() const;
     const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > & getTransferts() const;
+    const std::vector<const Voyage *> & getVoyagesDuBloc(const std::string &) const;
+    const IndexStations & getIndexStations() const;
+    const StatistiquesChargement & getStatistiques() const;
+    const DiagnosticsChargement & getDiagnostics() const;
+
+    static unsigned int identifiantGlobal(unsigned int p_reseau, unsigned int p_id);
+    static unsigned int reseauDe(unsigned int p_id_global);
+    static unsigned int identifiantLocal(unsigned int p_id_global);
+    static const unsigned int NB_BITS_IDENTIFIANT_LOCAL = 26; //stop_id et route_id d'un réseau: moins de 2^26
+    static const unsigned int NB_RESEAUX_MAX = 1u << (32 - NB_BITS_IDENTIFIANT_LOCAL);
+    const HorairesCompresses & getHoraires() const;
+    const Arene & getArene() const;
 
 private:
 
     std::vector<std::string> string_to_vector(const std::string &s, char delim);
+    void lireLignes(std::istream &, StatistiquesChargement &);
+    void lireStations(std::istream &, StatistiquesChargement &);
+    void lireServices(std::istream &, StatistiquesChargement &);
+    void lireVoyages(std::istream &, StatistiquesChargement &);
+    void lireArrets(std::istream &, StatistiquesChargement &);
+    void finaliserArrets(StatistiquesChargement &);
+    void lireTransferts(std::istream &, StatistiquesChargement &);
+    void chainerBlocs();
+    Voyage & chargerArretsDuVoyage(const std::string &);
+    void chargerDepuis(const std::function<std::unique_ptr<std::istream>(const std::string &)> &);
+    static void prechargerFichier(const std::string &);
+    static std::string texteStation(const Station &);
+    void fusionnerReseau(DonneesGTFS &, unsigned int, const std::string &);
+    void ajouterTransfertsEntreReseaux(double);
 
     Date m_date; //la date d'intérêt
     Heure m_now1;  //l'heure de début d'intérêt (à partir de laquelle on considère les arrêts)
@@ -63,13 +127,26 @@ private:
 
     unsigned int m_nbArrets; //le nombre d'arrets au total présents dans cet objet
     bool m_tousLesArretsPresents; //indique si tous les arrêts de la date et de l'intervalle [now1, now2) ont été ajoutés
+    //incrémenté à chaque modification des stations, voyages, arrêts ou transferts; lu par d'autres fils (CacheTrajets)
+    std::atomic<unsigned long> m_version;
+    Arene m_arene; //nœuds de m_stations, m_voyages et m_lignes_par_numero; déclarée avant eux pour être détruite après
+    HorairesCompresses m_horaires; //arrêts des voyages de m_voyages, lus aussi par les stations; détruits après eux
 
     std::unordered_map<unsigned int, Ligne> m_lignes; //la clé unsigned int est l'identifiant m_id de l'objet Ligne
-    std::map<unsigned int, Station> m_stations; //la clé unsigned int est l'identifiant m_id de l'objet Station
+    TableStations m_stations; //la clé unsigned int est l'identifiant m_id de l'objet Station
     std::unordered_set<std::string> m_services; //le string est l'identifiant du service (service_id)
-    std::map<std::string, Voyage> m_voyages; //le string est l'identifiant (trip_id) de l'objet Voyage
+    TableVoyages m_voyages; //le string est l'identifiant (trip_id) de l'objet Voyage
+    IndexVoyages m_index_voyages; //index par hachage des nœuds de m_voyages, reconstruit à chaque ajout ou retrait de voyages
     std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > m_transferts; // <from_station_id, to_station_id, transfer_time>
-    std::multimap<std::string, Ligne> m_lignes_par_numero; //le string est l'attribut m_numero de l'objet ligne
+    std::multimap<std::string, Ligne, std::less<std::string>, AllocateurArene<std::pair<const std::string, Ligne> > >
+            m_lignes_par_numero; //le string est l'attribut m_numero de l'objet ligne
+    IndexStations m_index_stations; //index de recherche par nom sur les stations de m_stations
+    std::unordered_map<std::string, std::vector<const Voyage *> > m_voyages_par_bloc; //le string est le block_id; voyages de m_voyages triés par heure de départ
+    IndexArrets m_index_arrets; //positions des lignes de stop_times.txt, pour le chargement à la demande des arrêts
+    std::unordered_set<std::string> m_voyages_charges; //voyages dont les arrêts ont été chargés à la demande
+    std::unordered_set<unsigned int> m_stations_chargees; //stations dont les arrêts ont été chargés à la demande
+    StatistiquesChargement m_statistiques; //mesures des phases de chargement (RTC_INSTRUMENTATION)
+    DiagnosticsChargement m_diagnostics; //champs qui n'ont pas pu être convertis, sautés ou fatals selon la politique
 
 };
 
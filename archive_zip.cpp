@@ -0,0 +1,502 @@
+//
+// Lecture en continu des fichiers d'une archive .zip (sans extraction sur disque)
+//
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <streambuf>
+#include "archive_zip.h"
+
+using namespace std;
+
+namespace
+{
+    const uint32_t SIGNATURE_FIN = 0x06054b50;
+    const uint32_t SIGNATURE_CENTRAL = 0x02014b50;
+    const uint32_t SIGNATURE_LOCAL = 0x04034b50;
+
+    uint16_t lire16(const unsigned char *p)
+    {
+        return (uint16_t) (p[0] | p[1] << 8);
+    }
+
+    uint32_t lire32(const unsigned char *p)
+    {
+        return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+    }
+
+    //! \brief lit exactement p_taille octets à la position courante, ou lance logic_error
+    void lireOctets(istream &p_fichier, unsigned char *p_tampon, size_t p_taille)
+    {
+        if (!p_fichier.read(reinterpret_cast<char *>(p_tampon), p_taille))
+            throw logic_error("Archive zip tronquée.");
+    }
+
+    struct TableCRC
+    {
+        uint32_t valeurs[256];
+
+        TableCRC()
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                valeurs[n] = c;
+            }
+        }
+    };
+
+    uint32_t majCRC(uint32_t p_crc, const char *p_octets, size_t p_taille)
+    {
+        static const TableCRC table;
+        uint32_t c = ~p_crc;
+        for (size_t i = 0; i < p_taille; ++i) c = table.valeurs[(c ^ (unsigned char) p_octets[i]) & 0xFF] ^ (c >> 8);
+        return ~c;
+    }
+
+    /*!
+     * \brief Code de Huffman canonique (RFC 1951, section 3.2.2): nombre de codes par longueur et symboles
+     * triés par code. Le décodage procède bit par bit en comparant au premier code de chaque longueur.
+     */
+    struct Huffman
+    {
+        static const int LONGUEUR_MAX = 15;
+        uint16_t compte[LONGUEUR_MAX + 1];
+        uint16_t symboles[320];
+
+        void construire(const uint8_t *p_longueurs, int p_nbSymboles)
+        {
+            fill(compte, compte + LONGUEUR_MAX + 1, 0);
+            for (int s = 0; s < p_nbSymboles; ++s) ++compte[p_longueurs[s]];
+            int restants = 1;
+            for (int l = 1; l <= LONGUEUR_MAX; ++l)
+            {
+                restants = (restants << 1) - compte[l];
+                if (restants < 0) throw logic_error("Archive zip corrompue: code de Huffman invalide.");
+            }
+            uint16_t positions[LONGUEUR_MAX + 1];
+            positions[1] = 0;
+            for (int l = 1; l < LONGUEUR_MAX; ++l) positions[l + 1] = positions[l] + compte[l];
+            for (int s = 0; s < p_nbSymboles; ++s)
+            {
+                if (p_longueurs[s] != 0) symboles[positions[p_longueurs[s]]++] = (uint16_t) s;
+            }
+            compte[0] = 0;
+        }
+    };
+
+    const uint16_t BASE_LONGUEUR[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67,
+                                        83, 99, 115, 131, 163, 195, 227, 258};
+    const uint8_t EXTRA_LONGUEUR[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5,
+                                        5, 5, 0};
+    const uint16_t BASE_DISTANCE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    const uint8_t EXTRA_DISTANCE[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11,
+                                        11, 12, 12, 13, 13};
+
+    /*!
+     * \class TamponMembre
+     * \brief streambuf qui lit un fichier d'archive et le décompresse par tranches.
+     *
+     * La sortie est accumulée dans un tampon qui conserve toujours les 32 derniers Ko déjà livrés (la fenêtre
+     * des références arrière de deflate). Le décodage s'interrompt entre deux symboles dès qu'une tranche est
+     * pleine et reprend au prochain underflow() avec le même bloc et les mêmes tables.
+     */
+    class TamponMembre : public streambuf
+    {
+
+    public:
+        TamponMembre(const string &p_chemin, uint64_t p_position, uint16_t p_methode, uint32_t p_tailleCompressee,
+                     uint32_t p_taille, uint32_t p_crc)
+                : m_fichier(p_chemin, ios::binary), m_methode(p_methode), m_restantEntree(p_tailleCompressee),
+                  m_tailleAttendue(p_taille), m_crcAttendu(p_crc), m_crc(0), m_taille(0), m_debutEntree(0),
+                  m_finEntree(0), m_bits(0), m_nbBits(0), m_etat(ENTETE), m_dernierBloc(false), m_restantStocke(0),
+                  m_position(0), m_sortie(FENETRE + 2 * TRANCHE + 258), m_entree(TRANCHE)
+        {
+            if (!m_fichier.good()) throw logic_error("Impossible d'ouvrir l'archive zip.");
+            unsigned char entete[30];
+            m_fichier.seekg((streamoff) p_position);
+            lireOctets(m_fichier, entete, sizeof(entete));
+            if (lire32(entete) != SIGNATURE_LOCAL) throw logic_error("Archive zip corrompue: en-tête local invalide.");
+            m_fichier.seekg(lire16(entete + 26) + lire16(entete + 28), ios::cur);
+            if (m_methode != 0 && m_methode != 8) throw logic_error("Archive zip: méthode de compression non supportée.");
+            if (m_methode == 0)
+            {
+                // Fichier non compressé: un seul bloc stocké qui couvre tout le fichier
+                m_etat = STOCKE;
+                m_restantStocke = p_tailleCompressee;
+                m_dernierBloc = true;
+            }
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            while (gptr() == egptr())
+            {
+                if (m_etat == FIN)
+                {
+                    verifier();
+                    return traits_type::eof();
+                }
+                if (m_position + TRANCHE + 258 > m_sortie.size())
+                {
+                    // Garder seulement la fenêtre des références arrière
+                    memmove(&m_sortie[0], &m_sortie[m_position - FENETRE], FENETRE);
+                    m_position = FENETRE;
+                }
+                const size_t debut = m_position;
+                inflater(debut + TRANCHE);
+                m_crc = majCRC(m_crc, &m_sortie[debut], m_position - debut);
+                m_taille += m_position - debut;
+                setg(&m_sortie[debut], &m_sortie[debut], &m_sortie[0] + m_position);
+            }
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        enum Etat
+        {
+            ENTETE, STOCKE, HUFFMAN, FIN
+        };
+
+        static const size_t FENETRE = 32768;
+        static const size_t TRANCHE = 32768;
+
+        void verifier()
+        {
+            if (m_taille != m_tailleAttendue || m_crc != m_crcAttendu)
+            {
+                m_crcAttendu = m_crc; //une seule exception, même si le flux est relu
+                m_tailleAttendue = m_taille;
+                throw logic_error("Archive zip corrompue: CRC ou taille invalide.");
+            }
+        }
+
+        unsigned char octet()
+        {
+            if (m_debutEntree == m_finEntree)
+            {
+                if (m_restantEntree == 0) throw logic_error("Archive zip corrompue: données compressées tronquées.");
+                size_t n = min<size_t>(m_entree.size(), m_restantEntree);
+                lireOctets(m_fichier, &m_entree[0], n);
+                m_restantEntree -= (uint32_t) n;
+                m_debutEntree = 0;
+                m_finEntree = n;
+            }
+            return m_entree[m_debutEntree++];
+        }
+
+        unsigned int bits(int p_nb)
+        {
+            while (m_nbBits < p_nb)
+            {
+                m_bits |= (uint32_t) octet() << m_nbBits;
+                m_nbBits += 8;
+            }
+            unsigned int valeur = m_bits & ((1u << p_nb) - 1);
+            m_bits >>= p_nb;
+            m_nbBits -= p_nb;
+            return valeur;
+        }
+
+        int decoder(const Huffman &p_code)
+        {
+            int code = 0, premier = 0, index = 0;
+            for (int l = 1; l <= Huffman::LONGUEUR_MAX; ++l)
+            {
+                code |= (int) bits(1);
+                int compte = p_code.compte[l];
+                if (code - compte < premier) return p_code.symboles[index + (code - premier)];
+                index += compte;
+                premier = (premier + compte) << 1;
+                code <<= 1;
+            }
+            throw logic_error("Archive zip corrompue: code de Huffman inconnu.");
+        }
+
+        //! \brief copie les octets non compressés du bloc courant jusqu'à p_cible
+        void copierStocke(size_t p_cible)
+        {
+            while (m_position < p_cible && m_restantStocke > 0)
+            {
+                if (m_debutEntree == m_finEntree)
+                {
+                    m_sortie[m_position++] = (char) octet();
+                    --m_restantStocke;
+                    continue;
+                }
+                size_t n = min(min<size_t>(m_restantStocke, p_cible - m_position), m_finEntree - m_debutEntree);
+                memcpy(&m_sortie[m_position], &m_entree[m_debutEntree], n);
+                m_debutEntree += n;
+                m_position += n;
+                m_restantStocke -= (unsigned int) n;
+            }
+        }
+
+        void lireEnteteBloc()
+        {
+            if (m_dernierBloc)
+            {
+                m_etat = FIN;
+                return;
+            }
+            m_dernierBloc = bits(1) == 1;
+            switch (bits(2))
+            {
+                case 0:
+                {
+                    m_bits = 0;
+                    m_nbBits = 0;
+                    unsigned int longueur = octet();
+                    longueur |= (unsigned int) octet() << 8;
+                    unsigned int complement = octet();
+                    complement |= (unsigned int) octet() << 8;
+                    if ((longueur ^ 0xFFFF) != complement) throw logic_error("Archive zip corrompue: bloc stocké invalide.");
+                    m_restantStocke = longueur;
+                    m_etat = STOCKE;
+                    break;
+                }
+                case 1:
+                {
+                    uint8_t longueurs[288 + 30];
+                    fill(longueurs, longueurs + 144, 8);
+                    fill(longueurs + 144, longueurs + 256, 9);
+                    fill(longueurs + 256, longueurs + 280, 7);
+                    fill(longueurs + 280, longueurs + 288, 8);
+                    fill(longueurs + 288, longueurs + 318, 5);
+                    m_litteraux.construire(longueurs, 288);
+                    m_distances.construire(longueurs + 288, 30);
+                    m_etat = HUFFMAN;
+                    break;
+                }
+                case 2:
+                    lireTablesDynamiques();
+                    m_etat = HUFFMAN;
+                    break;
+                default:
+                    throw logic_error("Archive zip corrompue: type de bloc invalide.");
+            }
+        }
+
+        void lireTablesDynamiques()
+        {
+            static const uint8_t ORDRE[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+            const int nbLitteraux = (int) bits(5) + 257;
+            const int nbDistances = (int) bits(5) + 1;
+            const int nbCodes = (int) bits(4) + 4;
+            if (nbLitteraux > 286 || nbDistances > 30) throw logic_error("Archive zip corrompue: tables invalides.");
+
+            uint8_t longueurs[286 + 30] = {0};
+            for (int i = 0; i < nbCodes; ++i) longueurs[ORDRE[i]] = (uint8_t) bits(3);
+            Huffman codeLongueurs;
+            codeLongueurs.construire(longueurs, 19);
+
+            fill(longueurs, longueurs + 19, 0);
+            int i = 0;
+            while (i < nbLitteraux + nbDistances)
+            {
+                int symbole = decoder(codeLongueurs);
+                if (symbole < 16)
+                {
+                    longueurs[i++] = (uint8_t) symbole;
+                    continue;
+                }
+                uint8_t valeur = 0;
+                int repetitions;
+                if (symbole == 16)
+                {
+                    if (i == 0) throw logic_error("Archive zip corrompue: répétition sans longueur.");
+                    valeur = longueurs[i - 1];
+                    repetitions = 3 + (int) bits(2);
+                } else if (symbole == 17) repetitions = 3 + (int) bits(3);
+                else repetitions = 11 + (int) bits(7);
+                if (i + repetitions > nbLitteraux + nbDistances) throw logic_error("Archive zip corrompue: tables invalides.");
+                while (repetitions--) longueurs[i++] = valeur;
+            }
+            m_litteraux.construire(longueurs, nbLitteraux);
+            m_distances.construire(longueurs + nbLitteraux, nbDistances);
+        }
+
+        //! \brief décode des blocs deflate jusqu'à ce que m_position atteigne p_cible ou que le flux se termine
+        void inflater(size_t p_cible)
+        {
+            while (m_position < p_cible && m_etat != FIN)
+            {
+                if (m_etat == ENTETE)
+                {
+                    lireEnteteBloc();
+                } else if (m_etat == STOCKE)
+                {
+                    copierStocke(p_cible);
+                    if (m_restantStocke == 0) m_etat = ENTETE;
+                } else
+                {
+                    int symbole = decoder(m_litteraux);
+                    if (symbole < 256)
+                    {
+                        m_sortie[m_position++] = (char) symbole;
+                    } else if (symbole == 256)
+                    {
+                        m_etat = ENTETE;
+                    } else
+                    {
+                        symbole -= 257;
+                        if (symbole >= 29) throw logic_error("Archive zip corrompue: longueur invalide.");
+                        size_t longueur = BASE_LONGUEUR[symbole] + bits(EXTRA_LONGUEUR[symbole]);
+                        int codeDistance = decoder(m_distances);
+                        if (codeDistance >= 30) throw logic_error("Archive zip corrompue: distance invalide.");
+                        size_t distance = BASE_DISTANCE[codeDistance] + bits(EXTRA_DISTANCE[codeDistance]);
+                        if (distance > m_position) throw logic_error("Archive zip corrompue: distance trop grande.");
+                        // Copie octet par octet: la source peut chevaucher la destination
+                        char *destination = &m_sortie[m_position];
+                        const char *source = destination - distance;
+                        for (size_t k = 0; k < longueur; ++k) destination[k] = source[k];
+                        m_position += longueur;
+                    }
+                }
+            }
+        }
+
+        ifstream m_fichier;
+        uint16_t m_methode;
+        uint32_t m_restantEntree;
+        uint32_t m_tailleAttendue;
+        uint32_t m_crcAttendu;
+        uint32_t m_crc;
+        uint32_t m_taille;
+        size_t m_debutEntree;
+        size_t m_finEntree;
+        uint32_t m_bits;
+        int m_nbBits;
+        Etat m_etat;
+        bool m_dernierBloc;
+        unsigned int m_restantStocke;
+        Huffman m_litteraux;
+        Huffman m_distances;
+        size_t m_position;            //fin des octets décodés dans m_sortie
+        vector<char> m_sortie;
+        vector<unsigned char> m_entree;
+    };
+
+    //! \brief istream propriétaire de son TamponMembre; les erreurs de décompression sont relancées
+    class FluxMembre : public istream
+    {
+
+    public:
+        FluxMembre(const string &p_chemin, uint64_t p_position, uint16_t p_methode, uint32_t p_tailleCompressee,
+                   uint32_t p_taille, uint32_t p_crc)
+                : istream(nullptr), m_tampon(p_chemin, p_position, p_methode, p_tailleCompressee, p_taille, p_crc)
+        {
+            rdbuf(&m_tampon);
+            exceptions(badbit);
+        }
+
+    private:
+        TamponMembre m_tampon;
+    };
+}
+
+//! \brief lit le répertoire central d'une archive .zip
+//! \param[in] p_chemin: le chemin de l'archive
+//! \throws logic_error si l'archive ne peut pas être lue, est corrompue ou utilise ZIP64 ou le chiffrement
+ArchiveZip::ArchiveZip(const std::string &p_chemin) : m_chemin(p_chemin)
+{
+    ifstream fichier(p_chemin, ios::binary);
+    if (!fichier.good()) throw logic_error("Impossible d'ouvrir l'archive zip " + p_chemin + ".");
+
+    // L'enregistrement de fin est dans les derniers 22 + 65535 octets (commentaire de taille maximale)
+    fichier.seekg(0, ios::end);
+    const uint64_t tailleFichier = (uint64_t) fichier.tellg();
+    const size_t tailleFin = (size_t) min<uint64_t>(tailleFichier, 22 + 65535);
+    vector<unsigned char> fin(tailleFin);
+    fichier.seekg((streamoff) (tailleFichier - tailleFin));
+    lireOctets(fichier, fin.data(), tailleFin);
+
+    size_t positionFin = tailleFin;
+    for (size_t i = tailleFin >= 22 ? tailleFin - 22 + 1 : 0; i-- > 0;)
+    {
+        if (lire32(&fin[i]) == SIGNATURE_FIN)
+        {
+            positionFin = i;
+            break;
+        }
+    }
+    if (positionFin == tailleFin) throw logic_error("Archive zip invalide: " + p_chemin + ".");
+
+    const uint16_t nbMembres = lire16(&fin[positionFin + 10]);
+    const uint32_t tailleRepertoire = lire32(&fin[positionFin + 12]);
+    const uint32_t positionRepertoire = lire32(&fin[positionFin + 16]);
+    if (nbMembres == 0xFFFF || positionRepertoire == 0xFFFFFFFFu)
+        throw logic_error("Archive zip: le format ZIP64 n'est pas supporté.");
+
+    vector<unsigned char> repertoire(tailleRepertoire);
+    fichier.seekg(positionRepertoire);
+    lireOctets(fichier, repertoire.data(), tailleRepertoire);
+
+    size_t p = 0;
+    for (uint16_t i = 0; i < nbMembres; ++i)
+    {
+        if (p + 46 > repertoire.size() || lire32(&repertoire[p]) != SIGNATURE_CENTRAL)
+            throw logic_error("Archive zip corrompue: répertoire central invalide.");
+        const unsigned char *e = &repertoire[p];
+        const uint16_t longueurNom = lire16(e + 28);
+        const size_t longueurEntree = 46 + longueurNom + lire16(e + 30) + lire16(e + 32);
+        if (p + longueurEntree > repertoire.size())
+            throw logic_error("Archive zip corrompue: répertoire central invalide.");
+
+        Membre membre;
+        membre.nom.assign(reinterpret_cast<const char *>(e + 46), longueurNom);
+        membre.methode = lire16(e + 10);
+        membre.crc = lire32(e + 16);
+        membre.tailleCompressee = lire32(e + 20);
+        membre.taille = lire32(e + 24);
+        membre.positionEntete = lire32(e + 42);
+        if (lire16(e + 8) & 1) throw logic_error("Archive zip: les fichiers chiffrés ne sont pas supportés.");
+        if (membre.tailleCompressee == 0xFFFFFFFFu || membre.taille == 0xFFFFFFFFu || membre.positionEntete == 0xFFFFFFFFu)
+            throw logic_error("Archive zip: le format ZIP64 n'est pas supporté.");
+        m_membres.push_back(membre);
+        p += longueurEntree;
+    }
+}
+
+//! \brief retourne les noms des fichiers de l'archive, dans l'ordre du répertoire central
+std::vector<std::string> ArchiveZip::getNoms() const
+{
+    vector<string> noms;
+    for (const Membre &m : m_membres) noms.push_back(m.nom);
+    return noms;
+}
+
+bool ArchiveZip::contient(const std::string &p_nom) const
+{
+    return trouver(p_nom) != nullptr;
+}
+
+//! \brief ouvre un fichier de l'archive en flux décompressé à la volée
+//! \param[in] p_nom: le nom exact du fichier, ou son nom sans le dossier (ex.: "stops.txt" pour "RTC/stops.txt")
+//! \return le flux, ou nullptr si l'archive ne contient pas ce fichier
+//! \throws logic_error si l'en-tête du fichier est invalide; les erreurs de décompression sont lancées à la lecture
+std::unique_ptr<std::istream> ArchiveZip::ouvrir(const std::string &p_nom) const
+{
+    const Membre *membre = trouver(p_nom);
+    if (!membre) return unique_ptr<istream>();
+    return unique_ptr<istream>(new FluxMembre(m_chemin, membre->positionEntete, membre->methode,
+                                              membre->tailleCompressee, membre->taille, membre->crc));
+}
+
+const ArchiveZip::Membre *ArchiveZip::trouver(const std::string &p_nom) const
+{
+    const Membre *sansDossier = nullptr;
+    for (const Membre &m : m_membres)
+    {
+        if (m.nom == p_nom) return &m;
+        if (!sansDossier && m.nom.size() > p_nom.size() && m.nom[m.nom.size() - p_nom.size() - 1] == '/' &&
+            m.nom.compare(m.nom.size() - p_nom.size(), p_nom.size(), p_nom) == 0)
+            sansDossier = &m;
+    }
+    return sansDossier;
+}
@@ -0,0 +1,50 @@
+//
+// Lecture en continu des fichiers d'une archive .zip (sans extraction sur disque)
+//
+
+#ifndef RTC_ARCHIVE_ZIP_H
+#define RTC_ARCHIVE_ZIP_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*!
+ * \class ArchiveZip
+ * \brief Répertoire central d'une archive .zip et ouverture de ses fichiers en flux.
+ *
+ * Chaque fichier ouvert est décompressé à la volée (méthodes «stored» et «deflate», décodeur deflate intégré)
+ * par tranches de 32 Ko: rien n'est écrit sur le disque et le fichier n'est jamais entièrement en mémoire.
+ * Le CRC-32 est vérifié à la fin de chaque fichier. Plusieurs fichiers peuvent être lus en même temps, par des
+ * fils différents: chaque flux a sa propre ouverture de l'archive.
+ */
+class ArchiveZip
+{
+
+public:
+    explicit ArchiveZip(const std::string &p_chemin);
+
+    std::vector<std::string> getNoms() const;
+    bool contient(const std::string &p_nom) const;
+    std::unique_ptr<std::istream> ouvrir(const std::string &p_nom) const;
+
+private:
+    struct Membre
+    {
+        std::string nom;
+        std::uint16_t methode;         //0: stored, 8: deflate
+        std::uint32_t crc;
+        std::uint32_t tailleCompressee;
+        std::uint32_t taille;
+        std::uint32_t positionEntete;  //position de l'en-tête local dans l'archive
+    };
+
+    const Membre *trouver(const std::string &p_nom) const;
+
+    std::string m_chemin;
+    std::vector<Membre> m_membres;
+};
+
+#endif //RTC_ARCHIVE_ZIP_H
@@ -0,0 +1,117 @@
+//
+// Arène monotone pour les conteneurs à nœuds de DonneesGTFS
+//
+
+#include <cstdint>
+#include "arene.h"
+
+using namespace std;
+
+thread_local Arene *Arene::s_courante = nullptr;
+
+namespace
+{
+    //! \brief verrou tournant sur un atomic_flag; les sections protégées ne font que quelques instructions
+    class Verrou
+    {
+    public:
+        explicit Verrou(atomic_flag &p_drapeau) : m_drapeau(p_drapeau)
+        {
+            while (m_drapeau.test_and_set(memory_order_acquire));
+        }
+
+        ~Verrou()
+        {
+            m_drapeau.clear(memory_order_release);
+        }
+
+    private:
+        atomic_flag &m_drapeau;
+    };
+}
+
+//! \param[in] p_tailleBloc: la taille des blocs; au-delà du seuil mmap de malloc, vider() les rend au système
+Arene::Arene(std::size_t p_tailleBloc)
+        : m_tailleBloc(p_tailleBloc), m_position(nullptr), m_fin(nullptr), m_octetsReserves(0), m_octetsUtilises(0),
+          m_nbAllocations(0)
+{
+    m_verrou.clear();
+}
+
+Arene::~Arene()
+{
+    vider();
+}
+
+//! \brief réserve p_octets alignés sur p_alignement dans le bloc courant, ou dans un nouveau bloc s'il est plein
+//! \brief une demande de plus du quart d'un bloc reçoit son propre bloc, sans abandonner le bloc courant
+void *Arene::allouer(std::size_t p_octets, std::size_t p_alignement)
+{
+    Verrou verrou(m_verrou);
+    ++m_nbAllocations;
+    m_octetsUtilises += p_octets;
+
+    if (p_octets > m_tailleBloc / 4) return nouveauBloc(p_octets);
+
+    uintptr_t debut = ((uintptr_t) m_position + p_alignement - 1) & ~(uintptr_t) (p_alignement - 1);
+    if (!m_position || debut + p_octets > (uintptr_t) m_fin)
+    {
+        m_position = static_cast<char *>(nouveauBloc(m_tailleBloc));
+        m_fin = m_position + m_tailleBloc;
+        debut = (uintptr_t) m_position; //les blocs de operator new sont alignés pour tout type fondamental
+    }
+    m_position = (char *) (debut + p_octets);
+    return (void *) debut;
+}
+
+void *Arene::nouveauBloc(std::size_t p_octets)
+{
+    void *bloc = ::operator new(p_octets);
+    m_blocs.push_back(bloc);
+    m_octetsReserves += p_octets;
+    return bloc;
+}
+
+//! \brief rend tous les blocs d'un coup
+//! \pre plus aucun conteneur n'utilise la mémoire de l'arène
+void Arene::vider()
+{
+    Verrou verrou(m_verrou);
+    for (void *bloc : m_blocs) ::operator delete(bloc);
+    m_blocs.clear();
+    m_blocs.shrink_to_fit();
+    m_position = nullptr;
+    m_fin = nullptr;
+    m_octetsReserves = 0;
+    m_octetsUtilises = 0;
+    m_nbAllocations = 0;
+}
+
+std::size_t Arene::getNbBlocs() const
+{
+    return m_blocs.size();
+}
+
+//! \brief retourne le nombre d'octets obtenus du tas, dans l'ensemble des blocs
+std::size_t Arene::getOctetsReserves() const
+{
+    return m_octetsReserves;
+}
+
+//! \brief retourne le nombre d'octets demandés par les conteneurs, libérations ignorées
+std::size_t Arene::getOctetsUtilises() const
+{
+    return m_octetsUtilises;
+}
+
+//! \brief retourne le nombre d'allocations servies par l'arène depuis sa création ou le dernier vider()
+unsigned long long Arene::getNbAllocations() const
+{
+    return m_nbAllocations;
+}
+
+//! \brief retourne l'arène de la PorteeArene active dans ce fil, nullptr s'il n'y en a pas
+Arene *Arene::courante()
+{
+    return s_courante;
+}
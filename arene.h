@@ -0,0 +1,154 @@
+//
+// Arène monotone pour les conteneurs à nœuds de DonneesGTFS
+//
+
+#ifndef RTC_ARENE_H
+#define RTC_ARENE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/*!
+ * \class Arene
+ * \brief Allocateur monotone: les blocs sont découpés séquentiellement et ne sont rendus qu'en une fois, par vider()
+ * ou à la destruction.
+ *
+ * Les libérations individuelles sont ignorées; la mémoire des nœuds effacés par les passes de suppression de
+ * DonneesGTFS reste donc réservée jusqu'à la destruction, mais le tas n'est plus fragmenté par des millions de
+ * petits nœuds. allouer() est protégé par un verrou tournant, puisque charger() remplit plusieurs conteneurs en
+ * parallèle.
+ */
+class Arene
+{
+
+public:
+    explicit Arene(std::size_t p_tailleBloc = 1 << 18);
+    ~Arene();
+
+    void *allouer(std::size_t p_octets, std::size_t p_alignement);
+    void vider();
+
+    std::size_t getNbBlocs() const;
+    std::size_t getOctetsReserves() const;
+    std::size_t getOctetsUtilises() const;
+    unsigned long long getNbAllocations() const;
+
+    static Arene *courante();
+
+private:
+    Arene(const Arene &);
+    Arene &operator=(const Arene &);
+
+    void *nouveauBloc(std::size_t p_octets);
+
+    std::size_t m_tailleBloc;
+    std::vector<void *> m_blocs;
+    char *m_position;           //prochain octet libre du bloc courant
+    char *m_fin;                //fin du bloc courant
+    std::size_t m_octetsReserves;
+    std::size_t m_octetsUtilises;
+    unsigned long long m_nbAllocations;
+    std::atomic_flag m_verrou;
+
+    friend class PorteeArene;
+    static thread_local Arene *s_courante;
+};
+
+/*!
+ * \class PorteeArene
+ * \brief Désigne, pour le fil courant et jusqu'à sa destruction, l'arène des conteneurs construits par défaut ou
+ * copiés avec un AllocateurArene (ex.: un conteneur à nœuds membre d'un objet créé pendant la lecture d'un fichier).
+ */
+class PorteeArene
+{
+
+public:
+    explicit PorteeArene(Arene &p_arene) : m_precedente(Arene::s_courante)
+    {
+        Arene::s_courante = &p_arene;
+    }
+
+    ~PorteeArene()
+    {
+        Arene::s_courante = m_precedente;
+    }
+
+private:
+    PorteeArene(const PorteeArene &);
+    PorteeArene &operator=(const PorteeArene &);
+
+    Arene *m_precedente;
+};
+
+/*!
+ * \class AllocateurArene
+ * \brief Allocateur standard qui puise dans une Arene, ou dans le tas s'il n'est rattaché à aucune arène.
+ *
+ * Construit par défaut, il se rattache à l'arène de la PorteeArene active; une copie de conteneur fait de même
+ * (select_on_container_copy_construction), et une affectation garde l'allocateur de sa destination: un Voyage ou
+ * une Station copié hors du chargement n'utilise jamais une arène qui pourrait disparaître avant lui.
+ */
+template<typename T>
+class AllocateurArene
+{
+
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    AllocateurArene() : m_arene(Arene::courante())
+    {
+    }
+
+    explicit AllocateurArene(Arene *p_arene) : m_arene(p_arene)
+    {
+    }
+
+    template<typename U>
+    AllocateurArene(const AllocateurArene<U> &p_autre) : m_arene(p_autre.getArene())
+    {
+    }
+
+    T *allocate(std::size_t p_nb)
+    {
+        if (m_arene) return static_cast<T *>(m_arene->allouer(p_nb * sizeof(T), alignof(T)));
+        return static_cast<T *>(::operator new(p_nb * sizeof(T)));
+    }
+
+    void deallocate(T *p_ptr, std::size_t)
+    {
+        if (!m_arene) ::operator delete(p_ptr);
+    }
+
+    AllocateurArene select_on_container_copy_construction() const
+    {
+        return AllocateurArene();
+    }
+
+    Arene *getArene() const
+    {
+        return m_arene;
+    }
+
+private:
+    Arene *m_arene;
+};
+
+template<typename T, typename U>
+bool operator==(const AllocateurArene<T> &p_a, const AllocateurArene<U> &p_b)
+{
+    return p_a.getArene() == p_b.getArene();
+}
+
+template<typename T, typename U>
+bool operator!=(const AllocateurArene<T> &p_a, const AllocateurArene<U> &p_b)
+{
+    return p_a.getArene() != p_b.getArene();
+}
+
+#endif //RTC_ARENE_H
@@ -5,13 +5,22 @@
 
 #include "arret.h"
 
+namespace
+{
+    const std::string &aucunVoyage()
+    {
+        static const std::string vide;
+        return vide;
+    }
+}
+
 /*!
  *  \brief Constructeur de la classe Arret
  *  \param[in] p_station_id : identificateur de station
  *  \param[in] p_heure_depart: heure de départ
  *  \param[in] p_heure_arrivee: heure d'arrivée
  *  \param[in] p_numero_sequence: numéro de séquence de l'arrêt dans le voyage
- *  \param[in] p_voyage_id: identificateur du voyage
+ *  \param[in] p_voyage_id: identificateur du voyage, qui doit survivre à l'arrêt (normalement celui du Voyage)
  *   	Pour votre information le fichier stop_times.txt comprend des données relatives aux arrêts effectués par les autobus ;
  *		il est composé des champs :
  *		- trip_id : identifiant du voyage ;
@@ -31,7 +40,12 @@
 Arret::Arret(unsigned int p_station_id, const Heure &p_heure_arrivee, const Heure &p_heure_depart,
              unsigned int p_numero_sequence, const std::string &p_voyage_id)
         : m_station_id(p_station_id), m_heure_arrivee(p_heure_arrivee), m_heure_depart(p_heure_depart),
-          m_numero_sequence(p_numero_sequence), m_voyage_id(p_voyage_id)
+          m_numero_sequence(p_numero_sequence), m_voyage_id(&p_voyage_id)
+{
+}
+
+//! \brief Constructeur d'un arrêt vide, sans voyage (ex.: au bout d'un parcours des arrêts d'un voyage)
+Arret::Arret() : m_station_id(0), m_numero_sequence(0), m_voyage_id(&aucunVoyage())
 {
 }
 
@@ -105,8 +119,8 @@ std::ostream &operator<<(std::ostream &flux, const Arret &p_arret)
     return flux;
 }
 
-std::string Arret::getVoyageId() const
+const std::string &Arret::getVoyageId() const
 {
-    return m_voyage_id;
+    return *m_voyage_id;
 }
 
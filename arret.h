@@ -8,7 +8,7 @@
 #ifndef RTC_ARRET_H
 #define RTC_ARRET_H
 
-#include <memory>
+#include <string>
 #include "auxiliaires.h"
 
 
@@ -20,19 +20,20 @@
 *  (ex: la ligne 800 effectue un arrêt à la station du desjardin à 11h32).
 *  Il est important de ne confondre la station et l'arret.
 *
+*  Les arrêts ne sont plus conservés tels quels: Voyage et Station les reconstruisent à la lecture à partir des
+*  horaires compressés (voir HorairesCompresses). Un Arret est donc une petite valeur, à copier au besoin.
 */
 class Arret {
 
 public:
-	typedef std::shared_ptr<Arret> Ptr;  //permet le raccourcis Arret::Ptr à l'externe
-
+	Arret();
 	Arret(unsigned int p_station_id, const Heure & p_heure_arrivee, const Heure & p_heure_depart,
           unsigned int p_numero_sequence, const std::string & p_voyage_id);
 	const Heure & getHeureArrivee() const;
 	const Heure & getHeureDepart() const;
 	unsigned int getNumeroSequence() const;
 	unsigned int getStationId() const;
-	std::string getVoyageId() const;
+	const std::string & getVoyageId() const;
 
 	bool operator< (const Arret & p_other) const;
 	bool operator> (const Arret & p_other) const;
@@ -44,7 +45,7 @@ private:
 	Heure m_heure_arrivee;
 	Heure m_heure_depart;
 	unsigned int m_numero_sequence;
-	std::string m_voyage_id;
+	const std::string * m_voyage_id; //identifiant du voyage, qui doit survivre à l'arrêt
 };
 
 
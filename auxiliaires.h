@@ -18,27 +18,61 @@
 /*!
  * \class Date
  * \brief Cette classe représente une date.
+ * Elle tient dans un seul entier (AAAA * 512 + MM * 32 + JJ), dont l'ordre est celui des dates; elle se copie et se
+ * compare comme un entier, et ses champs sont décodés seulement pour l'affichage.
  */
 class Date
 {
 
 public:
-    Date();
-    Date(unsigned int an, unsigned int mois, unsigned int jour);
-    bool operator==(const Date &other) const;
-    bool operator<(const Date &other) const;
-    bool operator>(const Date &other) const;
-    friend std::ostream &operator<<(std::ostream &flux, const Date &p_date);
+    //! \brief date nulle (0000-00-00); voir aujourdhui() pour la date actuelle
+    constexpr Date() : m_code(0)
+    {
+    }
 
+    //! \param[in] an: l'année de la date
+    //! \param[in] mois: le mois de la date, de 1 à 12
+    //! \param[in] jour: le jour de la date, de 1 à 31
+    constexpr Date(unsigned int an, unsigned int mois, unsigned int jour) : m_code(an * 512 + mois * 32 + jour)
+    {
+    }
 
-private:
-    int m_code; // nombre de jours depuis 1970-01-01 pour la date en parametre
-    unsigned int m_an;
-    unsigned int m_mois;
-    unsigned int m_jour;
+    static Date aujourdhui();
+
+    constexpr bool operator==(const Date &other) const
+    {
+        return m_code == other.m_code;
+    }
+
+    constexpr bool operator<(const Date &other) const
+    {
+        return m_code < other.m_code;
+    }
+
+    constexpr bool operator>(const Date &other) const
+    {
+        return m_code > other.m_code;
+    }
+
+    constexpr unsigned int getAn() const
+    {
+        return m_code / 512;
+    }
+
+    constexpr unsigned int getMois() const
+    {
+        return m_code / 32 % 16;
+    }
 
-    void encode(unsigned int an, unsigned int mois, unsigned int jour);
+    constexpr unsigned int getJour() const
+    {
+        return m_code % 32;
+    }
 
+    friend std::ostream &operator<<(std::ostream &flux, const Date &p_date);
+
+private:
+    unsigned int m_code; // AAAA * 512 + MM * 32 + JJ
 };
 
 
@@ -46,29 +80,87 @@ private:
  * \class Heure
  * \brief Cette classe représente l'heure d'une journée.
  * Cependant pour les besoins du travail pratique nous permettont qu'elle puisse encoder un nombre d'heures supérieurs à 24
+ * Elle ne garde que le nombre de secondes depuis 00h00m00s; heures, minutes et secondes en sont décodées à l'affichage.
  */
 class Heure
 {
 public:
-    Heure();
-
-    Heure(unsigned int heure, unsigned int min, unsigned int sec);
-    Heure add_secondes(unsigned int secs) const;
-    bool operator==(const Heure &other) const;
-    bool operator<(const Heure &other) const;
-    bool operator>(const Heure &other) const;
-    bool operator<=(const Heure &other) const;
-    bool operator>=(const Heure &other) const;
-    int operator-(const Heure &other) const;
+    //! \brief minuit (00:00:00); voir maintenant() pour l'heure actuelle
+    constexpr Heure() : m_code(0)
+    {
+    }
+
+    //! \param[in] heure: le nombre d'heures, qui peut dépasser 24
+    //! \param[in] min: le nombre de minutes dans l'heure
+    //! \param[in] sec: le nombre de secondes dans la minute
+    constexpr Heure(unsigned int heure, unsigned int min, unsigned int sec) : m_code((heure * 60 + min) * 60 + sec)
+    {
+    }
+
+    static Heure maintenant();
+
+    //! \return la nouvelle heure obtenue après l'ajout de secs secondes
+    constexpr Heure add_secondes(unsigned int secs) const
+    {
+        return Heure(0, 0, m_code + secs);
+    }
+
+    constexpr bool operator==(const Heure &other) const
+    {
+        return m_code == other.m_code;
+    }
+
+    constexpr bool operator<(const Heure &other) const
+    {
+        return m_code < other.m_code;
+    }
+
+    constexpr bool operator>(const Heure &other) const
+    {
+        return m_code > other.m_code;
+    }
+
+    constexpr bool operator<=(const Heure &other) const
+    {
+        return m_code <= other.m_code;
+    }
+
+    constexpr bool operator>=(const Heure &other) const
+    {
+        return m_code >= other.m_code;
+    }
+
+    //! \return le nombre de secondes (positif ou négatif) qui sépare les deux heures
+    constexpr int operator-(const Heure &other) const
+    {
+        return (int) m_code - (int) other.m_code;
+    }
+
+    constexpr unsigned int getHeures() const
+    {
+        return m_code / 3600;
+    }
+
+    constexpr unsigned int getMinutes() const
+    {
+        return m_code % 3600 / 60;
+    }
+
+    constexpr unsigned int getSecondes() const
+    {
+        return m_code % 60;
+    }
+
+    //! \return le nombre de secondes depuis 00h00m00s
+    constexpr unsigned int getSecondesDepuisMinuit() const
+    {
+        return m_code;
+    }
+
     friend std::ostream &operator<<(std::ostream &flux, const Heure &p_heure);
 
 private:
-    unsigned int m_code;
-    unsigned int m_heure;
-    unsigned int m_min;
-    unsigned int m_sec;
-
-    void encode(unsigned int heure, unsigned int min, unsigned int sec);
+    unsigned int m_code; // nombre de secondes depuis 00h00m00s
 };
 
 
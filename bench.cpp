@@ -0,0 +1,279 @@
+//
+// Banc d'essai reproductible: chargement, index et recherches, résultats en JSON
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "DonneesGTFS.h"
+
+using namespace std;
+
+namespace
+{
+    typedef chrono::steady_clock Horloge;
+
+    struct Mesure
+    {
+        string nom;
+        vector<double> millisecondes;
+        unsigned long long allocations;
+        string erreur;
+    };
+
+    struct Options
+    {
+        string dossier;
+        unsigned int repetitions;
+        unsigned int rechauffement;
+        unsigned int recherches;
+    };
+
+    Options lireOptions(int argc, char *argv[])
+    {
+        Options o = {"RTC-8aout-1dec", 5, 1, 100000};
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            if (!strcmp(argv[i], "--dossier")) o.dossier = argv[i + 1];
+            else if (!strcmp(argv[i], "--repetitions")) o.repetitions = (unsigned int) strtoul(argv[i + 1], nullptr, 10);
+            else if (!strcmp(argv[i], "--rechauffement")) o.rechauffement = (unsigned int) strtoul(argv[i + 1], nullptr, 10);
+            else if (!strcmp(argv[i], "--recherches")) o.recherches = (unsigned int) strtoul(argv[i + 1], nullptr, 10);
+            else
+            {
+                cerr << "Option inconnue: " << argv[i] << endl;
+                exit(2);
+            }
+        }
+        if (o.repetitions == 0) o.repetitions = 1;
+        return o;
+    }
+
+    //! \brief exécute p_etape, en mesurant sa durée et ses allocations, et retient l'erreur éventuelle
+    void chronometrer(Mesure &p_mesure, bool p_retenir, const function<void()> &p_etape)
+    {
+        unsigned long long allocations = StatistiquesChargement::getNbAllocations();
+        Horloge::time_point debut = Horloge::now();
+        try
+        {
+            p_etape();
+        } catch (const exception &e)
+        {
+            p_mesure.erreur = e.what();
+        }
+        double ms = chrono::duration<double, milli>(Horloge::now() - debut).count();
+        if (p_retenir)
+        {
+            p_mesure.millisecondes.push_back(ms);
+            p_mesure.allocations = StatistiquesChargement::getNbAllocations() - allocations;
+        }
+    }
+
+    //! \brief retourne la mémoire résidente actuelle du processus, en Ko
+    long rssCourantKo()
+    {
+        ifstream statm("/proc/self/statm");
+        long taille = 0, residente = 0;
+        statm >> taille >> residente;
+        return residente * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    string echapper(const string &p_texte)
+    {
+        string resultat;
+        for (char c : p_texte)
+        {
+            if (c == '"' || c == '\\') resultat.push_back('\\');
+            resultat.push_back(c);
+        }
+        return resultat;
+    }
+
+    void afficherMesure(const Mesure &p_mesure, const char *p_unite, double p_facteur, bool p_derniere)
+    {
+        vector<double> v(p_mesure.millisecondes);
+        sort(v.begin(), v.end());
+        double somme = 0;
+        for (double x : v) somme += x;
+        cout << "    {\"nom\": \"" << p_mesure.nom << "\"";
+        if (!v.empty())
+        {
+            cout << ", \"" << p_unite << "_min\": " << v.front() * p_facteur
+                 << ", \"" << p_unite << "_mediane\": " << v[v.size() / 2] * p_facteur
+                 << ", \"" << p_unite << "_moyenne\": " << somme / v.size() * p_facteur;
+        }
+        cout << ", \"allocations\": " << p_mesure.allocations;
+        if (!p_mesure.erreur.empty()) cout << ", \"erreur\": \"" << echapper(p_mesure.erreur) << "\"";
+        cout << "}" << (p_derniere ? "" : ",") << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const Options options = lireOptions(argc, argv);
+    const string &d = options.dossier;
+
+    Date today(2017, 8, 18);
+    Heure now1(8, 30, 0);
+    Heure now2 = now1.add_secondes(3600);
+
+    vector<Mesure> etapes(6);
+    const char *noms[6] = {"ajouterLignes", "ajouterStations", "ajouterServices", "ajouterVoyagesDeLaDate",
+                           "ajouterArretsDesVoyagesDeLaDate", "ajouterTransferts"};
+    for (size_t i = 0; i < etapes.size(); ++i) etapes[i].nom = noms[i];
+
+    Mesure total = {"chargement_total", vector<double>(), 0, ""};
+    Mesure concurrent = {"charger_concurrent", vector<double>(), 0, ""};
+    Mesure rechStation = {"recherche_station", vector<double>(), 0, ""};
+    Mesure rechVoyage = {"recherche_voyage", vector<double>(), 0, ""};
+    Mesure rechTransfert = {"recherche_transfert", vector<double>(), 0, ""};
+    Mesure rechNom = {"recherche_nom_station", vector<double>(), 0, ""};
+    string statistiques;
+    size_t nbLignes = 0, nbStations = 0, nbVoyages = 0, nbArrets = 0, nbTransferts = 0;
+    unsigned long long verification = 0;
+
+    for (unsigned int r = 0; r < options.rechauffement + options.repetitions; ++r)
+    {
+        const bool retenir = r >= options.rechauffement;
+        DonneesGTFS donnees(today, now1, now2);
+        Horloge::time_point debut = Horloge::now();
+        unsigned long long allocations = StatistiquesChargement::getNbAllocations();
+        chronometrer(etapes[0], retenir, [&]() { donnees.ajouterLignes(d + "/routes.txt"); });
+        chronometrer(etapes[1], retenir, [&]() { donnees.ajouterStations(d + "/stops.txt"); });
+        chronometrer(etapes[2], retenir, [&]() { donnees.ajouterServices(d + "/calendar_dates.txt"); });
+        chronometrer(etapes[3], retenir, [&]() { donnees.ajouterVoyagesDeLaDate(d + "/trips.txt"); });
+        chronometrer(etapes[4], retenir, [&]() { donnees.ajouterArretsDesVoyagesDeLaDate(d + "/stop_times.txt"); });
+        chronometrer(etapes[5], retenir, [&]() { donnees.ajouterTransferts(d + "/transfers.txt"); });
+        if (retenir)
+        {
+            total.millisecondes.push_back(chrono::duration<double, milli>(Horloge::now() - debut).count());
+            total.allocations = StatistiquesChargement::getNbAllocations() - allocations;
+        }
+
+        DonneesGTFS donneesConcurrentes(today, now1, now2);
+        chronometrer(concurrent, retenir, [&]() { donneesConcurrentes.charger(d); });
+
+        nbLignes = donnees.getNbLignes();
+        nbStations = donnees.getNbStations();
+        nbVoyages = donnees.getNbVoyages();
+        nbArrets = donnees.getNbArrets();
+        nbTransferts = donnees.getNbTransferts();
+        statistiques = donnees.getStatistiques().enJSON();
+
+        // Clés de recherche déterministes: la moitié présentes, la moitié absentes
+        mt19937 generateur(r);
+        vector<unsigned int> idsStations;
+        for (const auto &s : donnees.getStations()) idsStations.push_back(s.first);
+        vector<string> idsVoyages;
+        for (const auto &v : donnees.getVoyages()) idsVoyages.push_back(v.first);
+        vector<unsigned int> clesStations(options.recherches);
+        vector<string> clesVoyages(options.recherches);
+        for (unsigned int i = 0; i < options.recherches; ++i)
+        {
+            clesStations[i] = (i % 2 || idsStations.empty()) ? (unsigned int) generateur()
+                                                              : idsStations[generateur() % idsStations.size()];
+            clesVoyages[i] = (i % 2 || idsVoyages.empty()) ? to_string(generateur())
+                                                           : idsVoyages[generateur() % idsVoyages.size()];
+        }
+
+        chronometrer(rechStation, retenir, [&]()
+        {
+            for (unsigned int cle : clesStations) verification += donnees.getStations().count(cle);
+        });
+        chronometrer(rechVoyage, retenir, [&]()
+        {
+            for (const string &cle : clesVoyages) verification += donnees.getVoyages().count(cle);
+        });
+        chronometrer(rechTransfert, retenir, [&]()
+        {
+            const auto &transferts = donnees.getTransferts();
+            for (unsigned int i = 0; i < options.recherches / 100; ++i)
+            {
+                unsigned int cle = clesStations[i];
+                verification += count_if(transferts.begin(), transferts.end(),
+                                         [cle](const tuple<unsigned int, unsigned int, unsigned int> &t)
+                                         { return get<0>(t) == cle; });
+            }
+        });
+        chronometrer(rechNom, retenir, [&]()
+        {
+            const char *requetes[4] = {"grande allee", "station", "bégin", "cegep"};
+            for (unsigned int i = 0; i < options.recherches / 100; ++i)
+            {
+                verification += donnees.getIndexStations().rechercher(requetes[i % 4], 10).size();
+            }
+        });
+    }
+
+    // Mémoire d'un chargement complet, puis de sa destruction, qui rend d'un coup les nœuds puisés dans l'arène
+    const long rssAvant = rssCourantKo();
+    const unsigned long long allocationsAvant = StatistiquesChargement::getNbAllocations();
+    unique_ptr<DonneesGTFS> donneesMemoire(new DonneesGTFS(today, now1, now2));
+    string erreurMemoire;
+    try
+    {
+        donneesMemoire->charger(d);
+    } catch (const exception &e)
+    {
+        erreurMemoire = e.what();
+    }
+    const long rssCharge = rssCourantKo();
+    const unsigned long long allocationsChargement = StatistiquesChargement::getNbAllocations() - allocationsAvant;
+    const Arene &arene = donneesMemoire->getArene();
+    const size_t blocsArene = arene.getNbBlocs();
+    const size_t octetsReserves = arene.getOctetsReserves();
+    const size_t octetsUtilises = arene.getOctetsUtilises();
+    const unsigned long long allocationsArene = arene.getNbAllocations();
+    const unsigned long long allocationsAvantDestruction = StatistiquesChargement::getNbAllocations();
+    donneesMemoire.reset();
+    const long rssDetruit = rssCourantKo();
+    const unsigned long long allocationsDestruction =
+            StatistiquesChargement::getNbAllocations() - allocationsAvantDestruction;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // Les recherches sont rapportées en nanosecondes par recherche
+    const double nsParRecherche = 1e6 / max(1u, options.recherches);
+    const double nsParRechercheLineaire = 1e6 / max(1u, options.recherches / 100);
+
+    cout << fixed << setprecision(3);
+    cout << "{" << endl;
+    cout << "  \"dossier\": \"" << echapper(d) << "\"," << endl;
+    cout << "  \"repetitions\": " << options.repetitions << "," << endl;
+    cout << "  \"rechauffement\": " << options.rechauffement << "," << endl;
+    cout << "  \"compte\": {\"lignes\": " << nbLignes << ", \"stations\": " << nbStations << ", \"voyages\": "
+         << nbVoyages << ", \"arrets\": " << nbArrets << ", \"transferts\": " << nbTransferts << "}," << endl;
+    cout << "  \"etapes\": [" << endl;
+    for (const Mesure &m : etapes) afficherMesure(m, "ms", 1.0, false);
+    afficherMesure(total, "ms", 1.0, false);
+    afficherMesure(concurrent, "ms", 1.0, true);
+    cout << "  ]," << endl;
+    cout << "  \"recherches\": [" << endl;
+    afficherMesure(rechStation, "ns", nsParRecherche, false);
+    afficherMesure(rechVoyage, "ns", nsParRecherche, false);
+    afficherMesure(rechTransfert, "ns", nsParRechercheLineaire, false);
+    afficherMesure(rechNom, "ns", nsParRechercheLineaire, true);
+    cout << "  ]," << endl;
+    cout << "  \"phases\": " << statistiques << "," << endl;
+    cout << "  \"memoire\": {\"rss_avant_ko\": " << rssAvant << ", \"rss_charge_ko\": " << rssCharge
+         << ", \"rss_apres_destruction_ko\": " << rssDetruit << ", \"allocations_chargement\": " << allocationsChargement
+         << ", \"allocations_destruction\": " << allocationsDestruction << ", \"arene_blocs\": " << blocsArene
+         << ", \"arene_octets_reserves\": " << octetsReserves << ", \"arene_octets_utilises\": " << octetsUtilises
+         << ", \"arene_allocations\": " << allocationsArene;
+    if (!erreurMemoire.empty()) cout << ", \"erreur\": \"" << echapper(erreurMemoire) << "\"";
+    cout << "}," << endl;
+    cout << "  \"rss_max_ko\": " << usage.ru_maxrss << "," << endl;
+    cout << "  \"verification\": " << verification << endl;
+    cout << "}" << endl;
+    return 0;
+}
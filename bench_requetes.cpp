@@ -0,0 +1,123 @@
+//
+// Mesure du débit (requêtes par seconde) du planificateur origine-destination
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "DonneesGTFS.h"
+#include "planificateur.h"
+#include "cache_trajets.h"
+#include "routage_voyages.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    const std::string chemin_dossier = argc > 1 ? argv[1] : "RTC-8aout-1dec";
+    const size_t nbRequetes = argc > 2 ? (size_t) strtoul(argv[2], nullptr, 10) : 100000;
+    const unsigned int nbFils = argc > 3 ? (unsigned int) strtoul(argv[3], nullptr, 10) : 0;
+
+    Date today(2017, 8, 18);
+    Heure now1(8, 0, 0);
+    Heure now2 = now1.add_secondes(4 * 3600);
+    DonneesGTFS donnees_rtc(today, now1, now2);
+
+    donnees_rtc.ajouterLignes(chemin_dossier + "/routes.txt");
+    donnees_rtc.ajouterStations(chemin_dossier + "/stops.txt");
+    donnees_rtc.ajouterServices(chemin_dossier + "/calendar_dates.txt");
+    donnees_rtc.ajouterVoyagesDeLaDate(chemin_dossier + "/trips.txt");
+    donnees_rtc.ajouterArretsDesVoyagesDeLaDate(chemin_dossier + "/stop_times.txt");
+    donnees_rtc.ajouterTransferts(chemin_dossier + "/transfers.txt");
+
+    Planificateur planificateur(donnees_rtc);
+    cout << "Nombre de connexions = " << planificateur.getNbConnexions() << endl;
+
+    vector<unsigned int> stations;
+    for (const auto &stationM : donnees_rtc.getStations())
+    {
+        stations.push_back(stationM.first);
+    }
+    if (stations.empty())
+    {
+        cerr << "Aucune station chargée" << endl;
+        return 1;
+    }
+
+    // Requêtes déterministes: paires de stations et heures de départ tirées uniformément
+    mt19937 generateur(42);
+    uniform_int_distribution<size_t> tirageStation(0, stations.size() - 1);
+    uniform_int_distribution<unsigned int> tirageDepart(0, 2 * 3600);
+    vector<RequeteOD> requetes;
+    requetes.reserve(nbRequetes);
+    for (size_t i = 0; i < nbRequetes; ++i)
+    {
+        RequeteOD r = {stations[tirageStation(generateur)], stations[tirageStation(generateur)],
+                       now1.add_secondes(tirageDepart(generateur)), PROFIL_DEFAUT};
+        requetes.push_back(r);
+    }
+
+    typedef chrono::steady_clock Horloge;
+
+    Horloge::time_point debut = Horloge::now();
+    size_t trouvesBoucle = 0;
+    for (const auto &r : requetes)
+    {
+        trouvesBoucle += planificateur.calculerTrajet(r).trouve;
+    }
+    double secondesBoucle = chrono::duration<double>(Horloge::now() - debut).count();
+
+    // Un seul pool pour tous les lots: ses fils sont créés une fois et attendent entre deux lots
+    PoolTravail pool(nbFils);
+    debut = Horloge::now();
+    vector<ResultatOD> resultats = planificateur.calculerTrajets(requetes, pool);
+    double secondesLot = chrono::duration<double>(Horloge::now() - debut).count();
+    size_t trouvesLot = 0;
+    for (const auto &r : resultats)
+    {
+        trouvesLot += r.trouve;
+    }
+
+    cout << "Requetes = " << nbRequetes << " (trouvees: boucle " << trouvesBoucle << ", lot " << trouvesLot << ")"
+         << endl;
+    cout << "Boucle simple : " << nbRequetes / secondesBoucle << " requetes/s" << endl;
+    cout << "Lot parallele : " << nbRequetes / secondesLot << " requetes/s" << endl;
+
+    debut = Horloge::now();
+    RoutageParVoyages routage(donnees_rtc, pool);
+    double secondesPretraitement = chrono::duration<double>(Horloge::now() - debut).count();
+    debut = Horloge::now();
+    vector<ResultatOD> resultatsTB = routage.calculerTrajets(requetes, pool);
+    double secondesTB = chrono::duration<double>(Horloge::now() - debut).count();
+    size_t differences = 0;
+    for (size_t i = 0; i < nbRequetes; ++i)
+    {
+        differences += resultatsTB[i].trouve != resultats[i].trouve ||
+                       (resultats[i].trouve && !(resultatsTB[i].arrivee == resultats[i].arrivee));
+    }
+    cout << "Trip-Based    : " << nbRequetes / secondesTB << " requetes/s (pretraitement " << secondesPretraitement
+         << " s, " << routage.getNbTransferts() << " transferts, " << differences << " differences)" << endl;
+
+    // Trafic concentré: les mêmes paires populaires reviennent, comme aux bornes et dans l'application
+    CacheTrajets cache(planificateur, donnees_rtc);
+    uniform_int_distribution<size_t> tiragePopulaire(0, min<size_t>(requetes.size(), 500) - 1);
+    debut = Horloge::now();
+    for (size_t i = 0; i < nbRequetes; ++i)
+    {
+        cache.calculerTrajet(requetes[tiragePopulaire(generateur)]);
+    }
+    double secondesCache = chrono::duration<double>(Horloge::now() - debut).count();
+    CacheTrajets::Metriques metriques = cache.getMetriques();
+    cout << "Avec cache    : " << nbRequetes / secondesCache << " requetes/s (taux de succes "
+         << metriques.tauxSucces() << ", " << metriques.nbEntrees << " entrees, " << metriques.memoireOctets
+         << " octets)" << endl;
+
+    if (differences != 0)
+    {
+        cerr << "Trip-Based: " << differences << " resultats differents du Planificateur" << endl;
+        return 1;
+    }
+    return trouvesBoucle == trouvesLot ? 0 : 1;
+}
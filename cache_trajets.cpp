@@ -0,0 +1,158 @@
+//
+// Cache LRU concurrent des résultats du planificateur de trajets
+//
+
+#include "cache_trajets.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+double CacheTrajets::Metriques::tauxSucces() const
+{
+    uint64_t total = succes + echecs;
+    return total ? (double) succes / (double) total : 0.0;
+}
+
+bool CacheTrajets::Cle::operator==(const Cle &p_autre) const
+{
+    return origine == p_autre.origine && destination == p_autre.destination && intervalle == p_autre.intervalle &&
+           profil == p_autre.profil;
+}
+
+size_t CacheTrajets::HachageCle::operator()(const Cle &p_cle) const
+{
+    uint64_t h = p_cle.origine;
+    h = h * 0x9E3779B97F4A7C15ULL + p_cle.destination;
+    h = h * 0x9E3779B97F4A7C15ULL + p_cle.intervalle;
+    h = h * 0x9E3779B97F4A7C15ULL + p_cle.profil;
+    return (size_t) (h ^ (h >> 29));
+}
+
+/*!
+ * \brief Constructeur du cache
+ * \param[in] p_planificateur: le planificateur interrogé en cas d'échec
+ * \param[in] p_donnees: les données dont la version est surveillée pour l'invalidation
+ * \param[in] p_intervalleSecondes: la largeur des intervalles d'arrondi de l'heure de départ
+ * \param[in] p_capacite: le nombre maximal d'entrées, réparti également entre les fragments
+ * \param[in] p_nbFragments: le nombre de fragments (verrous indépendants)
+ */
+CacheTrajets::CacheTrajets(const Planificateur &p_planificateur, const DonneesGTFS &p_donnees,
+                           unsigned int p_intervalleSecondes, size_t p_capacite, unsigned int p_nbFragments)
+        : m_planificateur(p_planificateur), m_donnees(p_donnees),
+          m_intervalle(p_intervalleSecondes ? p_intervalleSecondes : 1),
+          m_capaciteParFragment(max<size_t>(1, p_capacite / (p_nbFragments ? p_nbFragments : 1))),
+          m_fragments(p_nbFragments ? p_nbFragments : 1),
+          m_version(p_donnees.getVersion()), m_generation(0), m_succes(0), m_echecs(0), m_evictions(0),
+          m_invalidations(0)
+{
+}
+
+/*!
+ * \brief retourne le résultat de p_requete, calculé par le planificateur s'il est absent du cache
+ * \param[in] p_requete: la requête origine-destination
+ * \return le résultat calculé pour la fin de l'intervalle contenant p_requete.depart
+ * \throws logic_error si le planificateur n'a pas été construit à partir de la version courante des données
+ */
+ResultatOD CacheTrajets::calculerTrajet(const RequeteOD &p_requete)
+{
+    const unsigned long generation = verifierVersion();
+
+    const unsigned int depart = (unsigned int) (p_requete.depart - Heure(0, 0, 0));
+    Cle cle = {p_requete.origine, p_requete.destination, depart / m_intervalle, p_requete.profil};
+    Fragment &f = fragment(cle);
+
+    {
+        lock_guard<mutex> verrou(f.m_verrou);
+        auto it = f.m_index.find(cle);
+        if (it != f.m_index.end())
+        {
+            f.m_lru.splice(f.m_lru.begin(), f.m_lru, it->second);
+            ++m_succes;
+            return it->second->second;
+        }
+    }
+
+    ++m_echecs;
+    RequeteOD arrondie = p_requete;
+    arrondie.depart = Heure(0, 0, 0).add_secondes((cle.intervalle + 1) * m_intervalle - 1);
+    ResultatOD resultat = m_planificateur.calculerTrajet(arrondie);
+
+    // Un vidage pendant le calcul a changé la génération: le résultat ne doit pas survivre au vidage
+    lock_guard<mutex> verrou(f.m_verrou);
+    if (generation == m_generation && f.m_index.find(cle) == f.m_index.end())
+    {
+        f.m_lru.push_front(make_pair(cle, resultat));
+        f.m_index.insert({cle, f.m_lru.begin()});
+        if (f.m_lru.size() > m_capaciteParFragment)
+        {
+            f.m_index.erase(f.m_lru.back().first);
+            f.m_lru.pop_back();
+            ++m_evictions;
+        }
+    }
+    return resultat;
+}
+
+//! \brief retourne un instantané des compteurs et de l'occupation du cache
+CacheTrajets::Metriques CacheTrajets::getMetriques() const
+{
+    Metriques m;
+    m.succes = m_succes;
+    m.echecs = m_echecs;
+    m.evictions = m_evictions;
+    m.invalidations = m_invalidations;
+    m.nbEntrees = 0;
+    m.memoireOctets = sizeof(CacheTrajets) + m_fragments.size() * sizeof(Fragment);
+    for (const Fragment &f : m_fragments)
+    {
+        lock_guard<mutex> verrou(f.m_verrou);
+        m.nbEntrees += f.m_lru.size();
+        // noeud de liste (deux pointeurs + valeur), noeud de table de hachage et alvéoles
+        m.memoireOctets += f.m_lru.size() * (2 * sizeof(void *) + sizeof(ListeLRU::value_type))
+                           + f.m_index.size() * (sizeof(void *) + sizeof(size_t) + sizeof(Cle) + sizeof(void *))
+                           + f.m_index.bucket_count() * sizeof(void *);
+    }
+    return m;
+}
+
+//! \brief retire toutes les entrées du cache; les calculs en cours ne seront pas insérés
+void CacheTrajets::vider()
+{
+    ++m_generation;
+    for (Fragment &f : m_fragments)
+    {
+        lock_guard<mutex> verrou(f.m_verrou);
+        f.m_index.clear();
+        f.m_lru.clear();
+    }
+}
+
+/*!
+ * \brief vide le cache si les données GTFS ont été modifiées depuis la dernière requête
+ * \return la génération courante, à comparer au moment d'insérer un résultat
+ * \throws logic_error si le planificateur n'a pas été construit à partir de la version courante des données
+ */
+unsigned long CacheTrajets::verifierVersion()
+{
+    const unsigned long version = m_donnees.getVersion();
+    if (version != m_planificateur.getVersionDonnees())
+        throw logic_error("Les données GTFS ont changé depuis la construction du planificateur; "
+                          "il doit être reconstruit.");
+    if (version == m_version) return m_generation;
+
+    lock_guard<mutex> verrou(m_verrouVersion);
+    if (version != m_version)
+    {
+        vider();
+        m_version = version;
+        ++m_invalidations;
+    }
+    return m_generation;
+}
+
+CacheTrajets::Fragment &CacheTrajets::fragment(const Cle &p_cle)
+{
+    return m_fragments[HachageCle()(p_cle) % m_fragments.size()];
+}
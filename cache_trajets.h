@@ -0,0 +1,100 @@
+//
+// Cache LRU concurrent des résultats du planificateur de trajets
+//
+
+#ifndef RTC_CACHE_TRAJETS_H
+#define RTC_CACHE_TRAJETS_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "DonneesGTFS.h"
+#include "planificateur.h"
+
+/*!
+ * \class CacheTrajets
+ * \brief Cache LRU fragmenté placé devant un Planificateur.
+ *
+ * La clé est (origine, destination, heure de départ arrondie à un intervalle, profil). Toutes les requêtes
+ * d'un même intervalle partagent le résultat calculé pour la fin de l'intervalle, qui est réalisable pour
+ * chacune d'elles. Chaque fragment a son propre verrou et sa propre liste LRU; le calcul d'un résultat
+ * absent se fait hors verrou.
+ *
+ * Le cache est vidé automatiquement dès que DonneesGTFS::getVersion() change, c'est-à-dire dès que les
+ * stations, voyages, arrêts ou transferts chargés sont modifiés. Un planificateur construit à partir d'une autre
+ * version des données doit alors être reconstruit: les requêtes sont refusées d'ici là. Chaque vidage change de
+ * génération; un résultat calculé pendant une génération précédente n'est pas inséré.
+ */
+class CacheTrajets
+{
+
+public:
+    /*!
+     * \struct Metriques
+     * \brief Compteurs d'utilisation du cache
+     */
+    struct Metriques
+    {
+        std::uint64_t succes;
+        std::uint64_t echecs;
+        std::uint64_t evictions;
+        std::uint64_t invalidations;
+        std::size_t nbEntrees;
+        std::size_t memoireOctets; //estimation de la mémoire occupée par les entrées
+        double tauxSucces() const;
+    };
+
+    CacheTrajets(const Planificateur &p_planificateur, const DonneesGTFS &p_donnees,
+                 unsigned int p_intervalleSecondes = 60, std::size_t p_capacite = 65536,
+                 unsigned int p_nbFragments = 16);
+
+    ResultatOD calculerTrajet(const RequeteOD &p_requete);
+    Metriques getMetriques() const;
+    void vider();
+
+private:
+    struct Cle
+    {
+        unsigned int origine;
+        unsigned int destination;
+        unsigned int intervalle;
+        unsigned int profil;
+        bool operator==(const Cle &p_autre) const;
+    };
+
+    struct HachageCle
+    {
+        std::size_t operator()(const Cle &p_cle) const;
+    };
+
+    typedef std::list<std::pair<Cle, ResultatOD> > ListeLRU;
+
+    struct Fragment
+    {
+        mutable std::mutex m_verrou;
+        ListeLRU m_lru; //la plus récemment utilisée en tête
+        std::unordered_map<Cle, ListeLRU::iterator, HachageCle> m_index;
+    };
+
+    unsigned long verifierVersion();
+    Fragment &fragment(const Cle &p_cle);
+
+    const Planificateur &m_planificateur;
+    const DonneesGTFS &m_donnees;
+    unsigned int m_intervalle;
+    std::size_t m_capaciteParFragment;
+    std::vector<Fragment> m_fragments;
+
+    std::mutex m_verrouVersion;
+    std::atomic<unsigned long> m_version;
+    std::atomic<unsigned long> m_generation; //incrémentée par chaque vidage
+    std::atomic<std::uint64_t> m_succes;
+    std::atomic<std::uint64_t> m_echecs;
+    std::atomic<std::uint64_t> m_evictions;
+    std::atomic<std::uint64_t> m_invalidations;
+};
+
+#endif //RTC_CACHE_TRAJETS_H
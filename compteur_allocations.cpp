@@ -0,0 +1,19 @@
+//
+// Compteur d'allocations du banc d'essai: remplace l'allocateur global du programme qui lie ce fichier
+//
+
+#include <cstdlib>
+#include <new>
+#include "instrumentation.h"
+
+void *operator new(std::size_t p_taille)
+{
+    StatistiquesChargement::compterAllocation();
+    if (void *p = std::malloc(p_taille ? p_taille : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p_ptr) noexcept
+{
+    std::free(p_ptr);
+}
@@ -2,50 +2,67 @@
 // Created by prtos on 29/04/16.
 //
 
+#include <algorithm>
+#include <type_traits>
 #include "coordonnees.h"
 
+static_assert(sizeof(Coordonnees) == 8 && std::is_trivially_copyable<Coordonnees>::value,
+              "Coordonnees doit se copier comme deux entiers");
+
+namespace
+{
+    const double MICRODEGRES_PAR_DEGRE = 1e6;
+}
+
 /*!
  * \brief Constructeur de la classe, permet de construire une coordonnéees à partir de la longitude et de la latitude.
+ * Les degrés sont arrondis au micro-degré près.
  * \exception logic_error si La latitude et/ou la longitude est invalide
  */
-Coordonnees::Coordonnees(double latitude, double longitude) : m_latitude(latitude), m_longitude(longitude)
+Coordonnees::Coordonnees(double latitude, double longitude)
 {
     if (!Coordonnees::is_valide_coord(latitude, longitude))
     {
         throw std::logic_error("La latitude ou la longitude est invalide");
     }
-
+    m_latitude = (std::int32_t) std::lround(latitude * MICRODEGRES_PAR_DEGRE);
+    m_longitude = (std::int32_t) std::lround(longitude * MICRODEGRES_PAR_DEGRE);
 };
 
 /*!
- * \brief Constructeur de copie de la classe, permet de construire une coordonnéees à partir d'une autre coordonnée.
- * \exception logic_error si La latitude et/ou la longitude de cette coordonnée est invalide
+ * \brief Construit une coordonnée directement à partir de micro-degrés, sans la valider.
+ * Réservé aux valeurs qui proviennent déjà d'une Coordonnees (ex.: relues d'un fichier écrit par le programme).
+ * \param[in] p_latitude: la latitude, en micro-degrés
+ * \param[in] p_longitude: la longitude, en micro-degrés
  */
-Coordonnees::Coordonnees(const Coordonnees & rhs)
+Coordonnees Coordonnees::depuisMicrodegres(std::int32_t p_latitude, std::int32_t p_longitude)
 {
-    if (this != &rhs)
-    {
-        double longitude = rhs.getLongitude();
-        double latitude = rhs.getLatitude();
-        if (!Coordonnees::is_valide_coord(latitude, longitude))
-        {
-            throw std::logic_error("Coordonnees::Coordonnees(): rhs est une coordonnée invalide");
-        }
-        m_longitude = rhs.getLongitude();
-        m_latitude = rhs.getLatitude();
-    }
+    Coordonnees coord;
+    coord.m_latitude = p_latitude;
+    coord.m_longitude = p_longitude;
+    return coord;
 }
 
 double Coordonnees::getLatitude() const
 {
-    return m_latitude;
+    return m_latitude / MICRODEGRES_PAR_DEGRE;
 };
 
 double Coordonnees::getLongitude() const
 {
-    return m_longitude;
+    return m_longitude / MICRODEGRES_PAR_DEGRE;
 };
 
+std::int32_t Coordonnees::getLatitudeMicrodegres() const
+{
+    return m_latitude;
+}
+
+std::int32_t Coordonnees::getLongitudeMicrodegres() const
+{
+    return m_longitude;
+}
+
 /*!
  * \brief : Cette fonction vérifie si les longitude et latitude en argument représentent
  * une coordonnée gps valide. Voir https://en.wikipedia.org/wiki/Geographic_coordinate_system
@@ -70,11 +87,13 @@ double Coordonnees::operator-(const Coordonnees &other) const
 {
     double radParDegre = 3.14159265358979323846 / 180.0;
     double rayonTerre = 6371; //en km
-    double lon1 = m_longitude * radParDegre;
-    double lat1 = m_latitude * radParDegre;
-    double lon2 = other.m_longitude * radParDegre;
-    double lat2 = other.m_latitude * radParDegre;
-    double res = rayonTerre * acos(cos(lat1) * cos(lat2) * cos(lon2 - lon1) + sin(lat1) * sin(lat2));
+    double lon1 = getLongitude() * radParDegre;
+    double lat1 = getLatitude() * radParDegre;
+    double lon2 = other.getLongitude() * radParDegre;
+    double lat2 = other.getLatitude() * radParDegre;
+    double cosAngle = cos(lat1) * cos(lat2) * cos(lon2 - lon1) + sin(lat1) * sin(lat2);
+    cosAngle = std::max(-1.0, std::min(1.0, cosAngle)); //les arrondis peuvent dépasser 1 pour deux points confondus
+    double res = rayonTerre * acos(cosAngle);
     return res;
 };
 
@@ -87,9 +106,9 @@ double Coordonnees::operator-(const Coordonnees &other) const
 std::ostream &operator<<(std::ostream &flux, const Coordonnees &p_coord)
 {
     flux << "(lat:";
-    flux << p_coord.m_latitude;
+    flux << p_coord.getLatitude();
     flux << ", long:";
-    flux << p_coord.m_longitude;
+    flux << p_coord.getLongitude();
     flux << ")";
     return flux;
 }
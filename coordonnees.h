@@ -7,6 +7,7 @@
 #define RTC_COORDONNEES_H
 
 #include <cmath>
+#include <cstdint>
 #include <exception>
 #include <stdexcept>
 #include <iostream>
@@ -15,22 +16,28 @@
 /*!
  * \class Coordonnees
  * \brief Cette classe permet de représenter les coordonnées GPS d'un endroit
+ * Latitude et longitude sont gardées en micro-degrés (entiers de 32 bits, soit une précision d'environ 11 cm): une
+ * coordonnée tient en 8 octets, elle est validée une seule fois à sa construction et se copie sans vérification.
  */
 class Coordonnees {
 
 public:
 
     Coordonnees(double latitude, double longitude);
-    Coordonnees(const Coordonnees & rhs);
+    static Coordonnees depuisMicrodegres(std::int32_t p_latitude, std::int32_t p_longitude);
     double getLatitude() const ;
     double getLongitude() const ;
+    std::int32_t getLatitudeMicrodegres() const ;
+    std::int32_t getLongitudeMicrodegres() const ;
     static bool is_valide_coord(double p_latitude, double p_longitude) ;
     double operator- (const Coordonnees & other) const;
     friend std::ostream & operator<<(std::ostream & flux, const Coordonnees & p_coord);
 
 private:
-    double m_latitude;
-    double m_longitude;
+    Coordonnees() = default;
+
+    std::int32_t m_latitude;  //micro-degrés
+    std::int32_t m_longitude; //micro-degrés
 };
 
 
@@ -0,0 +1,62 @@
+//
+// Erreurs de conversion relevées pendant le chargement des fichiers GTFS
+//
+
+#include <stdexcept>
+#include "diagnostics_chargement.h"
+
+using namespace std;
+
+//! \return le diagnostic au format "fichier:ligne: colonne: raison (valeur)"
+std::string DiagnosticChamp::texte() const
+{
+    return fichier + ":" + to_string(ligne) + ": " + colonne + ": " + raison + " (" + valeur + ")";
+}
+
+DiagnosticsChargement::DiagnosticsChargement(PolitiqueErreurs p_politique) : m_politique(p_politique)
+{
+}
+
+void DiagnosticsChargement::setPolitique(PolitiqueErreurs p_politique)
+{
+    lock_guard<mutex> verrou(m_verrou);
+    m_politique = p_politique;
+}
+
+PolitiqueErreurs DiagnosticsChargement::getPolitique() const
+{
+    lock_guard<mutex> verrou(m_verrou);
+    return m_politique;
+}
+
+/*!
+ * \brief Note un champ invalide
+ * \param[in] p_diagnostic: le champ en cause
+ * \throws logic_error avec le texte du diagnostic si la politique est PolitiqueErreurs::ECHOUER
+ */
+void DiagnosticsChargement::signaler(const DiagnosticChamp &p_diagnostic)
+{
+    lock_guard<mutex> verrou(m_verrou);
+    m_diagnostics.push_back(p_diagnostic);
+    if (m_politique == PolitiqueErreurs::ECHOUER)
+        throw logic_error("Champ invalide: " + p_diagnostic.texte());
+}
+
+//! \return une copie des diagnostics, dans l'ordre où ils ont été signalés
+std::vector<DiagnosticChamp> DiagnosticsChargement::getDiagnostics() const
+{
+    lock_guard<mutex> verrou(m_verrou);
+    return m_diagnostics;
+}
+
+std::size_t DiagnosticsChargement::getNbDiagnostics() const
+{
+    lock_guard<mutex> verrou(m_verrou);
+    return m_diagnostics.size();
+}
+
+void DiagnosticsChargement::vider()
+{
+    lock_guard<mutex> verrou(m_verrou);
+    m_diagnostics.clear();
+}
@@ -0,0 +1,68 @@
+//
+// Erreurs de conversion relevées pendant le chargement des fichiers GTFS
+//
+
+#ifndef RTC_DIAGNOSTICS_CHARGEMENT_H
+#define RTC_DIAGNOSTICS_CHARGEMENT_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*!
+ * \enum PolitiqueErreurs
+ * \brief Ce que fait le chargement d'une rangée dont un champ ne se convertit pas
+ */
+enum class PolitiqueErreurs
+{
+    ECHOUER,  //le diagnostic est noté, puis le chargement s'arrête par une logic_error
+    SAUTER    //le diagnostic est noté et la rangée est ignorée
+};
+
+/*!
+ * \struct DiagnosticChamp
+ * \brief Un champ qui n'a pas pu être converti: où il se trouve, pourquoi, et son texte
+ */
+struct DiagnosticChamp
+{
+    std::string fichier;
+    unsigned long long ligne;  //numéro de ligne dans le fichier lu; l'en-tête est la ligne 1
+    std::string colonne;
+    std::string raison;
+    std::string valeur;
+
+    std::string texte() const;
+};
+
+/*!
+ * \class DiagnosticsChargement
+ * \brief Tampon des erreurs de conversion d'un chargement, partagé par les fils qui lisent les fichiers.
+ *
+ * Les conversions ne lèvent plus d'exception: LecteurTable signale chaque champ invalide ici, et la politique décide
+ * si la rangée est sautée ou si le chargement échoue.
+ */
+class DiagnosticsChargement
+{
+
+public:
+    explicit DiagnosticsChargement(PolitiqueErreurs p_politique = PolitiqueErreurs::ECHOUER);
+
+    void setPolitique(PolitiqueErreurs p_politique);
+    PolitiqueErreurs getPolitique() const;
+
+    void signaler(const DiagnosticChamp &p_diagnostic);
+    std::vector<DiagnosticChamp> getDiagnostics() const;
+    std::size_t getNbDiagnostics() const;
+    void vider();
+
+private:
+    DiagnosticsChargement(const DiagnosticsChargement &);
+    DiagnosticsChargement &operator=(const DiagnosticsChargement &);
+
+    mutable std::mutex m_verrou;
+    PolitiqueErreurs m_politique;
+    std::vector<DiagnosticChamp> m_diagnostics;
+};
+
+#endif //RTC_DIAGNOSTICS_CHARGEMENT_H
@@ -0,0 +1,501 @@
+//
+// Export en colonnes (format de flux IPC d'Apache Arrow) du réseau chargé dans DonneesGTFS
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "export_arrow.h"
+
+using namespace std;
+
+namespace
+{
+    // Constantes des schémas Schema.fbs et Message.fbs d'Arrow
+    const int16_t VERSION_METADONNEES_V5 = 4;
+    const uint8_t ENTETE_SCHEMA = 1;
+    const uint8_t ENTETE_LOT = 3;
+    const uint8_t TYPE_ENTIER = 2;
+    const uint8_t TYPE_REEL = 3;
+    const uint8_t TYPE_UTF8 = 5;
+    const int16_t PRECISION_DOUBLE = 2;
+
+    /*!
+     * \brief Construit un tampon FlatBuffers d'avant en arrière: chaque table est écrite avant ses enfants, et les
+     * références (toujours vers l'avant) sont liées une fois les enfants écrits. Suppose un hôte petit-boutiste.
+     */
+    class ConstructeurFlatbuffer
+    {
+    public:
+        ConstructeurFlatbuffer() : m_octets(4, 0) //la référence à la table racine
+        {
+        }
+
+        void debutTable()
+        {
+            m_champs.clear();
+        }
+
+        template<typename T>
+        void scalaire(uint16_t p_id, T p_valeur)
+        {
+            Champ champ = {p_id, sizeof(T), false, {0}};
+            memcpy(champ.valeur, &p_valeur, sizeof(T));
+            m_champs.push_back(champ);
+        }
+
+        void reference(uint16_t p_id)
+        {
+            Champ champ = {p_id, 4, true, {0}};
+            m_champs.push_back(champ);
+        }
+
+        //! \brief écrit la vtable puis la table commencée par debutTable
+        //! \return la position de la table; positionChamp() donne ensuite celle de chacun de ses champs
+        size_t finTable()
+        {
+            uint16_t nbIds = 0;
+            for (const Champ &c : m_champs) nbIds = max<uint16_t>(nbIds, (uint16_t) (c.id + 1));
+
+            // Disposition: décalage vers la vtable, puis les champs du plus grand au plus petit, chacun aligné
+            vector<Champ> tries(m_champs);
+            stable_sort(tries.begin(), tries.end(), [](const Champ &a, const Champ &b) { return a.taille > b.taille; });
+            vector<uint16_t> decalages(nbIds, 0);
+            size_t taille = 4;
+            for (const Champ &c : tries)
+            {
+                taille = (taille + c.taille - 1) / c.taille * c.taille;
+                decalages[c.id] = (uint16_t) taille;
+                taille += c.taille;
+            }
+
+            aligner(2);
+            const size_t vtable = m_octets.size();
+            ajouter<uint16_t>((uint16_t) (4 + 2 * nbIds));
+            ajouter<uint16_t>((uint16_t) taille);
+            for (uint16_t d : decalages) ajouter<uint16_t>(d);
+
+            aligner(8);
+            const size_t table = m_octets.size();
+            m_octets.resize(table + taille, 0);
+            poser<int32_t>(table, (int32_t) (table - vtable));
+            m_positions.assign(nbIds, 0);
+            for (const Champ &c : m_champs)
+            {
+                m_positions[c.id] = table + decalages[c.id];
+                if (!c.reference) memcpy(&m_octets[m_positions[c.id]], c.valeur, c.taille);
+            }
+            return table;
+        }
+
+        size_t positionChamp(uint16_t p_id) const
+        {
+            return m_positions[p_id];
+        }
+
+        //! \return la position du premier élément; l'élément i se trouve à cette position + 4 * i
+        size_t vecteurReferences(size_t p_nb)
+        {
+            aligner(4);
+            ajouter<uint32_t>((uint32_t) p_nb);
+            const size_t elements = m_octets.size();
+            m_octets.resize(elements + 4 * p_nb, 0);
+            return elements;
+        }
+
+        //! \return la position du vecteur (sa longueur), dont les éléments sont alignés sur 8 octets
+        size_t vecteurStructs(const vector<int64_t> &p_valeurs, size_t p_valeursParStruct)
+        {
+            while ((m_octets.size() + 4) % 8) m_octets.push_back(0);
+            const size_t vecteur = m_octets.size();
+            ajouter<uint32_t>((uint32_t) (p_valeurs.size() / p_valeursParStruct));
+            for (int64_t v : p_valeurs) ajouter<int64_t>(v);
+            return vecteur;
+        }
+
+        size_t chaine(const string &p_texte)
+        {
+            aligner(4);
+            const size_t position = m_octets.size();
+            ajouter<uint32_t>((uint32_t) p_texte.size());
+            m_octets.insert(m_octets.end(), p_texte.begin(), p_texte.end());
+            m_octets.push_back(0);
+            return position;
+        }
+
+        void lier(size_t p_reference, size_t p_cible)
+        {
+            poser<uint32_t>(p_reference, (uint32_t) (p_cible - p_reference));
+        }
+
+        void racine(size_t p_table)
+        {
+            lier(0, p_table);
+        }
+
+        const vector<char> &getOctets() const
+        {
+            return m_octets;
+        }
+
+    private:
+        struct Champ
+        {
+            uint16_t id;
+            size_t taille;
+            bool reference;
+            char valeur[8];
+        };
+
+        void aligner(size_t p_alignement)
+        {
+            while (m_octets.size() % p_alignement) m_octets.push_back(0);
+        }
+
+        template<typename T>
+        void ajouter(T p_valeur)
+        {
+            const size_t position = m_octets.size();
+            m_octets.resize(position + sizeof(T));
+            memcpy(&m_octets[position], &p_valeur, sizeof(T));
+        }
+
+        template<typename T>
+        void poser(size_t p_position, T p_valeur)
+        {
+            memcpy(&m_octets[p_position], &p_valeur, sizeof(T));
+        }
+
+        vector<char> m_octets;
+        vector<Champ> m_champs;
+        vector<size_t> m_positions;
+    };
+
+    enum class TypeColonne
+    {
+        ENTIER, //uint32
+        REEL,   //double
+        TEXTE   //utf8
+    };
+
+    struct ColonneArrow
+    {
+        const char *nom;
+        TypeColonne type;
+        vector<char> donnees;
+        vector<int32_t> decalages; //TEXTE seulement: début de chaque valeur dans donnees, plus la fin
+    };
+
+    /*!
+     * \brief Écrit une table en flux IPC d'Arrow: le schéma à l'ouverture, puis un lot de colonnes chaque fois que
+     * p_tailleLot rangées sont accumulées, et la marque de fin dans terminer().
+     */
+    class FluxArrow
+    {
+    public:
+        FluxArrow(const string &p_fichier, const vector<pair<const char *, TypeColonne> > &p_colonnes,
+                  size_t p_tailleLot)
+                : m_fichier(p_fichier, ios::binary), m_tailleLot(max<size_t>(1, p_tailleLot)), m_nbRangees(0)
+        {
+            if (!m_fichier) throw logic_error("Impossible de créer le fichier " + p_fichier + ".");
+            for (const auto &c : p_colonnes)
+            {
+                ColonneArrow colonne = {c.first, c.second, vector<char>(), vector<int32_t>()};
+                if (c.second == TypeColonne::TEXTE) colonne.decalages.push_back(0);
+                m_colonnes.push_back(colonne);
+            }
+            ecrireSchema();
+        }
+
+        void entier(size_t p_colonne, uint32_t p_valeur)
+        {
+            ajouter(m_colonnes[p_colonne].donnees, &p_valeur, sizeof(p_valeur));
+        }
+
+        void reel(size_t p_colonne, double p_valeur)
+        {
+            ajouter(m_colonnes[p_colonne].donnees, &p_valeur, sizeof(p_valeur));
+        }
+
+        void texte(size_t p_colonne, const string &p_valeur)
+        {
+            ColonneArrow &colonne = m_colonnes[p_colonne];
+            colonne.donnees.insert(colonne.donnees.end(), p_valeur.begin(), p_valeur.end());
+            colonne.decalages.push_back((int32_t) colonne.donnees.size());
+        }
+
+        void finRangee()
+        {
+            if (++m_nbRangees == m_tailleLot) ecrireLot();
+        }
+
+        //! \throws logic_error si une écriture a échoué
+        void terminer()
+        {
+            if (m_nbRangees > 0) ecrireLot();
+            const uint32_t fin[2] = {0xFFFFFFFFu, 0};
+            m_fichier.write(reinterpret_cast<const char *>(fin), sizeof(fin));
+            m_fichier.flush();
+            if (!m_fichier) throw logic_error("Une erreur est survenue lors de l'écriture de l'export.");
+        }
+
+    private:
+        static void ajouter(vector<char> &p_octets, const void *p_valeur, size_t p_taille)
+        {
+            const char *octets = static_cast<const char *>(p_valeur);
+            p_octets.insert(p_octets.end(), octets, octets + p_taille);
+        }
+
+        static size_t arrondir8(size_t p_taille)
+        {
+            return (p_taille + 7) / 8 * 8;
+        }
+
+        //! \brief écrit un message encapsulé: marque de continuation, taille des métadonnées, métadonnées alignées
+        void ecrireMessage(const ConstructeurFlatbuffer &p_message)
+        {
+            const vector<char> &octets = p_message.getOctets();
+            const uint32_t continuation = 0xFFFFFFFFu;
+            const int32_t taille = (int32_t) arrondir8(octets.size());
+            m_fichier.write(reinterpret_cast<const char *>(&continuation), 4);
+            m_fichier.write(reinterpret_cast<const char *>(&taille), 4);
+            m_fichier.write(&octets[0], (streamsize) octets.size());
+            ecrireZeros((size_t) taille - octets.size());
+        }
+
+        void ecrireZeros(size_t p_nb)
+        {
+            static const char zeros[8] = {0};
+            m_fichier.write(zeros, (streamsize) p_nb);
+        }
+
+        void ecrireSchema()
+        {
+            ConstructeurFlatbuffer b;
+            b.debutTable();
+            b.scalaire<int16_t>(0, VERSION_METADONNEES_V5);
+            b.scalaire<uint8_t>(1, ENTETE_SCHEMA);
+            b.reference(2);
+            b.scalaire<int64_t>(3, 0);
+            const size_t message = b.finTable();
+            b.racine(message);
+            const size_t refEntete = b.positionChamp(2);
+
+            b.debutTable();
+            b.scalaire<int16_t>(0, 0); //petit-boutiste
+            b.reference(1);
+            b.lier(refEntete, b.finTable());
+            const size_t refChamps = b.positionChamp(1);
+
+            const size_t champs = b.vecteurReferences(m_colonnes.size());
+            b.lier(refChamps, champs - 4);
+            for (size_t i = 0; i < m_colonnes.size(); ++i)
+            {
+                const ColonneArrow &colonne = m_colonnes[i];
+                const uint8_t type = colonne.type == TypeColonne::ENTIER ? TYPE_ENTIER
+                                   : colonne.type == TypeColonne::REEL ? TYPE_REEL : TYPE_UTF8;
+                b.debutTable();
+                b.reference(0);
+                b.scalaire<uint8_t>(1, 0); //non nullable
+                b.scalaire<uint8_t>(2, type);
+                b.reference(3);
+                b.reference(5);
+                b.lier(champs + 4 * i, b.finTable());
+                const size_t refNom = b.positionChamp(0);
+                const size_t refType = b.positionChamp(3);
+                const size_t refEnfants = b.positionChamp(5);
+
+                b.lier(refNom, b.chaine(colonne.nom));
+                b.debutTable();
+                if (colonne.type == TypeColonne::ENTIER)
+                {
+                    b.scalaire<int32_t>(0, 32);
+                    b.scalaire<uint8_t>(1, 0); //non signé
+                } else if (colonne.type == TypeColonne::REEL)
+                {
+                    b.scalaire<int16_t>(0, PRECISION_DOUBLE);
+                }
+                b.lier(refType, b.finTable());
+                b.lier(refEnfants, b.vecteurReferences(0) - 4);
+            }
+            ecrireMessage(b);
+        }
+
+        void ecrireLot()
+        {
+            // Tampons de chaque colonne, dans l'ordre: validité (vide, aucune valeur nulle), [décalages,] données
+            vector<int64_t> noeuds;
+            vector<int64_t> tampons;
+            int64_t position = 0;
+            for (const ColonneArrow &colonne : m_colonnes)
+            {
+                noeuds.push_back((int64_t) m_nbRangees);
+                noeuds.push_back(0);
+                tampons.push_back(position);
+                tampons.push_back(0);
+                if (colonne.type == TypeColonne::TEXTE)
+                {
+                    const size_t taille = colonne.decalages.size() * sizeof(int32_t);
+                    tampons.push_back(position);
+                    tampons.push_back((int64_t) taille);
+                    position += (int64_t) arrondir8(taille);
+                }
+                tampons.push_back(position);
+                tampons.push_back((int64_t) colonne.donnees.size());
+                position += (int64_t) arrondir8(colonne.donnees.size());
+            }
+
+            ConstructeurFlatbuffer b;
+            b.debutTable();
+            b.scalaire<int16_t>(0, VERSION_METADONNEES_V5);
+            b.scalaire<uint8_t>(1, ENTETE_LOT);
+            b.reference(2);
+            b.scalaire<int64_t>(3, position);
+            b.racine(b.finTable());
+            const size_t refEntete = b.positionChamp(2);
+
+            b.debutTable();
+            b.scalaire<int64_t>(0, (int64_t) m_nbRangees);
+            b.reference(1);
+            b.reference(2);
+            b.lier(refEntete, b.finTable());
+            const size_t refNoeuds = b.positionChamp(1);
+            const size_t refTampons = b.positionChamp(2);
+            b.lier(refNoeuds, b.vecteurStructs(noeuds, 2));
+            b.lier(refTampons, b.vecteurStructs(tampons, 2));
+            ecrireMessage(b);
+
+            for (ColonneArrow &colonne : m_colonnes)
+            {
+                if (colonne.type == TypeColonne::TEXTE)
+                {
+                    const size_t taille = colonne.decalages.size() * sizeof(int32_t);
+                    m_fichier.write(reinterpret_cast<const char *>(&colonne.decalages[0]), (streamsize) taille);
+                    ecrireZeros(arrondir8(taille) - taille);
+                    colonne.decalages.assign(1, 0);
+                }
+                if (!colonne.donnees.empty()) m_fichier.write(&colonne.donnees[0], (streamsize) colonne.donnees.size());
+                ecrireZeros(arrondir8(colonne.donnees.size()) - colonne.donnees.size());
+                colonne.donnees.clear();
+            }
+            m_nbRangees = 0;
+            if (!m_fichier) throw logic_error("Une erreur est survenue lors de l'écriture de l'export.");
+        }
+
+        ofstream m_fichier;
+        size_t m_tailleLot;
+        size_t m_nbRangees; //rangées du lot en cours
+        vector<ColonneArrow> m_colonnes;
+    };
+
+    uint32_t secondes(const Heure &p_heure)
+    {
+        return p_heure.getSecondesDepuisMinuit();
+    }
+}
+
+//! \brief exporte toutes les tables dans p_dossier, qui doit exister
+//! \param[in] p_tailleLot: le nombre de rangées par lot de colonnes
+//! \throws logic_error si un fichier ne peut être créé ou écrit
+void ExportateurArrow::exporter(const DonneesGTFS &p_donnees, const std::string &p_dossier, std::size_t p_tailleLot)
+{
+    exporterStations(p_donnees, p_dossier + "/stations.arrows", p_tailleLot);
+    exporterLignes(p_donnees, p_dossier + "/lignes.arrows", p_tailleLot);
+    exporterVoyages(p_donnees, p_dossier + "/voyages.arrows", p_tailleLot);
+    exporterArrets(p_donnees, p_dossier + "/arrets.arrows", p_tailleLot);
+    exporterTransferts(p_donnees, p_dossier + "/transferts.arrows", p_tailleLot);
+}
+
+void ExportateurArrow::exporterStations(const DonneesGTFS &p_donnees, const std::string &p_fichier,
+                                        std::size_t p_tailleLot)
+{
+    FluxArrow flux(p_fichier, {{"station_id", TypeColonne::ENTIER}, {"nom", TypeColonne::TEXTE},
+                               {"description", TypeColonne::TEXTE}, {"latitude", TypeColonne::REEL},
+                               {"longitude", TypeColonne::REEL}}, p_tailleLot);
+    for (const auto &stationM : p_donnees.getStations())
+    {
+        const Station &station = stationM.second;
+        flux.entier(0, station.getId());
+        flux.texte(1, station.getNom());
+        flux.texte(2, station.getDescription());
+        flux.reel(3, station.getCoords().getLatitude());
+        flux.reel(4, station.getCoords().getLongitude());
+        flux.finRangee();
+    }
+    flux.terminer();
+}
+
+void ExportateurArrow::exporterLignes(const DonneesGTFS &p_donnees, const std::string &p_fichier,
+                                      std::size_t p_tailleLot)
+{
+    FluxArrow flux(p_fichier, {{"ligne_id", TypeColonne::ENTIER}, {"numero", TypeColonne::TEXTE},
+                               {"description", TypeColonne::TEXTE}, {"categorie", TypeColonne::TEXTE}}, p_tailleLot);
+    for (const auto &ligneM : p_donnees.getLignes())
+    {
+        const Ligne &ligne = ligneM.second;
+        flux.entier(0, ligne.getId());
+        flux.texte(1, ligne.getNumero());
+        flux.texte(2, ligne.getDescription());
+        flux.texte(3, Ligne::categorieToString(ligne.getCategorie()));
+        flux.finRangee();
+    }
+    flux.terminer();
+}
+
+void ExportateurArrow::exporterVoyages(const DonneesGTFS &p_donnees, const std::string &p_fichier,
+                                       std::size_t p_tailleLot)
+{
+    FluxArrow flux(p_fichier, {{"voyage_id", TypeColonne::TEXTE}, {"ligne_id", TypeColonne::ENTIER},
+                               {"service_id", TypeColonne::TEXTE}, {"destination", TypeColonne::TEXTE},
+                               {"direction", TypeColonne::ENTIER}, {"bloc", TypeColonne::TEXTE}}, p_tailleLot);
+    for (const auto &voyageM : p_donnees.getVoyages())
+    {
+        const Voyage &voyage = voyageM.second;
+        flux.texte(0, voyageM.first);
+        flux.entier(1, voyage.getLigne());
+        flux.texte(2, voyage.getServiceId());
+        flux.texte(3, voyage.getDestination());
+        flux.entier(4, voyage.getDirection());
+        flux.texte(5, voyage.getBloc());
+        flux.finRangee();
+    }
+    flux.terminer();
+}
+
+void ExportateurArrow::exporterArrets(const DonneesGTFS &p_donnees, const std::string &p_fichier,
+                                      std::size_t p_tailleLot)
+{
+    FluxArrow flux(p_fichier, {{"voyage_id", TypeColonne::TEXTE}, {"numero_sequence", TypeColonne::ENTIER},
+                               {"station_id", TypeColonne::ENTIER}, {"arrivee_s", TypeColonne::ENTIER},
+                               {"depart_s", TypeColonne::ENTIER}}, p_tailleLot);
+    for (const auto &voyageM : p_donnees.getVoyages())
+    {
+        for (const Arret &arret : voyageM.second.getArrets())
+        {
+            flux.texte(0, voyageM.first);
+            flux.entier(1, arret.getNumeroSequence());
+            flux.entier(2, arret.getStationId());
+            flux.entier(3, secondes(arret.getHeureArrivee()));
+            flux.entier(4, secondes(arret.getHeureDepart()));
+            flux.finRangee();
+        }
+    }
+    flux.terminer();
+}
+
+void ExportateurArrow::exporterTransferts(const DonneesGTFS &p_donnees, const std::string &p_fichier,
+                                          std::size_t p_tailleLot)
+{
+    FluxArrow flux(p_fichier, {{"station_depart", TypeColonne::ENTIER}, {"station_arrivee", TypeColonne::ENTIER},
+                               {"duree_s", TypeColonne::ENTIER}}, p_tailleLot);
+    for (const auto &transfert : p_donnees.getTransferts())
+    {
+        flux.entier(0, get<0>(transfert));
+        flux.entier(1, get<1>(transfert));
+        flux.entier(2, get<2>(transfert));
+        flux.finRangee();
+    }
+    flux.terminer();
+}
@@ -0,0 +1,40 @@
+//
+// Export en colonnes (format de flux IPC d'Apache Arrow) du réseau chargé dans DonneesGTFS
+//
+
+#ifndef RTC_EXPORT_ARROW_H
+#define RTC_EXPORT_ARROW_H
+
+#include <cstddef>
+#include <string>
+#include "DonneesGTFS.h"
+
+/*!
+ * \class ExportateurArrow
+ * \brief Écrit les stations, lignes, voyages, arrêts et transferts d'un DonneesGTFS en fichiers de colonnes typées.
+ *
+ * Chaque table est un fichier au format de flux IPC d'Arrow (stations.arrows, lignes.arrows, voyages.arrows,
+ * arrets.arrows, transferts.arrows), lisible par exemple par pyarrow.ipc.open_stream. Les rangées sont écrites par
+ * lots de p_tailleLot: la mémoire utilisée ne dépend que de la taille d'un lot, quel que soit le nombre d'arrêts.
+ *
+ * Colonnes:
+ *  - stations: station_id (uint32), nom, description (utf8), latitude, longitude (double)
+ *  - lignes: ligne_id (uint32), numero, description, categorie (utf8)
+ *  - voyages: voyage_id (utf8), ligne_id (uint32), service_id, destination (utf8), direction (uint32), bloc (utf8)
+ *  - arrets: voyage_id (utf8), numero_sequence, station_id, arrivee_s, depart_s (uint32, secondes depuis minuit)
+ *  - transferts: station_depart, station_arrivee, duree_s (uint32)
+ */
+class ExportateurArrow
+{
+
+public:
+    static void exporter(const DonneesGTFS &p_donnees, const std::string &p_dossier, std::size_t p_tailleLot = 1 << 16);
+
+    static void exporterStations(const DonneesGTFS &p_donnees, const std::string &p_fichier, std::size_t p_tailleLot);
+    static void exporterLignes(const DonneesGTFS &p_donnees, const std::string &p_fichier, std::size_t p_tailleLot);
+    static void exporterVoyages(const DonneesGTFS &p_donnees, const std::string &p_fichier, std::size_t p_tailleLot);
+    static void exporterArrets(const DonneesGTFS &p_donnees, const std::string &p_fichier, std::size_t p_tailleLot);
+    static void exporterTransferts(const DonneesGTFS &p_donnees, const std::string &p_fichier, std::size_t p_tailleLot);
+};
+
+#endif //RTC_EXPORT_ARROW_H
@@ -0,0 +1,266 @@
+//
+// Générateur de flux GTFS synthétiques, déterministes et de taille paramétrable
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace
+{
+    struct Parametres
+    {
+        string sortie;
+        unsigned int lignes;
+        unsigned int arretsParLigne;
+        unsigned int intervalle;  //minutes entre deux départs d'une même ligne et direction
+        unsigned int jours;
+        double densiteTransferts; //probabilité qu'une station ait des transferts vers ses voisines
+        unsigned long graine;
+        unsigned int dateDebut;   //AAAAMMJJ
+        unsigned int heureDebut;
+        unsigned int heureFin;
+    };
+
+    const char *const COULEURS[5] = {"97BF0D", "013888", "E04503", "1A171B", "003888"};
+
+    void usage()
+    {
+        cerr << "usage: generateur_gtfs --sortie DOSSIER [--lignes N] [--arrets-par-ligne N] [--intervalle MIN]"
+             << " [--jours N] [--densite-transferts P] [--graine N] [--date AAAAMMJJ]"
+             << " [--heure-debut H] [--heure-fin H]" << endl;
+        exit(2);
+    }
+
+    Parametres lireParametres(int argc, char *argv[])
+    {
+        Parametres p = {"", 100, 30, 10, 1, 0.3, 1, 20170818, 5, 24};
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const char *valeur = argv[i + 1];
+            if (!strcmp(argv[i], "--sortie")) p.sortie = valeur;
+            else if (!strcmp(argv[i], "--lignes")) p.lignes = (unsigned int) strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--arrets-par-ligne")) p.arretsParLigne = (unsigned int) strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--intervalle")) p.intervalle = (unsigned int) strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--jours")) p.jours = (unsigned int) strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--densite-transferts")) p.densiteTransferts = strtod(valeur, nullptr);
+            else if (!strcmp(argv[i], "--graine")) p.graine = strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--date")) p.dateDebut = (unsigned int) strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--heure-debut")) p.heureDebut = (unsigned int) strtoul(valeur, nullptr, 10);
+            else if (!strcmp(argv[i], "--heure-fin")) p.heureFin = (unsigned int) strtoul(valeur, nullptr, 10);
+            else usage();
+        }
+        if (p.sortie.empty() || p.lignes == 0 || p.arretsParLigne < 2 || p.intervalle == 0 || p.jours == 0 ||
+            p.heureFin <= p.heureDebut)
+            usage();
+        return p;
+    }
+
+    //! \brief retourne la date AAAAMMJJ qui suit p_date
+    unsigned int lendemain(unsigned int p_date)
+    {
+        static const unsigned int JOURS_PAR_MOIS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        unsigned int an = p_date / 10000, mois = p_date / 100 % 100, jour = p_date % 100;
+        unsigned int nbJours = JOURS_PAR_MOIS[mois - 1] +
+                               (mois == 2 && an % 4 == 0 && (an % 100 != 0 || an % 400 == 0) ? 1 : 0);
+        if (++jour > nbJours)
+        {
+            jour = 1;
+            if (++mois > 12)
+            {
+                mois = 1;
+                ++an;
+            }
+        }
+        return an * 10000 + mois * 100 + jour;
+    }
+
+    //! \brief écrit une heure HH:MM:SS (les heures peuvent dépasser 24) dans p_tampon
+    int formaterHeure(char *p_tampon, unsigned int p_secondes)
+    {
+        return sprintf(p_tampon, "%02u:%02u:%02u", p_secondes / 3600, p_secondes / 60 % 60, p_secondes % 60);
+    }
+
+    //! \brief crée le dossier de sortie s'il n'existe pas encore (un seul niveau, comme mkdir)
+    void creerDossier(const Parametres &p_parametres)
+    {
+        if (mkdir(p_parametres.sortie.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            cerr << "Impossible de créer " << p_parametres.sortie << ": " << strerror(errno) << endl;
+            exit(1);
+        }
+    }
+
+    ofstream ouvrir(const Parametres &p_parametres, const char *p_nom)
+    {
+        ofstream fichier(p_parametres.sortie + "/" + p_nom);
+        if (!fichier.good())
+        {
+            cerr << "Impossible d'écrire " << p_parametres.sortie << "/" << p_nom << endl;
+            exit(1);
+        }
+        return fichier;
+    }
+}
+
+/*!
+ * Écrit dans un dossier, créé au besoin, un flux GTFS cohérent (routes, stops, calendar_dates, trips, stop_times,
+ * transfers, agency) dans le format lu par DonneesGTFS.
+ *
+ * Les stations sont les noeuds d'une grille centrée sur Québec; chaque ligne parcourt la grille par une marche
+ * aléatoire, si bien que les lignes se croisent à des stations partagées. Chaque ligne a des temps de parcours
+ * fixes; un voyage part toutes les --intervalle minutes dans chaque direction, et le voyage retour est effectué
+ * par le même véhicule (même block_id). Le même --graine produit toujours les mêmes fichiers.
+ */
+int main(int argc, char *argv[])
+{
+    const Parametres p = lireParametres(argc, argv);
+    mt19937_64 generateur(p.graine);
+    auto tirer = [&generateur](unsigned int n) { return (unsigned int) (generateur() % n); };
+
+    // Grille de stations: environ deux passages de ligne par station
+    const unsigned int cote = max(2u, (unsigned int) ceil(sqrt(p.lignes * (double) p.arretsParLigne / 2.0)));
+    const double pas = 0.004; //environ 400 m en latitude
+    const unsigned int premierId = 1000;
+
+    vector<vector<unsigned int> > parcours(p.lignes);
+    vector<unsigned char> utilisee(cote * cote, 0);
+    for (auto &noeuds : parcours)
+    {
+        unsigned int x = tirer(cote), y = tirer(cote);
+        int dx = 1, dy = 0;
+        for (unsigned int k = 0; k < p.arretsParLigne; ++k)
+        {
+            noeuds.push_back(y * cote + x);
+            utilisee[y * cote + x] = 1;
+            // Tourner de temps en temps, sans jamais revenir sur ses pas, et rebondir sur les bords
+            if (tirer(4) == 0)
+            {
+                swap(dx, dy);
+                if (tirer(2)) { dx = -dx; dy = -dy; }
+            }
+            if ((int) x + dx < 0 || (int) x + dx >= (int) cote) dx = -dx;
+            if ((int) y + dy < 0 || (int) y + dy >= (int) cote) dy = -dy;
+            x += dx;
+            y += dy;
+        }
+    }
+
+    creerDossier(p);
+    ofstream agence = ouvrir(p, "agency.txt");
+    agence << "agency_id,agency_name,agency_url,agency_timezone,agency_lang,agency_phone\n"
+           << "SYN,\"Réseau synthétique\",http://example.org,America/Montreal,fr,000 000-0000\n";
+
+    ofstream routes = ouvrir(p, "routes.txt");
+    routes << "route_id,agency_id,route_short_name,route_long_name,route_desc,route_type,route_url,route_color,"
+              "route_text_color\n";
+    for (unsigned int l = 0; l < p.lignes; ++l)
+    {
+        routes << 100000 + l << ",SYN,\"" << l + 1 << "\",,\"Ligne synthétique " << l + 1 << "\",3,,"
+               << COULEURS[l % 5] << ",FFFFFF\n";
+    }
+
+    ofstream stops = ouvrir(p, "stops.txt");
+    stops << "stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,wheelchair_boarding\n";
+    char tampon[256];
+    for (unsigned int n = 0; n < cote * cote; ++n)
+    {
+        if (!utilisee[n]) continue;
+        const unsigned int x = n % cote, y = n / cote;
+        sprintf(tampon, "%u,\"Rue %u / Avenue %u\",\"Rue %u / Avenue %u\",%.6f,%.6f,,0,1\n", premierId + n, y + 1,
+                x + 1, y + 1, x + 1, 46.8 + (y - cote / 2.0) * pas, -71.25 + (x - cote / 2.0) * pas * 1.45);
+        stops << tampon;
+    }
+
+    ofstream transfers = ouvrir(p, "transfers.txt");
+    transfers << "from_stop_id,to_stop_id,transfer_type,min_transfer_time\n";
+    for (unsigned int n = 0; n < cote * cote; ++n)
+    {
+        if (!utilisee[n] || tirer(1000000) >= p.densiteTransferts * 1000000) continue;
+        const unsigned int x = n % cote, y = n / cote;
+        const unsigned int voisins[4] = {x + 1 < cote ? n + 1 : n, x > 0 ? n - 1 : n,
+                                         y + 1 < cote ? n + cote : n, y > 0 ? n - cote : n};
+        for (unsigned int v : voisins)
+        {
+            if (v != n && utilisee[v])
+                transfers << premierId + n << "," << premierId + v << ",2," << 240 + 30 * tirer(5) << "\n";
+        }
+    }
+
+    // Temps de parcours et d'attente fixes par ligne et par segment: les voyages d'une ligne ne se dépassent pas
+    vector<vector<unsigned int> > parcoursSecondes(p.lignes), attenteSecondes(p.lignes);
+    for (unsigned int l = 0; l < p.lignes; ++l)
+    {
+        for (unsigned int k = 0; k < p.arretsParLigne; ++k)
+        {
+            parcoursSecondes[l].push_back(60 + 30 * tirer(5));
+            attenteSecondes[l].push_back(tirer(3) == 0 ? 30 : 0);
+        }
+    }
+
+    ofstream calendrier = ouvrir(p, "calendar_dates.txt");
+    ofstream trips = ouvrir(p, "trips.txt");
+    ofstream stopTimes = ouvrir(p, "stop_times.txt");
+    calendrier << "service_id,date,exception_type\n";
+    trips << "route_id,service_id,trip_id,trip_headsign,trip_short_name,direction_id,block_id,shape_id,"
+             "wheelchair_accessible\n";
+    stopTimes << "trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type\n";
+
+    unsigned long long nbLignesStopTimes = 0;
+    unsigned int date = p.dateDebut;
+    for (unsigned int j = 0; j < p.jours; ++j, date = lendemain(date))
+    {
+        const string service = "SYN-" + to_string(date);
+        calendrier << service << "," << date << ",1\n";
+
+        for (unsigned int l = 0; l < p.lignes; ++l)
+        {
+            const unsigned int decalage = tirer(p.intervalle * 60);
+            unsigned int k = 0;
+            for (unsigned int depart = p.heureDebut * 3600 + decalage; depart < p.heureFin * 3600;
+                 depart += p.intervalle * 60, ++k)
+            {
+                const string bloc = to_string(l + 1) + "-" + to_string(date) + "-" + to_string(k);
+                unsigned int heure = depart;
+                for (unsigned int direction = 0; direction < 2; ++direction)
+                {
+                    const string voyage = bloc + "-" + to_string(direction);
+                    const unsigned int terminus = direction == 0 ? p.arretsParLigne - 1 : 0;
+                    trips << 100000 + l << "," << service << "," << voyage << ",\"Terminus "
+                          << premierId + parcours[l][terminus] << "\",," << direction << "," << bloc << ",,1\n";
+
+                    for (unsigned int s = 0; s < p.arretsParLigne; ++s)
+                    {
+                        const unsigned int position = direction == 0 ? s : p.arretsParLigne - 1 - s;
+                        const unsigned int arrivee = heure;
+                        const unsigned int departArret = arrivee + attenteSecondes[l][position];
+                        int n = sprintf(tampon, "%s,", voyage.c_str());
+                        n += formaterHeure(tampon + n, arrivee);
+                        tampon[n++] = ',';
+                        n += formaterHeure(tampon + n, departArret);
+                        n += sprintf(tampon + n, ",%u,%u,0,0\n", premierId + parcours[l][position], s + 1);
+                        stopTimes.write(tampon, n);
+                        ++nbLignesStopTimes;
+                        heure = departArret + parcoursSecondes[l][position];
+                    }
+                    heure += 300; //battement au terminus avant le voyage retour
+                }
+            }
+        }
+    }
+
+    cerr << "Stations: " << count(utilisee.begin(), utilisee.end(), 1) << ", lignes: " << p.lignes
+         << ", lignes de stop_times: " << nbLignesStopTimes << endl;
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Extraction des motifs de voyages et compression des horaires
+//
+
+#include "horaires_compresses.h"
+#include "voyage.h"
+
+using namespace std;
+
+namespace
+{
+    const size_t TAILLE_NOEUD_ARBRE = 4 * sizeof(void *); //couleur, parent, gauche, droite
+
+    //! \brief ajoute un entier signé (zigzag puis 7 bits par octet) à la fin de p_octets
+    void encoder(vector<uint8_t> &p_octets, int p_valeur)
+    {
+        uint32_t v = ((uint32_t) p_valeur << 1) ^ (uint32_t) (p_valeur >> 31);
+        while (v >= 0x80)
+        {
+            p_octets.push_back((uint8_t) (v | 0x80));
+            v >>= 7;
+        }
+        p_octets.push_back((uint8_t) v);
+    }
+}
+
+HorairesCompresses::HorairesCompresses()
+{
+}
+
+/*!
+ * \brief remplace les arrêts bruts d'un voyage par son motif et son profil de temps, ajoutés au besoin
+ * \param[in,out] p_voyage: le voyage; ses arrêts restent lisibles par getArrets(), qui les décode ensuite ici
+ * \post les arrêts bruts du voyage sont libérés; ces horaires doivent survivre au voyage et à ses copies
+ */
+void HorairesCompresses::compresser(Voyage &p_voyage)
+{
+    if (p_voyage.m_horaires == this) return;
+    if (p_voyage.m_horaires) p_voyage.decompresser();
+    const vector<Voyage::ArretBrut> &bruts = p_voyage.m_arretsBruts;
+
+    // La clé du motif: ligne, direction, stations puis numéros de séquence
+    vector<unsigned int> cle;
+    cle.reserve(2 + 2 * bruts.size());
+    cle.push_back(p_voyage.getLigne());
+    cle.push_back(p_voyage.getDirection());
+    for (const Voyage::ArretBrut &a : bruts) cle.push_back(a.station);
+    for (const Voyage::ArretBrut &a : bruts) cle.push_back(a.sequence);
+    auto motif = m_indexMotifs.find(cle);
+    if (motif == m_indexMotifs.end())
+    {
+        motif = m_indexMotifs.insert({cle, (unsigned int) m_arretsMotifs.size()}).first;
+        for (const Voyage::ArretBrut &a : bruts) m_arretsMotifs.push_back({a.station, a.sequence});
+    }
+
+    // Le profil: attente au premier arrêt, puis, pour chaque arrêt suivant, parcours depuis le précédent et attente
+    vector<uint8_t> profil;
+    for (size_t k = 0; k < bruts.size(); ++k)
+    {
+        if (k > 0) encoder(profil, (int) bruts[k].arrivee - (int) bruts[k - 1].depart);
+        encoder(profil, (int) bruts[k].depart - (int) bruts[k].arrivee);
+    }
+    auto debutProfil = m_indexProfils.find(profil);
+    if (debutProfil == m_indexProfils.end())
+    {
+        debutProfil = m_indexProfils.insert({profil, (unsigned int) m_profils.size()}).first;
+        m_profils.insert(m_profils.end(), profil.begin(), profil.end());
+    }
+
+    p_voyage.m_horaires = this;
+    p_voyage.m_motif = motif->second;
+    p_voyage.m_profil = debutProfil->second;
+    p_voyage.m_debut = bruts.empty() ? 0 : bruts.front().arrivee;
+    p_voyage.m_nbArrets = (unsigned int) bruts.size();
+    vector<Voyage::ArretBrut>().swap(p_voyage.m_arretsBruts);
+}
+
+//! \brief enlève tous les motifs et les profils
+//! \pre aucun voyage compressé ici n'est encore lu
+void HorairesCompresses::vider()
+{
+    vector<ArretMotif>().swap(m_arretsMotifs);
+    vector<uint8_t>().swap(m_profils);
+    m_indexMotifs.clear();
+    m_indexProfils.clear();
+}
+
+size_t HorairesCompresses::getNbMotifs() const
+{
+    return m_indexMotifs.size();
+}
+
+size_t HorairesCompresses::getNbProfils() const
+{
+    return m_indexProfils.size();
+}
+
+//! \brief retourne la mémoire occupée par les motifs, les profils et leurs index, en octets
+size_t HorairesCompresses::getTailleOctets() const
+{
+    size_t taille = m_arretsMotifs.capacity() * sizeof(ArretMotif) + m_profils.capacity();
+    for (const auto &m : m_indexMotifs)
+    {
+        taille += TAILLE_NOEUD_ARBRE + sizeof(m) + m.first.capacity() * sizeof(unsigned int);
+    }
+    for (const auto &p : m_indexProfils)
+    {
+        taille += TAILLE_NOEUD_ARBRE + sizeof(p) + p.first.capacity();
+    }
+    return taille;
+}
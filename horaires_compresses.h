@@ -0,0 +1,69 @@
+//
+// Extraction des motifs de voyages et compression des horaires
+//
+
+#ifndef RTC_HORAIRES_COMPRESSES_H
+#define RTC_HORAIRES_COMPRESSES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class Voyage;
+
+/*!
+ * \class HorairesCompresses
+ * \brief Horaires compressés des voyages d'un objet DonneesGTFS, lus par Voyage::getArrets() et Station::getArrets().
+ *
+ * Les voyages sont regroupés en motifs (ligne, direction, suite de stations et de numéros de séquence): la liste
+ * des arrêts d'un motif n'est stockée qu'une fois. Chaque voyage ne garde que son motif, l'heure d'arrivée à son
+ * premier arrêt et son profil de temps: la suite des temps d'attente (départ - arrivée) et de parcours (arrivée
+ * suivante - départ), encodés en différences de longueur variable. Les profils identiques sont partagés, ce qui est
+ * le cas de la plupart des voyages d'un même motif, qui ne diffèrent que par leur heure de départ.
+ *
+ * Les motifs et les profils ne sont jamais enlevés, sauf par vider(): recompresser un voyage en ajoute au besoin.
+ */
+class HorairesCompresses
+{
+
+public:
+    HorairesCompresses();
+
+    void compresser(Voyage &p_voyage);
+    void vider();
+
+    std::size_t getNbMotifs() const;
+    std::size_t getNbProfils() const;
+    std::size_t getTailleOctets() const;
+
+private:
+    friend class Voyage;
+
+    struct ArretMotif
+    {
+        unsigned int station;
+        unsigned int sequence;
+    };
+
+    //! \brief lit un entier signé (zigzag, 7 bits par octet) et avance p_octets jusqu'au suivant
+    static int decoder(const std::uint8_t *&p_octets)
+    {
+        std::uint32_t v = 0;
+        unsigned int decalage = 0;
+        while (*p_octets & 0x80)
+        {
+            v |= (std::uint32_t) (*p_octets++ & 0x7F) << decalage;
+            decalage += 7;
+        }
+        v |= (std::uint32_t) (*p_octets++) << decalage;
+        return (int) (v >> 1) ^ -(int) (v & 1);
+    }
+
+    std::vector<ArretMotif> m_arretsMotifs; //arrêts des motifs, bout à bout
+    std::vector<std::uint8_t> m_profils;    //profils de temps, bout à bout
+    std::map<std::vector<unsigned int>, unsigned int> m_indexMotifs;   //clé du motif -> début dans m_arretsMotifs
+    std::map<std::vector<std::uint8_t>, unsigned int> m_indexProfils; //profil -> début dans m_profils
+};
+
+#endif //RTC_HORAIRES_COMPRESSES_H
@@ -0,0 +1,326 @@
+//
+// Index des positions des lignes de stop_times.txt par voyage, pour le chargement à la demande des arrêts
+//
+
+#include "index_arrets.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace
+{
+    const char MAGIQUE[4] = {'I', 'D', 'X', 'A'};
+    const uint32_t VERSION_FORMAT = 1;
+
+    //! \brief retourne la taille et la date de modification d'un fichier
+    //! \throws logic_error si le fichier n'existe pas
+    void identifierSource(const string &p_nomFichier, uint64_t &p_taille, int64_t &p_date)
+    {
+        struct stat etat;
+        if (stat(p_nomFichier.c_str(), &etat) != 0)
+            throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+        p_taille = (uint64_t) etat.st_size;
+        p_date = (int64_t) etat.st_mtime;
+    }
+
+    void ecrireChaine(ofstream &p_flux, const string &p_chaine)
+    {
+        uint32_t taille = (uint32_t) p_chaine.size();
+        p_flux.write(reinterpret_cast<const char *>(&taille), sizeof(taille));
+        p_flux.write(p_chaine.data(), taille);
+    }
+
+    void lireChaine(ifstream &p_flux, string &p_chaine)
+    {
+        uint32_t taille = 0;
+        p_flux.read(reinterpret_cast<char *>(&taille), sizeof(taille));
+        p_chaine.resize(p_flux ? taille : 0);
+        if (taille) p_flux.read(&p_chaine[0], taille);
+    }
+
+    template<typename T>
+    void ecrireVecteur(ofstream &p_flux, const vector<T> &p_vecteur)
+    {
+        uint32_t taille = (uint32_t) p_vecteur.size();
+        p_flux.write(reinterpret_cast<const char *>(&taille), sizeof(taille));
+        p_flux.write(reinterpret_cast<const char *>(p_vecteur.data()), taille * sizeof(T));
+    }
+
+    template<typename T>
+    void lireVecteur(ifstream &p_flux, vector<T> &p_vecteur)
+    {
+        uint32_t taille = 0;
+        p_flux.read(reinterpret_cast<char *>(&taille), sizeof(taille));
+        p_vecteur.resize(p_flux ? taille : 0);
+        if (taille) p_flux.read(reinterpret_cast<char *>(p_vecteur.data()), taille * sizeof(T));
+    }
+}
+
+IndexArrets::IndexArrets() : m_tailleSource(0), m_dateSource(0)
+{
+}
+
+/*!
+ * \brief construit l'index en lisant une fois stop_times.txt (colonnes trip_id en 0 et stop_id en 3, comme
+ * DonneesGTFS::ajouterArretsDesVoyagesDeLaDate)
+ * \throws logic_error si le fichier ne peut pas être lu
+ */
+IndexArrets::IndexArrets(const std::string &p_fichierArrets) : m_fichierArrets(p_fichierArrets)
+{
+    identifierSource(p_fichierArrets, m_tailleSource, m_dateSource);
+    ifstream file(p_fichierArrets, ios::binary);
+    if (!file.good())
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+
+    getline(file, m_entete);
+    uint64_t position = m_entete.size() + 1;
+
+    unordered_map<uint32_t, vector<uint32_t> > voyagesParStation;
+    vector<vector<pair<uint64_t, uint32_t> > > plages;
+    uint32_t precedent = UINT32_MAX;
+    string line;
+    while (getline(file, line))
+    {
+        const uint32_t longueur = (uint32_t) line.size() + 1;
+        const size_t virgule = line.find(',');
+        if (virgule == string::npos)
+        {
+            position += longueur;
+            continue;
+        }
+
+        uint32_t voyage = precedent;
+        if (voyage == UINT32_MAX || line.compare(0, virgule, m_voyages[voyage]) != 0)
+        {
+            auto resultat = m_indexVoyages.insert({line.substr(0, virgule), (uint32_t) m_voyages.size()});
+            voyage = resultat.first->second;
+            if (resultat.second)
+            {
+                m_voyages.push_back(resultat.first->first);
+                plages.emplace_back();
+            }
+        }
+        // Les lignes consécutives d'un même voyage forment une seule plage
+        if (voyage == precedent && !plages[voyage].empty() &&
+            plages[voyage].back().first + plages[voyage].back().second == position)
+            plages[voyage].back().second += longueur;
+        else
+            plages[voyage].push_back({position, longueur});
+        precedent = voyage;
+
+        size_t champ = virgule;
+        for (int i = 0; i < 2 && champ != string::npos; ++i) champ = line.find(',', champ + 1);
+        if (champ != string::npos)
+        {
+            const uint32_t station = (uint32_t) strtoul(line.c_str() + champ + 1, nullptr, 10);
+            vector<uint32_t> &voyages = voyagesParStation[station];
+            if (voyages.empty() || voyages.back() != voyage) voyages.push_back(voyage);
+        }
+        position += longueur;
+    }
+
+    m_debutPlages.push_back(0);
+    for (const auto &p : plages)
+    {
+        for (const auto &plage : p)
+        {
+            m_positions.push_back(plage.first);
+            m_longueurs.push_back(plage.second);
+        }
+        m_debutPlages.push_back((uint32_t) m_positions.size());
+    }
+
+    for (const auto &s : voyagesParStation) m_stations.push_back(s.first);
+    sort(m_stations.begin(), m_stations.end());
+    m_debutStations.push_back(0);
+    for (uint32_t station : m_stations)
+    {
+        vector<uint32_t> &voyages = voyagesParStation[station];
+        sort(voyages.begin(), voyages.end());
+        voyages.erase(unique(voyages.begin(), voyages.end()), voyages.end());
+        m_voyagesStations.insert(m_voyagesStations.end(), voyages.begin(), voyages.end());
+        m_debutStations.push_back((uint32_t) m_voyagesStations.size());
+    }
+}
+
+/*!
+ * \brief retourne l'index de stop_times.txt: celui sauvegardé à côté du fichier s'il est à jour, sinon un index
+ * reconstruit, qui est alors sauvegardé (sans erreur si le dossier est en lecture seule)
+ * \throws logic_error si stop_times.txt ne peut pas être lu
+ */
+IndexArrets IndexArrets::ouvrir(const std::string &p_fichierArrets)
+{
+    IndexArrets index;
+    try
+    {
+        index.charger(nomFichierIndex(p_fichierArrets));
+        uint64_t taille = 0;
+        int64_t date = 0;
+        identifierSource(p_fichierArrets, taille, date);
+        if (taille == index.m_tailleSource && date == index.m_dateSource)
+        {
+            index.m_fichierArrets = p_fichierArrets; //le chemin sauvegardé peut être relatif à un autre dossier
+            return index;
+        }
+    } catch (const logic_error &)
+    {
+    }
+
+    index = IndexArrets(p_fichierArrets);
+    try
+    {
+        index.sauvegarder(nomFichierIndex(p_fichierArrets));
+    } catch (const logic_error &)
+    {
+    }
+    return index;
+}
+
+//! \brief retourne le nom du fichier d'index associé à stop_times.txt
+std::string IndexArrets::nomFichierIndex(const std::string &p_fichierArrets)
+{
+    return p_fichierArrets + ".idx";
+}
+
+bool IndexArrets::estVide() const
+{
+    return m_fichierArrets.empty();
+}
+
+std::size_t IndexArrets::getNbVoyages() const
+{
+    return m_voyages.size();
+}
+
+const std::string &IndexArrets::getFichierArrets() const
+{
+    return m_fichierArrets;
+}
+
+/*!
+ * \brief relit dans stop_times.txt l'en-tête et les lignes d'un voyage
+ * \param[out] p_lignes: l'en-tête suivi des lignes du voyage, dans l'ordre du fichier
+ * \return false si le voyage n'apparaît pas dans stop_times.txt
+ * \throws logic_error si le fichier ne peut pas être lu
+ */
+bool IndexArrets::lireLignesDuVoyage(const std::string &p_voyage_id, std::string &p_lignes) const
+{
+    auto it = m_indexVoyages.find(p_voyage_id);
+    if (it == m_indexVoyages.end()) return false;
+
+    ifstream file(m_fichierArrets, ios::binary);
+    if (!file.good())
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+
+    p_lignes = m_entete;
+    p_lignes.push_back('\n');
+    for (uint32_t p = m_debutPlages[it->second]; p < m_debutPlages[it->second + 1]; ++p)
+    {
+        const size_t debut = p_lignes.size();
+        p_lignes.resize(debut + m_longueurs[p]);
+        file.seekg((streamoff) m_positions[p]);
+        file.read(&p_lignes[debut], m_longueurs[p]);
+        p_lignes.resize(debut + (size_t) file.gcount()); //la dernière ligne du fichier peut être sans fin de ligne
+        file.clear();
+    }
+    return true;
+}
+
+//! \brief retourne les trip_id des voyages qui ont au moins un arrêt à cette station (dans tout stop_times.txt)
+std::vector<std::string> IndexArrets::getVoyagesDeStation(unsigned int p_station_id) const
+{
+    vector<string> voyages;
+    auto it = lower_bound(m_stations.begin(), m_stations.end(), p_station_id);
+    if (it == m_stations.end() || *it != p_station_id) return voyages;
+    const size_t j = (size_t) (it - m_stations.begin());
+    for (uint32_t k = m_debutStations[j]; k < m_debutStations[j + 1]; ++k)
+        voyages.push_back(m_voyages[m_voyagesStations[k]]);
+    return voyages;
+}
+
+/*!
+ * \brief sauvegarde l'index dans un fichier binaire
+ * \throws logic_error si le fichier ne peut pas être écrit
+ */
+void IndexArrets::sauvegarder(const std::string &p_nomFichier) const
+{
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.good())
+        throw logic_error("Une erreur est survenue lors de l'écriture du fichier.");
+
+    fichier.write(MAGIQUE, 4);
+    fichier.write(reinterpret_cast<const char *>(&VERSION_FORMAT), sizeof(VERSION_FORMAT));
+    ecrireChaine(fichier, m_fichierArrets);
+    fichier.write(reinterpret_cast<const char *>(&m_tailleSource), sizeof(m_tailleSource));
+    fichier.write(reinterpret_cast<const char *>(&m_dateSource), sizeof(m_dateSource));
+    ecrireChaine(fichier, m_entete);
+    uint32_t nb = (uint32_t) m_voyages.size();
+    fichier.write(reinterpret_cast<const char *>(&nb), sizeof(nb));
+    for (const string &v : m_voyages) ecrireChaine(fichier, v);
+    ecrireVecteur(fichier, m_debutPlages);
+    ecrireVecteur(fichier, m_positions);
+    ecrireVecteur(fichier, m_longueurs);
+    ecrireVecteur(fichier, m_stations);
+    ecrireVecteur(fichier, m_debutStations);
+    ecrireVecteur(fichier, m_voyagesStations);
+    if (!fichier)
+        throw logic_error("Une erreur est survenue lors de l'écriture du fichier.");
+}
+
+/*!
+ * \brief remplace l'index par celui sauvegardé dans un fichier par sauvegarder()
+ * \throws logic_error si le fichier est illisible ou invalide, ou si stop_times.txt a changé depuis l'indexation
+ */
+void IndexArrets::charger(const std::string &p_nomFichier)
+{
+    ifstream fichier(p_nomFichier, ios::binary);
+    if (!fichier.good())
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+
+    char magique[4];
+    uint32_t version = 0, nb = 0;
+    fichier.read(magique, 4);
+    fichier.read(reinterpret_cast<char *>(&version), sizeof(version));
+    if (!fichier || memcmp(magique, MAGIQUE, 4) != 0 || version != VERSION_FORMAT)
+        throw logic_error("Le fichier d'index des arrêts est invalide.");
+
+    IndexArrets index;
+    lireChaine(fichier, index.m_fichierArrets);
+    fichier.read(reinterpret_cast<char *>(&index.m_tailleSource), sizeof(index.m_tailleSource));
+    fichier.read(reinterpret_cast<char *>(&index.m_dateSource), sizeof(index.m_dateSource));
+    lireChaine(fichier, index.m_entete);
+    fichier.read(reinterpret_cast<char *>(&nb), sizeof(nb));
+    index.m_voyages.resize(fichier ? nb : 0);
+    for (uint32_t i = 0; fichier && i < nb; ++i) lireChaine(fichier, index.m_voyages[i]);
+    lireVecteur(fichier, index.m_debutPlages);
+    lireVecteur(fichier, index.m_positions);
+    lireVecteur(fichier, index.m_longueurs);
+    lireVecteur(fichier, index.m_stations);
+    lireVecteur(fichier, index.m_debutStations);
+    lireVecteur(fichier, index.m_voyagesStations);
+    if (!fichier || index.m_debutPlages.size() != index.m_voyages.size() + 1 ||
+        index.m_debutStations.size() != index.m_stations.size() + 1)
+        throw logic_error("Le fichier d'index des arrêts est invalide.");
+
+    uint64_t taille = 0;
+    int64_t date = 0;
+    identifierSource(index.m_fichierArrets, taille, date);
+    if (taille != index.m_tailleSource || date != index.m_dateSource)
+        throw logic_error("Le fichier d'index des arrêts n'est plus à jour.");
+
+    index.indexerVoyages();
+    *this = index;
+}
+
+void IndexArrets::indexerVoyages()
+{
+    m_indexVoyages.clear();
+    m_indexVoyages.reserve(m_voyages.size());
+    for (uint32_t i = 0; i < m_voyages.size(); ++i) m_indexVoyages[m_voyages[i]] = i;
+}
@@ -0,0 +1,59 @@
+//
+// Index des positions des lignes de stop_times.txt par voyage, pour le chargement à la demande des arrêts
+//
+
+#ifndef RTC_INDEX_ARRETS_H
+#define RTC_INDEX_ARRETS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \class IndexArrets
+ * \brief Positions, dans stop_times.txt, des lignes de chaque voyage (trip_id) et voyages qui passent par chaque station.
+ *
+ * L'index est construit en une seule lecture du fichier et sauvegardé à côté de lui (stop_times.txt.idx); il est
+ * reconstruit automatiquement si la taille ou la date de modification de stop_times.txt a changé. Les lignes d'un
+ * voyage sont ensuite relues directement à leurs positions, sans parcourir le reste du fichier.
+ */
+class IndexArrets
+{
+
+public:
+    IndexArrets();
+    explicit IndexArrets(const std::string &p_fichierArrets);
+
+    static IndexArrets ouvrir(const std::string &p_fichierArrets);
+    static std::string nomFichierIndex(const std::string &p_fichierArrets);
+
+    bool estVide() const;
+    std::size_t getNbVoyages() const;
+    const std::string &getFichierArrets() const;
+
+    bool lireLignesDuVoyage(const std::string &p_voyage_id, std::string &p_lignes) const;
+    std::vector<std::string> getVoyagesDeStation(unsigned int p_station_id) const;
+
+    void sauvegarder(const std::string &p_nomFichier) const;
+    void charger(const std::string &p_nomFichier);
+
+private:
+    void indexerVoyages();
+
+    std::string m_fichierArrets;
+    std::uint64_t m_tailleSource;  //taille et date de modification de stop_times.txt lors de l'indexation
+    std::int64_t m_dateSource;
+    std::string m_entete;          //ligne d'en-tête de stop_times.txt
+
+    std::vector<std::string> m_voyages;       //trip_id, dans l'ordre de première apparition
+    std::vector<std::uint32_t> m_debutPlages; //plages du voyage i: [m_debutPlages[i], m_debutPlages[i + 1])
+    std::vector<std::uint64_t> m_positions;   //position de chaque plage de lignes consécutives
+    std::vector<std::uint32_t> m_longueurs;   //longueur en octets de chaque plage
+    std::vector<std::uint32_t> m_stations;    //stop_id triés
+    std::vector<std::uint32_t> m_debutStations; //voyages de la station j: [m_debutStations[j], m_debutStations[j + 1])
+    std::vector<std::uint32_t> m_voyagesStations; //indices dans m_voyages
+    std::unordered_map<std::string, std::uint32_t> m_indexVoyages; //trip_id -> indice dans m_voyages
+};
+
+#endif //RTC_INDEX_ARRETS_H
@@ -0,0 +1,419 @@
+//
+// Index de recherche des stations par nom et description (autocomplétion)
+//
+
+#include "index_stations.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    const char MAGIQUE[4] = {'I', 'D', 'X', 'S'};
+    const uint32_t VERSION_FORMAT = 1;
+
+    //! \brief équivalents sans accent des caractères U+00C0 à U+00FF (un espace pour les symboles)
+    const char *const LATIN1[64] = {
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+            "d", "n", "o", "o", "o", "o", "o", " ", "o", "u", "u", "u", "u", "y", " ", "ss",
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+            "d", "n", "o", "o", "o", "o", "o", " ", "o", "u", "u", "u", "u", "y", " ", "y"};
+
+    vector<string> mots(const string &p_texte)
+    {
+        vector<string> resultat;
+        istringstream flux(p_texte);
+        string mot;
+        while (flux >> mot) resultat.push_back(mot);
+        return resultat;
+    }
+
+    bool commencePar(const string &p_texte, const string &p_prefixe)
+    {
+        return p_texte.compare(0, p_prefixe.size(), p_prefixe) == 0;
+    }
+
+    //! \brief indique si chaque mot de p_requete est le préfixe d'un mot de p_motsTexte
+    bool motsPrefixes(const vector<string> &p_requete, const vector<string> &p_motsTexte)
+    {
+        for (const string &m : p_requete)
+        {
+            bool trouve = false;
+            for (const string &t : p_motsTexte) trouve = trouve || commencePar(t, m);
+            if (!trouve) return false;
+        }
+        return true;
+    }
+
+    void ecrireChaine(ofstream &p_flux, const string &p_chaine)
+    {
+        uint32_t taille = (uint32_t) p_chaine.size();
+        p_flux.write(reinterpret_cast<const char *>(&taille), sizeof(taille));
+        p_flux.write(p_chaine.data(), taille);
+    }
+
+    void lireChaine(ifstream &p_flux, string &p_chaine)
+    {
+        uint32_t taille = 0;
+        p_flux.read(reinterpret_cast<char *>(&taille), sizeof(taille));
+        p_chaine.resize(p_flux ? taille : 0);
+        if (taille) p_flux.read(&p_chaine[0], taille);
+    }
+
+    template<typename T>
+    void ecrireVecteur(ofstream &p_flux, const vector<T> &p_vecteur)
+    {
+        uint32_t taille = (uint32_t) p_vecteur.size();
+        p_flux.write(reinterpret_cast<const char *>(&taille), sizeof(taille));
+        p_flux.write(reinterpret_cast<const char *>(p_vecteur.data()), taille * sizeof(T));
+    }
+
+    template<typename T>
+    void lireVecteur(ifstream &p_flux, vector<T> &p_vecteur)
+    {
+        uint32_t taille = 0;
+        p_flux.read(reinterpret_cast<char *>(&taille), sizeof(taille));
+        p_vecteur.resize(p_flux ? taille : 0);
+        p_flux.read(reinterpret_cast<char *>(p_vecteur.data()), p_vecteur.size() * sizeof(T));
+    }
+}
+
+IndexStations::IndexStations() : m_trie(1)
+{
+}
+
+/*!
+ * \brief construit l'index sur les noms et descriptions de p_stations
+ * \param[in] p_stations: les stations, indexées par leur identifiant
+ */
+IndexStations::IndexStations(const TableStations &p_stations) : m_trie(1)
+{
+    for (const auto &stationM : p_stations)
+    {
+        Entree e = {stationM.first, normaliser(stationM.second.getNom()),
+                    normaliser(stationM.second.getDescription()), {}, {}};
+        decouper(e);
+        m_entrees.push_back(e);
+        unsigned int indice = (unsigned int) m_entrees.size() - 1;
+        indexer(indice, m_entrees.back().nom, 0);
+        indexer(indice, m_entrees.back().description, 1);
+    }
+    for (auto &t : m_trigrammes)
+    {
+        t.second.erase(unique(t.second.begin(), t.second.end()), t.second.end());
+    }
+}
+
+/*!
+ * \brief normalise un texte UTF-8 pour la recherche
+ * \return le texte en minuscules, sans accents, où toute ponctuation devient un espace et sans espaces superflus
+ */
+string IndexStations::normaliser(const string &p_texte)
+{
+    string resultat;
+    resultat.reserve(p_texte.size());
+    auto ajouter = [&resultat](const char *p_morceau)
+    {
+        if (*p_morceau == ' ')
+        {
+            if (!resultat.empty() && resultat.back() != ' ') resultat.push_back(' ');
+        } else
+        {
+            resultat.append(p_morceau);
+        }
+    };
+
+    for (size_t i = 0; i < p_texte.size(); ++i)
+    {
+        unsigned char c = (unsigned char) p_texte[i];
+        if (isalnum(c) && c < 0x80)
+        {
+            resultat.push_back((char) tolower(c));
+        } else if (c == 0xC3 && i + 1 < p_texte.size() && ((unsigned char) p_texte[i + 1] & 0xC0) == 0x80)
+        {
+            ajouter(LATIN1[(unsigned char) p_texte[++i] & 0x3F]);
+        } else if (c == 0xC5 && i + 1 < p_texte.size() &&
+                   ((unsigned char) p_texte[i + 1] == 0x92 || (unsigned char) p_texte[i + 1] == 0x93))
+        {
+            ++i;
+            ajouter("oe");
+        } else
+        {
+            // ponctuation, espace ou autre caractère multi-octets: séparateur de mots
+            if (c >= 0xC0)
+                while (i + 1 < p_texte.size() && ((unsigned char) p_texte[i + 1] & 0xC0) == 0x80) ++i;
+            ajouter(" ");
+        }
+    }
+    if (!resultat.empty() && resultat.back() == ' ') resultat.pop_back();
+    return resultat;
+}
+
+/*!
+ * \brief recherche les stations dont le nom ou la description correspond à p_requete
+ * \brief Les mots de la requête sont cherchés comme préfixes de mots (trie); si aucune station ne correspond,
+ * la requête entière est cherchée comme sous-chaîne (trigrammes).
+ * \param[in] p_requete: le texte saisi, accentué ou non
+ * \param[in] p_k: le nombre maximal de résultats
+ * \return au plus p_k stations, de la meilleure à la moins bonne
+ */
+vector<IndexStations::Resultat> IndexStations::rechercher(const string &p_requete, size_t p_k) const
+{
+    vector<Resultat> resultats;
+    const string requete = normaliser(p_requete);
+    const vector<string> motsRequete = mots(requete);
+    if (motsRequete.empty() || p_k == 0) return resultats;
+
+    // Candidats par préfixe: intersection des entrées de chaque mot, tous champs confondus
+    vector<unsigned int> candidats;
+    for (size_t m = 0; m < motsRequete.size(); ++m)
+    {
+        vector<unsigned int> entrees;
+        unsigned int noeud = noeudPrefixe(motsRequete[m]);
+        if (noeud) collecter(noeud, entrees);
+        for (unsigned int &e : entrees) e /= 2;
+        sort(entrees.begin(), entrees.end());
+        entrees.erase(unique(entrees.begin(), entrees.end()), entrees.end());
+        if (m == 0)
+        {
+            candidats.swap(entrees);
+        } else
+        {
+            vector<unsigned int> intersection;
+            set_intersection(candidats.begin(), candidats.end(), entrees.begin(), entrees.end(),
+                             back_inserter(intersection));
+            candidats.swap(intersection);
+        }
+    }
+
+    // Sinon, candidats par sous-chaîne: intersection des listes des trigrammes de la requête
+    if (candidats.empty() && requete.size() >= 3)
+    {
+        for (size_t i = 0; i + 3 <= requete.size(); ++i)
+        {
+            auto it = m_trigrammes.find(trigramme(requete.data() + i));
+            if (it == m_trigrammes.end())
+            {
+                candidats.clear();
+                break;
+            }
+            vector<unsigned int> entrees(it->second);
+            for (unsigned int &e : entrees) e /= 2;
+            entrees.erase(unique(entrees.begin(), entrees.end()), entrees.end());
+            if (i == 0)
+            {
+                candidats.swap(entrees);
+            } else
+            {
+                vector<unsigned int> intersection;
+                set_intersection(candidats.begin(), candidats.end(), entrees.begin(), entrees.end(),
+                                 back_inserter(intersection));
+                candidats.swap(intersection);
+            }
+        }
+    }
+
+    for (unsigned int c : candidats)
+    {
+        const Entree &e = m_entrees[c];
+        int score = 0;
+        if (commencePar(e.nom, requete)) score += 100;
+        if (motsPrefixes(motsRequete, e.motsNom)) score += 50;
+        else if (motsPrefixes(motsRequete, e.motsDescription)) score += 20;
+        if (e.nom.find(requete) != string::npos) score += 10;
+        else if (e.description.find(requete) != string::npos) score += 5;
+        if (score > 0)
+        {
+            Resultat r = {e.station_id, score};
+            resultats.push_back(r);
+        }
+    }
+
+    auto meilleur = [](const Resultat &a, const Resultat &b)
+    {
+        if (a.score != b.score) return a.score > b.score;
+        return a.station_id < b.station_id;
+    };
+    if (resultats.size() > p_k)
+    {
+        partial_sort(resultats.begin(), resultats.begin() + p_k, resultats.end(), meilleur);
+        resultats.resize(p_k);
+    } else
+    {
+        sort(resultats.begin(), resultats.end(), meilleur);
+    }
+    return resultats;
+}
+
+size_t IndexStations::getNbStations() const
+{
+    return m_entrees.size();
+}
+
+/*!
+ * \brief sauvegarde l'index (entrées, trie et trigrammes) dans un fichier binaire
+ * \throws logic_error si un problème survient avec l'écriture du fichier
+ */
+void IndexStations::sauvegarder(const string &p_nomFichier) const
+{
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.good())
+        throw logic_error("Une erreur est survenue lors de l'écriture du fichier.");
+
+    fichier.write(MAGIQUE, 4);
+    fichier.write(reinterpret_cast<const char *>(&VERSION_FORMAT), sizeof(VERSION_FORMAT));
+    uint32_t nb = (uint32_t) m_entrees.size();
+    fichier.write(reinterpret_cast<const char *>(&nb), sizeof(nb));
+    for (const Entree &e : m_entrees)
+    {
+        fichier.write(reinterpret_cast<const char *>(&e.station_id), sizeof(e.station_id));
+        ecrireChaine(fichier, e.nom);
+        ecrireChaine(fichier, e.description);
+    }
+    nb = (uint32_t) m_trie.size();
+    fichier.write(reinterpret_cast<const char *>(&nb), sizeof(nb));
+    for (const Noeud &n : m_trie)
+    {
+        ecrireVecteur(fichier, n.enfants);
+        ecrireVecteur(fichier, n.entrees);
+    }
+    nb = (uint32_t) m_trigrammes.size();
+    fichier.write(reinterpret_cast<const char *>(&nb), sizeof(nb));
+    for (const auto &t : m_trigrammes)
+    {
+        fichier.write(reinterpret_cast<const char *>(&t.first), sizeof(t.first));
+        ecrireVecteur(fichier, t.second);
+    }
+    if (!fichier)
+        throw logic_error("Une erreur est survenue lors de l'écriture du fichier.");
+}
+
+/*!
+ * \brief remplace l'index par celui sauvegardé dans un fichier par sauvegarder()
+ * \throws logic_error si le fichier est illisible ou invalide
+ */
+void IndexStations::charger(const string &p_nomFichier)
+{
+    ifstream fichier(p_nomFichier, ios::binary);
+    if (!fichier.good())
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+
+    char magique[4];
+    uint32_t version = 0, nb = 0;
+    fichier.read(magique, 4);
+    fichier.read(reinterpret_cast<char *>(&version), sizeof(version));
+    if (!fichier || memcmp(magique, MAGIQUE, 4) != 0 || version != VERSION_FORMAT)
+        throw logic_error("Le fichier d'index des stations est invalide.");
+
+    vector<Entree> entrees;
+    fichier.read(reinterpret_cast<char *>(&nb), sizeof(nb));
+    for (uint32_t i = 0; fichier && i < nb; ++i)
+    {
+        Entree e;
+        fichier.read(reinterpret_cast<char *>(&e.station_id), sizeof(e.station_id));
+        lireChaine(fichier, e.nom);
+        lireChaine(fichier, e.description);
+        decouper(e);
+        entrees.push_back(e);
+    }
+    vector<Noeud> trie;
+    fichier.read(reinterpret_cast<char *>(&nb), sizeof(nb));
+    for (uint32_t i = 0; fichier && i < nb; ++i)
+    {
+        Noeud n;
+        lireVecteur(fichier, n.enfants);
+        lireVecteur(fichier, n.entrees);
+        trie.push_back(n);
+    }
+    unordered_map<uint32_t, vector<unsigned int> > trigrammes;
+    fichier.read(reinterpret_cast<char *>(&nb), sizeof(nb));
+    for (uint32_t i = 0; fichier && i < nb; ++i)
+    {
+        uint32_t cle = 0;
+        fichier.read(reinterpret_cast<char *>(&cle), sizeof(cle));
+        lireVecteur(fichier, trigrammes[cle]);
+    }
+    if (!fichier || trie.empty())
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+
+    m_entrees.swap(entrees);
+    m_trie.swap(trie);
+    m_trigrammes.swap(trigrammes);
+}
+
+//! \brief découpe une fois pour toutes le nom et la description normalisés de p_entree en mots
+void IndexStations::decouper(Entree &p_entree)
+{
+    p_entree.motsNom = mots(p_entree.nom);
+    p_entree.motsDescription = mots(p_entree.description);
+}
+
+//! \brief insère les mots de p_texte dans le trie et ses trigrammes dans l'index des sous-chaînes
+void IndexStations::indexer(unsigned int p_entree, const string &p_texte, unsigned int p_champ)
+{
+    const unsigned int marque = p_entree * 2 + p_champ;
+    for (const string &mot : mots(p_texte))
+    {
+        unsigned int noeud = 0;
+        for (char c : mot)
+        {
+            auto &enfants = m_trie[noeud].enfants;
+            auto it = lower_bound(enfants.begin(), enfants.end(), make_pair((unsigned char) c, 0u));
+            if (it == enfants.end() || it->first != (unsigned char) c)
+            {
+                unsigned int nouveau = (unsigned int) m_trie.size();
+                enfants.insert(it, make_pair((unsigned char) c, nouveau));
+                m_trie.push_back(Noeud());
+                noeud = nouveau;
+            } else
+            {
+                noeud = it->second;
+            }
+        }
+        vector<unsigned int> &entrees = m_trie[noeud].entrees;
+        if (entrees.empty() || entrees.back() != marque) entrees.push_back(marque);
+    }
+    for (size_t i = 0; i + 3 <= p_texte.size(); ++i)
+    {
+        m_trigrammes[trigramme(p_texte.data() + i)].push_back(marque);
+    }
+}
+
+//! \brief retourne le noeud du trie correspondant à p_prefixe, 0 s'il n'existe pas (ou si le préfixe est vide)
+unsigned int IndexStations::noeudPrefixe(const string &p_prefixe) const
+{
+    unsigned int noeud = 0;
+    for (char c : p_prefixe)
+    {
+        const auto &enfants = m_trie[noeud].enfants;
+        auto it = lower_bound(enfants.begin(), enfants.end(), make_pair((unsigned char) c, 0u));
+        if (it == enfants.end() || it->first != (unsigned char) c) return 0;
+        noeud = it->second;
+    }
+    return noeud;
+}
+
+//! \brief ajoute à p_entrees les entrées de tous les mots du sous-arbre de p_noeud
+void IndexStations::collecter(unsigned int p_noeud, vector<unsigned int> &p_entrees) const
+{
+    vector<unsigned int> pile(1, p_noeud);
+    while (!pile.empty())
+    {
+        const Noeud &n = m_trie[pile.back()];
+        pile.pop_back();
+        p_entrees.insert(p_entrees.end(), n.entrees.begin(), n.entrees.end());
+        for (const auto &enfant : n.enfants) pile.push_back(enfant.second);
+    }
+}
+
+uint32_t IndexStations::trigramme(const char *p_texte)
+{
+    return ((uint32_t) (unsigned char) p_texte[0] << 16) | ((uint32_t) (unsigned char) p_texte[1] << 8) |
+           (uint32_t) (unsigned char) p_texte[2];
+}
@@ -0,0 +1,78 @@
+//
+// Index de recherche des stations par nom et description (autocomplétion)
+//
+
+#ifndef RTC_INDEX_STATIONS_H
+#define RTC_INDEX_STATIONS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "station.h"
+
+/*!
+ * \class IndexStations
+ * \brief Index d'autocomplétion sur Station::getNom() et Station::getDescription().
+ *
+ * Les textes sont normalisés sans accents ni majuscules (ex.: "Grande Allée Ouest / du Card.-Bégin" devient
+ * "grande allee ouest du card begin"). Chaque mot normalisé est inséré dans un trie pour la recherche par
+ * préfixe, et chaque texte est découpé en trigrammes pour la recherche de sous-chaînes. Une requête retourne
+ * les k meilleures stations, classées d'abord par la qualité de la correspondance puis par identifiant de
+ * station (stop_id). Les mots normalisés de chaque station sont découpés une seule fois, à la construction ou
+ * au chargement, pour le calcul des scores.
+ */
+class IndexStations
+{
+
+public:
+    /*!
+     * \struct Resultat
+     * \brief Une station trouvée et son score (plus grand est meilleur)
+     */
+    struct Resultat
+    {
+        unsigned int station_id;
+        int score;
+    };
+
+    IndexStations();
+    explicit IndexStations(const TableStations &p_stations);
+
+    std::vector<Resultat> rechercher(const std::string &p_requete, std::size_t p_k = 10) const;
+    std::size_t getNbStations() const;
+
+    void sauvegarder(const std::string &p_nomFichier) const;
+    void charger(const std::string &p_nomFichier);
+
+    static std::string normaliser(const std::string &p_texte);
+
+private:
+    struct Entree
+    {
+        unsigned int station_id;
+        std::string nom;         //nom normalisé
+        std::string description; //description normalisée
+        std::vector<std::string> motsNom;         //mots du nom, découpés une seule fois
+        std::vector<std::string> motsDescription; //mots de la description
+    };
+
+    struct Noeud
+    {
+        std::vector<std::pair<unsigned char, unsigned int> > enfants; //triés par caractère
+        std::vector<unsigned int> entrees; //entrées dont un mot se termine ici: indice * 2 + (1 si description)
+    };
+
+    static void decouper(Entree &p_entree);
+    void indexer(unsigned int p_entree, const std::string &p_texte, unsigned int p_champ);
+    unsigned int noeudPrefixe(const std::string &p_prefixe) const;
+    void collecter(unsigned int p_noeud, std::vector<unsigned int> &p_entrees) const;
+    static std::uint32_t trigramme(const char *p_texte);
+
+    std::vector<Entree> m_entrees;
+    std::vector<Noeud> m_trie; //la racine est m_trie[0]
+    std::unordered_map<std::uint32_t, std::vector<unsigned int> > m_trigrammes; //trigramme -> entrées (triées)
+};
+
+#endif //RTC_INDEX_STATIONS_H
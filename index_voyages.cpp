@@ -0,0 +1,78 @@
+//
+// Index par hachage des voyages, pour associer chaque ligne de stop_times.txt à son voyage en une sonde
+//
+
+#include <cstring>
+#include "index_voyages.h"
+
+using namespace std;
+
+IndexVoyages::IndexVoyages() : m_masque(0), m_nbVoyages(0)
+{
+}
+
+//! \brief indexe tous les voyages de p_voyages
+//! \param[in] p_voyages: la table indexée; ses nœuds doivent survivre à l'index
+IndexVoyages::IndexVoyages(TableVoyages &p_voyages) : m_masque(0), m_nbVoyages(p_voyages.size())
+{
+    size_t taille = 16;
+    while (taille < 2 * m_nbVoyages) taille *= 2;
+    m_cases.assign(taille, Case{0, nullptr});
+    m_masque = taille - 1;
+
+    for (TableVoyages::value_type &voyage : p_voyages)
+    {
+        const uint64_t hachage = hacher(voyage.first.data(), voyage.first.size());
+        size_t i = (size_t) hachage & m_masque;
+        while (m_cases[i].voyage) i = (i + 1) & m_masque;
+        m_cases[i].hachage = hachage;
+        m_cases[i].voyage = &voyage;
+    }
+}
+
+//! \brief cherche le voyage de trip_id [p_cle, p_cle + p_longueur)
+//! \return la paire (trip_id, Voyage) de la table indexée, nullptr si le voyage est absent
+TableVoyages::value_type *IndexVoyages::trouver(const char *p_cle, std::size_t p_longueur) const
+{
+    if (m_cases.empty()) return nullptr;
+    const uint64_t hachage = hacher(p_cle, p_longueur);
+    for (size_t i = (size_t) hachage & m_masque;; i = (i + 1) & m_masque)
+    {
+        const Case &c = m_cases[i];
+        if (!c.voyage) return nullptr;
+        if (c.hachage == hachage && c.voyage->first.size() == p_longueur &&
+            memcmp(c.voyage->first.data(), p_cle, p_longueur) == 0)
+            return c.voyage;
+    }
+}
+
+TableVoyages::value_type *IndexVoyages::trouver(const std::string &p_cle) const
+{
+    return trouver(p_cle.data(), p_cle.size());
+}
+
+std::size_t IndexVoyages::getNbVoyages() const
+{
+    return m_nbVoyages;
+}
+
+bool IndexVoyages::estVide() const
+{
+    return m_nbVoyages == 0;
+}
+
+//! \brief hachage FNV-1a sur 64 bits, suivi d'un brassage pour que les bits faibles, qui choisissent la case,
+//! \brief dépendent de tous les caractères
+std::uint64_t IndexVoyages::hacher(const char *p_cle, std::size_t p_longueur)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < p_longueur; ++i)
+    {
+        h ^= (unsigned char) p_cle[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
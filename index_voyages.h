@@ -0,0 +1,50 @@
+//
+// Index par hachage des voyages, pour associer chaque ligne de stop_times.txt à son voyage en une sonde
+//
+
+#ifndef RTC_INDEX_VOYAGES_H
+#define RTC_INDEX_VOYAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "voyage.h"
+
+/*!
+ * \class IndexVoyages
+ * \brief Table à adressage ouvert (sondage linéaire) des nœuds d'une TableVoyages, indexés par trip_id.
+ *
+ * Chaque case garde le hachage complet de sa clé: une sonde ne compare les caractères que si les hachages sont
+ * égaux. La recherche accepte une clé quelconque (pointeur et longueur), par exemple un champ de LecteurCSV, sans
+ * construire de std::string. L'index pointe dans les nœuds de la table, qui restent stables; il doit être
+ * reconstruit lorsqu'un voyage est ajouté ou enlevé. L'ordre des trip_id reste celui de la TableVoyages elle-même.
+ */
+class IndexVoyages
+{
+
+public:
+    IndexVoyages();
+    explicit IndexVoyages(TableVoyages &p_voyages);
+
+    TableVoyages::value_type *trouver(const char *p_cle, std::size_t p_longueur) const;
+    TableVoyages::value_type *trouver(const std::string &p_cle) const;
+
+    std::size_t getNbVoyages() const;
+    bool estVide() const;
+
+    static std::uint64_t hacher(const char *p_cle, std::size_t p_longueur);
+
+private:
+    struct Case
+    {
+        std::uint64_t hachage;
+        TableVoyages::value_type *voyage; //nullptr si la case est libre
+    };
+
+    std::vector<Case> m_cases; //taille: une puissance de 2, au moins le double du nombre de voyages
+    std::size_t m_masque;
+    std::size_t m_nbVoyages;
+};
+
+#endif //RTC_INDEX_VOYAGES_H
@@ -0,0 +1,153 @@
+//
+// Mesures des phases de chargement de DonneesGTFS (retirables à la compilation)
+//
+
+#include <atomic>
+#include <sstream>
+#include "instrumentation.h"
+
+using namespace std;
+
+namespace
+{
+    atomic<unsigned long long> g_nbAllocations(0);
+
+    void ecrireMetrique(ostringstream &p_sortie, const vector<StatistiquesPhase> &p_phases, const char *p_nom,
+                        const char *p_aide, const char *p_type, double (*p_valeur)(const StatistiquesPhase &))
+    {
+        p_sortie << "# HELP " << p_nom << " " << p_aide << "\n";
+        p_sortie << "# TYPE " << p_nom << " " << p_type << "\n";
+        for (const StatistiquesPhase &phase : p_phases)
+        {
+            p_sortie << p_nom << "{phase=\"" << phase.nom << "\"} " << p_valeur(phase) << "\n";
+        }
+    }
+}
+
+//! \brief ajoute les mesures d'une phase à celles déjà enregistrées sous le même nom
+void StatistiquesChargement::ajouter(const StatistiquesPhase &p_phase)
+{
+    for (StatistiquesPhase &phase : m_phases)
+    {
+        if (phase.nom == p_phase.nom)
+        {
+            phase.millisecondes += p_phase.millisecondes;
+            phase.appels += p_phase.appels;
+            phase.lignesLues += p_phase.lignesLues;
+            phase.lignesRetenues += p_phase.lignesRetenues;
+            phase.octetsLus += p_phase.octetsLus;
+            phase.allocations += p_phase.allocations;
+            return;
+        }
+    }
+    m_phases.push_back(p_phase);
+}
+
+void StatistiquesChargement::vider()
+{
+    m_phases.clear();
+}
+
+const vector<StatistiquesPhase> &StatistiquesChargement::getPhases() const
+{
+    return m_phases;
+}
+
+//! \brief retourne la phase de ce nom, ou nullptr si elle n'a jamais été exécutée
+const StatistiquesPhase *StatistiquesChargement::trouver(const string &p_nom) const
+{
+    for (const StatistiquesPhase &phase : m_phases)
+    {
+        if (phase.nom == p_nom) return &phase;
+    }
+    return nullptr;
+}
+
+//! \brief retourne les phases sous la forme d'un objet JSON {"instrumentation": ..., "phases": [...]}
+string StatistiquesChargement::enJSON() const
+{
+    ostringstream sortie;
+    sortie << "{\"instrumentation\": " << (estActive() ? "true" : "false") << ", \"phases\": [";
+    for (size_t i = 0; i < m_phases.size(); ++i)
+    {
+        const StatistiquesPhase &p = m_phases[i];
+        sortie << (i ? ", " : "") << "{\"nom\": \"" << p.nom << "\", \"millisecondes\": " << p.millisecondes
+               << ", \"appels\": " << p.appels << ", \"lignes_lues\": " << p.lignesLues
+               << ", \"lignes_retenues\": " << p.lignesRetenues << ", \"octets_lus\": " << p.octetsLus
+               << ", \"allocations\": " << p.allocations << "}";
+    }
+    sortie << "]}";
+    return sortie.str();
+}
+
+//! \brief retourne les phases au format d'exposition texte de Prometheus, une série par phase et par mesure
+string StatistiquesChargement::enPrometheus() const
+{
+    ostringstream sortie;
+    ecrireMetrique(sortie, m_phases, "rtc_chargement_secondes", "Duree cumulee de la phase de chargement.", "gauge",
+                   [](const StatistiquesPhase &p) { return p.millisecondes / 1000.0; });
+    ecrireMetrique(sortie, m_phases, "rtc_chargement_lignes_lues_total", "Lignes de donnees lues.", "counter",
+                   [](const StatistiquesPhase &p) { return (double) p.lignesLues; });
+    ecrireMetrique(sortie, m_phases, "rtc_chargement_lignes_retenues_total", "Lignes ayant produit un objet.",
+                   "counter", [](const StatistiquesPhase &p) { return (double) p.lignesRetenues; });
+    ecrireMetrique(sortie, m_phases, "rtc_chargement_octets_lus_total", "Octets lus.", "counter",
+                   [](const StatistiquesPhase &p) { return (double) p.octetsLus; });
+    ecrireMetrique(sortie, m_phases, "rtc_chargement_allocations_total", "Allocations pendant la phase.", "counter",
+                   [](const StatistiquesPhase &p) { return (double) p.allocations; });
+    return sortie.str();
+}
+
+//! \brief indique si la bibliothèque a été compilée avec RTC_INSTRUMENTATION
+bool StatistiquesChargement::estActive()
+{
+#ifdef RTC_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+//! \brief retourne le nombre d'appels à operator new depuis le début du programme
+//! \brief (toujours 0 si le programme n'est pas lié avec compteur_allocations.cpp)
+unsigned long long StatistiquesChargement::getNbAllocations()
+{
+    return g_nbAllocations.load(memory_order_relaxed);
+}
+
+//! \brief compte une allocation; appelée par l'operator new de compteur_allocations.cpp
+void StatistiquesChargement::compterAllocation()
+{
+    g_nbAllocations.fetch_add(1, memory_order_relaxed);
+}
+
+ChronometrePhase::ChronometrePhase(StatistiquesChargement &p_statistiques, const char *p_nom)
+        : m_statistiques(p_statistiques)
+{
+    commencer(p_nom);
+}
+
+ChronometrePhase::~ChronometrePhase()
+{
+    terminer();
+}
+
+//! \brief termine la phase en cours et commence la phase p_nom
+void ChronometrePhase::suivante(const char *p_nom)
+{
+    terminer();
+    commencer(p_nom);
+}
+
+void ChronometrePhase::commencer(const char *p_nom)
+{
+    m_phase = StatistiquesPhase{p_nom, 0.0, 1, 0, 0, 0, 0};
+    m_allocationsDebut = StatistiquesChargement::getNbAllocations();
+    m_debut = chrono::steady_clock::now();
+}
+
+void ChronometrePhase::terminer()
+{
+    m_phase.millisecondes = chrono::duration<double, milli>(chrono::steady_clock::now() - m_debut).count();
+    m_phase.allocations = StatistiquesChargement::getNbAllocations() - m_allocationsDebut;
+    m_statistiques.ajouter(m_phase);
+}
@@ -0,0 +1,118 @@
+//
+// Mesures des phases de chargement de DonneesGTFS (retirables à la compilation)
+//
+
+#ifndef RTC_INSTRUMENTATION_H
+#define RTC_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+ * \struct StatistiquesPhase
+ * \brief Mesures cumulées d'une phase de chargement (ex.: "arrets.lecture", "arrets.suppression_stations")
+ */
+struct StatistiquesPhase
+{
+    std::string nom;
+    double millisecondes;
+    unsigned long long appels;          //nombre d'exécutions de la phase
+    unsigned long long lignesLues;      //lignes de données lues (sans l'en-tête)
+    unsigned long long lignesRetenues;  //lignes ayant produit un objet
+    unsigned long long octetsLus;
+    unsigned long long allocations;     //appels à operator new pendant la phase, tous fils confondus (voir
+                                        //StatistiquesChargement::getNbAllocations)
+};
+
+/*!
+ * \class StatistiquesChargement
+ * \brief Mesures par phase, dans l'ordre de première exécution, exportables en JSON ou au format texte Prometheus.
+ *
+ * Les phases de même nom s'additionnent, par exemple lorsqu'un fichier est ajouté deux fois.
+ * Les allocations ne sont comptées que dans un programme lié avec compteur_allocations.cpp (le banc d'essai),
+ * qui remplace l'operator new global; la bibliothèque ne le remplace pas.
+ */
+class StatistiquesChargement
+{
+
+public:
+    void ajouter(const StatistiquesPhase &p_phase);
+    void vider();
+
+    const std::vector<StatistiquesPhase> &getPhases() const;
+    const StatistiquesPhase *trouver(const std::string &p_nom) const;
+
+    std::string enJSON() const;
+    std::string enPrometheus() const;
+
+    static bool estActive();
+    static unsigned long long getNbAllocations();
+    static void compterAllocation();
+
+private:
+    std::vector<StatistiquesPhase> m_phases;
+};
+
+/*!
+ * \class ChronometrePhase
+ * \brief Mesure la phase en cours jusqu'à sa destruction ou jusqu'au passage à la phase suivante.
+ *
+ * S'utilise par les macros RTC_PHASE, RTC_PHASE_SUIVANTE, RTC_LIGNE_LUE, RTC_LIGNES_LUES et RTC_LIGNE_RETENUE, qui
+ * ne produisent aucun code lorsque RTC_INSTRUMENTATION n'est pas défini.
+ */
+class ChronometrePhase
+{
+
+public:
+    ChronometrePhase(StatistiquesChargement &p_statistiques, const char *p_nom);
+    ~ChronometrePhase();
+
+    void suivante(const char *p_nom);
+
+    void ligneLue(std::size_t p_octets)
+    {
+        ++m_phase.lignesLues;
+        m_phase.octetsLus += p_octets;
+    }
+
+    void lignesLues(unsigned long long p_lignes, unsigned long long p_octets)
+    {
+        m_phase.lignesLues += p_lignes;
+        m_phase.octetsLus += p_octets;
+    }
+
+    void ligneRetenue()
+    {
+        ++m_phase.lignesRetenues;
+    }
+
+private:
+    ChronometrePhase(const ChronometrePhase &);
+    ChronometrePhase &operator=(const ChronometrePhase &);
+
+    void commencer(const char *p_nom);
+    void terminer();
+
+    StatistiquesChargement &m_statistiques;
+    StatistiquesPhase m_phase;
+    std::chrono::steady_clock::time_point m_debut;
+    unsigned long long m_allocationsDebut;
+};
+
+#ifdef RTC_INSTRUMENTATION
+#define RTC_PHASE(chrono, statistiques, nom) ChronometrePhase chrono(statistiques, nom)
+#define RTC_PHASE_SUIVANTE(chrono, nom) chrono.suivante(nom)
+#define RTC_LIGNE_LUE(chrono, octets) chrono.ligneLue(octets)
+#define RTC_LIGNES_LUES(chrono, lignes, octets) chrono.lignesLues(lignes, octets)
+#define RTC_LIGNE_RETENUE(chrono) chrono.ligneRetenue()
+#else
+#define RTC_PHASE(chrono, statistiques, nom) ((void) (statistiques))
+#define RTC_PHASE_SUIVANTE(chrono, nom) ((void) 0)
+#define RTC_LIGNE_LUE(chrono, octets) ((void) 0)
+#define RTC_LIGNES_LUES(chrono, lignes, octets) ((void) 0)
+#define RTC_LIGNE_RETENUE(chrono) ((void) 0)
+#endif
+
+#endif //RTC_INSTRUMENTATION_H
@@ -0,0 +1,118 @@
+//
+// Lecture rapide des fichiers GTFS: projection des colonnes et filtrage des lignes avant découpage
+//
+
+#include "lecteur_csv.h"
+
+using namespace std;
+
+//! \brief prépare la lecture et lit la ligne d'en-tête
+//! \param[in] p_flux: le flux, positionné au début de l'en-tête
+//! \param[in] p_derniereColonne: la dernière colonne utile; les colonnes suivantes ne sont jamais découpées
+//! \param[in] p_tailleBloc: la taille des lectures dans p_flux (le tampon grandit pour les lignes plus longues)
+LecteurCSV::LecteurCSV(std::istream &p_flux, unsigned int p_derniereColonne, std::size_t p_tailleBloc)
+        : m_flux(p_flux), m_tampon(p_tailleBloc), m_debut(0), m_fin(0), m_finFlux(false), m_curseur(nullptr),
+          m_finLigne(nullptr), m_nbChamps(0), m_champs(p_derniereColonne + 1), m_nbLignes(0), m_nbOctets(0)
+{
+    if (prochaineLigne())
+    {
+        m_entete.assign(m_curseur, m_finLigne);
+        m_nbLignes = 0;
+        m_nbOctets = 0;
+    }
+}
+
+const std::string &LecteurCSV::getEntete() const
+{
+    return m_entete;
+}
+
+//! \brief change la dernière colonne découpée (ex.: une fois les colonnes utiles trouvées dans l'en-tête)
+void LecteurCSV::setDerniereColonne(unsigned int p_derniereColonne)
+{
+    m_champs.resize(p_derniereColonne + 1);
+    m_nbChamps = 0;
+}
+
+//! \brief passe à la prochaine ligne et découpe ses colonnes 0 à p_derniereColonne
+//! \return false à la fin du flux
+bool LecteurCSV::suivante()
+{
+    if (!prochaineLigne()) return false;
+    decouper((unsigned int) m_champs.size() - 1);
+    return true;
+}
+
+//! \brief retourne le nombre de lignes de données parcourues, gardées ou non
+unsigned long long LecteurCSV::getNbLignes() const
+{
+    return m_nbLignes;
+}
+
+//! \brief retourne le nombre d'octets des lignes de données parcourues, fins de ligne comprises
+unsigned long long LecteurCSV::getNbOctets() const
+{
+    return m_nbOctets;
+}
+
+//! \brief délimite la prochaine ligne (recherche de '\n' par memchr); comme getline, une dernière ligne sans
+//! \brief fin de ligne est lue, mais pas la ligne vide qui suit le dernier '\n'
+bool LecteurCSV::prochaineLigne()
+{
+    size_t recherche = m_debut;
+    for (;;)
+    {
+        const char *nl = static_cast<const char *>(memchr(&m_tampon[0] + recherche, '\n', m_fin - recherche));
+        if (nl || (m_finFlux && m_debut < m_fin))
+        {
+            m_curseur = &m_tampon[0] + m_debut;
+            m_finLigne = nl ? nl : &m_tampon[0] + m_fin;
+            m_debut = (size_t) (m_finLigne - &m_tampon[0]) + (nl ? 1 : 0);
+            m_nbChamps = 0;
+            ++m_nbLignes;
+            m_nbOctets += (unsigned long long) (m_finLigne - m_curseur) + 1;
+            return true;
+        }
+        if (m_finFlux) return false;
+        recherche = m_fin - m_debut;
+        if (!remplir()) recherche = 0;
+    }
+}
+
+//! \brief déplace la partie non lue au début du tampon et le complète depuis le flux
+//! \return false si aucun octet n'a pu être ajouté
+bool LecteurCSV::remplir()
+{
+    if (m_debut > 0)
+    {
+        memmove(&m_tampon[0], &m_tampon[0] + m_debut, m_fin - m_debut);
+        m_fin -= m_debut;
+        m_debut = 0;
+    }
+    if (m_fin == m_tampon.size()) m_tampon.resize(m_tampon.size() * 2);
+    m_flux.read(&m_tampon[0] + m_fin, (streamsize) (m_tampon.size() - m_fin));
+    const size_t lus = (size_t) m_flux.gcount();
+    m_fin += lus;
+    if (lus == 0 || !m_flux) m_finFlux = true;
+    return lus > 0;
+}
+
+//! \brief découpe les champs de la ligne courante jusqu'à p_colonne; les colonnes absentes sont vides
+void LecteurCSV::decouper(unsigned int p_colonne)
+{
+    while (m_nbChamps <= p_colonne)
+    {
+        Champ &champ = m_champs[m_nbChamps++];
+        if (m_curseur > m_finLigne)
+        {
+            champ.debut = m_finLigne;
+            champ.longueur = 0;
+            continue;
+        }
+        const char *virgule = static_cast<const char *>(memchr(m_curseur, ',', (size_t) (m_finLigne - m_curseur)));
+        const char *finChamp = virgule ? virgule : m_finLigne;
+        champ.debut = m_curseur;
+        champ.longueur = (size_t) (finChamp - m_curseur);
+        m_curseur = finChamp + 1;
+    }
+}
@@ -0,0 +1,105 @@
+//
+// Lecture rapide des fichiers GTFS: projection des colonnes et filtrage des lignes avant découpage
+//
+
+#ifndef RTC_LECTEUR_CSV_H
+#define RTC_LECTEUR_CSV_H
+
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+/*!
+ * \class LecteurCSV
+ * \brief Parcourt un flux CSV par blocs, sans copier les lignes ni les champs.
+ *
+ * Seules les colonnes 0 à p_derniereColonne sont découpées; le reste de chaque ligne n'est jamais examiné champ
+ * par champ. Avec un prédicat sur une colonne clé, la ligne est découpée seulement jusqu'à cette colonne, puis
+ * abandonnée (la fin de ligne est trouvée par memchr) si le prédicat la rejette, sans qu'aucun champ ne soit
+ * converti. Le découpage est celui de DonneesGTFS::string_to_vector: chaque virgule sépare deux champs, et les
+ * guillemets et '\r' restent dans les champs.
+ */
+class LecteurCSV
+{
+
+public:
+    /*!
+     * \struct Champ
+     * \brief Un champ de la ligne courante; valide jusqu'à l'appel suivant de suivante()
+     */
+    struct Champ
+    {
+        const char *debut;
+        std::size_t longueur;
+
+        std::string str() const
+        {
+            return std::string(debut, longueur);
+        }
+    };
+
+    LecteurCSV(std::istream &p_flux, unsigned int p_derniereColonne, std::size_t p_tailleBloc = 1 << 20);
+
+    const std::string &getEntete() const;
+    void setDerniereColonne(unsigned int p_derniereColonne);
+
+    bool suivante();
+    template<typename Predicat>
+    bool suivante(unsigned int p_colonneCle, Predicat p_garder);
+
+    const Champ &operator[](unsigned int p_colonne) const
+    {
+        return m_champs[p_colonne];
+    }
+
+    std::string chaine(unsigned int p_colonne) const
+    {
+        return m_champs[p_colonne].str();
+    }
+
+    unsigned long long getNbLignes() const;
+    unsigned long long getNbOctets() const;
+
+private:
+    bool prochaineLigne();
+    void decouper(unsigned int p_colonne);
+    bool remplir();
+
+    std::istream &m_flux;
+    std::vector<char> m_tampon;
+    std::size_t m_debut;        //début de la partie non lue de m_tampon
+    std::size_t m_fin;          //fin des données valides de m_tampon
+    bool m_finFlux;
+    std::string m_entete;
+
+    const char *m_curseur;      //prochain champ à découper dans la ligne courante
+    const char *m_finLigne;     //fin de la ligne courante (sans le '\n')
+    unsigned int m_nbChamps;    //nombre de champs déjà découpés dans la ligne courante
+    std::vector<Champ> m_champs;
+
+    unsigned long long m_nbLignes;
+    unsigned long long m_nbOctets;
+};
+
+//! \brief passe à la prochaine ligne pour laquelle p_garder(champ de la colonne clé) est vrai
+//! \param[in] p_colonneCle: la colonne examinée par le prédicat; doit être au plus p_derniereColonne
+//! \param[in] p_garder: prédicat appelé avec le Champ de la colonne clé, avant le découpage du reste de la ligne
+//! \return false à la fin du flux
+template<typename Predicat>
+bool LecteurCSV::suivante(unsigned int p_colonneCle, Predicat p_garder)
+{
+    while (prochaineLigne())
+    {
+        decouper(p_colonneCle);
+        if (p_garder(m_champs[p_colonneCle]))
+        {
+            decouper((unsigned int) m_champs.size() - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif //RTC_LECTEUR_CSV_H
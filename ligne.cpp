@@ -37,24 +37,39 @@ Ligne::Ligne() : m_id(), m_numero(""), m_description(""), m_categorie(CategorieB
 CategorieBus Ligne::couleurToCategorie(const std::string &couleur)
 {
     CategorieBus c;
+    if (!couleurConnue(couleur, c))
+    {
+        std::cout << couleur << std::endl;
+        throw std::logic_error("Couleur " + couleur + " non répertorié");
+    }
+    return c;
+}
+
+/*!
+ * \brief Comme couleurToCategorie, mais sans lever d'exception ni rien afficher
+ * \param[in] couleur: La couleur d'intérêt
+ * \param[out] p_categorie: La catégorie déduite, inchangée si la couleur est inconnue
+ * \return True ssi la couleur correspond à une catégorie de bus
+ */
+bool Ligne::couleurConnue(const std::string &couleur, CategorieBus &p_categorie)
+{
     if (couleur == "97BF0D")
     {
-        c = CategorieBus::METRO_BUS;
+        p_categorie = CategorieBus::METRO_BUS;
     } else if (couleur == "013888")
     {
-        c = CategorieBus::LEBUS;
+        p_categorie = CategorieBus::LEBUS;
     } else if (couleur == "E04503")
     {
-        c = CategorieBus::EXPRESS;
+        p_categorie = CategorieBus::EXPRESS;
     } else if ((couleur == "1A171B") || (couleur == "003888"))
     {
-        c = CategorieBus::COUCHE_TARD;
+        p_categorie = CategorieBus::COUCHE_TARD;
     } else
     {
-        std::cout << couleur << std::endl;
-        throw std::logic_error("Couleur " + couleur + " non répertorié");
+        return false;
     }
-    return c;
+    return true;
 }
 
 /*!
@@ -37,6 +37,7 @@ public:
     Ligne(unsigned int p_id, const std::string & p_numero, const std::string & p_description, const CategorieBus& p_categorie);
 	Ligne();
     static CategorieBus couleurToCategorie(const std::string & couleur);
+    static bool couleurConnue(const std::string & couleur, CategorieBus & p_categorie);
     static std::string categorieToString(const CategorieBus & c);
 	CategorieBus getCategorie() const;
 	unsigned int getId() const;
@@ -0,0 +1,405 @@
+//
+// Découpage géographique du réseau en cellules interrogées séparément
+//
+
+#include "partition_reseau.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+using namespace std;
+
+const unsigned int PartitionReseau::INFINI = numeric_limits<unsigned int>::max();
+
+PartitionReseau::EtatRecherche::EtatRecherche()
+{
+}
+
+/*!
+ * \brief prépare les étiquettes pour une nouvelle requête
+ * \brief seules les stations frontières touchées par la requête précédente sont remises à l'infini
+ */
+void PartitionReseau::EtatRecherche::preparer(size_t p_nbFrontieres, size_t p_nbCellules)
+{
+    if (m_arrivee.size() != p_nbFrontieres)
+    {
+        m_arrivee.assign(p_nbFrontieres, INFINI);
+        m_arriveeAssise.assign(p_nbFrontieres, INFINI);
+        m_enAttente.assign(p_nbFrontieres, 0);
+        m_nouvelle.assign(p_nbFrontieres, 0);
+    } else
+    {
+        for (unsigned int f : m_touchees)
+        {
+            m_arrivee[f] = INFINI;
+            m_arriveeAssise[f] = INFINI;
+            m_enAttente[f] = 0;
+            m_nouvelle[f] = 0;
+        }
+    }
+    m_touchees.clear();
+    m_aRelayer.clear();
+    m_nouvelles.resize(p_nbCellules);
+    for (auto &nouvelles : m_nouvelles) nouvelles.clear();
+    m_cellules.resize(p_nbCellules);
+}
+
+/*!
+ * \brief découpe les stations de p_donnees en cellules et construit un planificateur par cellule,
+ * \brief puis la surcouche des liens entre cellules
+ * \param[in] p_donnees: les données GTFS; tous les arrêts et transferts doivent avoir été ajoutés
+ * \param[in] p_nbCellules: le nombre de cellules voulu (au moins 1)
+ * \throws logic_error si p_nbCellules est nul
+ */
+PartitionReseau::PartitionReseau(const DonneesGTFS &p_donnees, unsigned int p_nbCellules)
+        : m_nbCellules(p_nbCellules)
+{
+    if (p_nbCellules == 0)
+        throw logic_error("PartitionReseau: il faut au moins une cellule");
+
+    StationsPlacees stations;
+    stations.reserve(p_donnees.getNbStations());
+    for (const auto &stationM : p_donnees.getStations())
+        stations.push_back(make_pair(stationM.first, stationM.second.getCoords()));
+    decouper(stations.begin(), stations.end(), 0, m_nbCellules);
+
+    m_planificateurs.reserve(m_nbCellules);
+    for (unsigned int c = 0; c < m_nbCellules; ++c)
+    {
+        m_planificateurs.emplace_back(p_donnees, [this, c](unsigned int p_station_id)
+        {
+            unsigned int cellule;
+            return getCellule(p_station_id, cellule) && cellule == c;
+        });
+    }
+
+    construireSurcouche(p_donnees);
+}
+
+/*!
+ * \brief découpage k-d: coupe [p_debut, p_fin) à la médiane de l'axe le plus étendu, en proportion du nombre
+ * \brief de cellules de chaque côté, et recommence de chaque côté
+ */
+void PartitionReseau::decouper(StationsPlacees::iterator p_debut, StationsPlacees::iterator p_fin,
+                               unsigned int p_premiereCellule, unsigned int p_nbCellules)
+{
+    const size_t nb = (size_t) (p_fin - p_debut);
+    if (p_nbCellules <= 1 || nb <= 1)
+    {
+        for (auto it = p_debut; it != p_fin; ++it) m_cellules[it->first] = p_premiereCellule;
+        return;
+    }
+
+    int32_t latMin = numeric_limits<int32_t>::max(), latMax = numeric_limits<int32_t>::min();
+    int32_t lonMin = latMin, lonMax = latMax;
+    for (auto it = p_debut; it != p_fin; ++it)
+    {
+        latMin = min(latMin, it->second.getLatitudeMicrodegres());
+        latMax = max(latMax, it->second.getLatitudeMicrodegres());
+        lonMin = min(lonMin, it->second.getLongitudeMicrodegres());
+        lonMax = max(lonMax, it->second.getLongitudeMicrodegres());
+    }
+    // Un degré de longitude rétrécit comme le cosinus de la latitude
+    const double latMoyenne = ((double) latMin + latMax) / 2e6 * 3.14159265358979323846 / 180.0;
+    const double etendueLongitude = ((double) lonMax - lonMin) * cos(latMoyenne);
+    const double etendueLatitude = (double) latMax - latMin;
+    const bool selonLongitude = etendueLongitude > etendueLatitude;
+
+    const unsigned int nbGauche = p_nbCellules / 2;
+    auto milieu = p_debut + (ptrdiff_t) (nb * nbGauche / p_nbCellules);
+    nth_element(p_debut, milieu, p_fin, [selonLongitude](const pair<unsigned int, Coordonnees> &a,
+                                                         const pair<unsigned int, Coordonnees> &b)
+    {
+        const int32_t va = selonLongitude ? a.second.getLongitudeMicrodegres() : a.second.getLatitudeMicrodegres();
+        const int32_t vb = selonLongitude ? b.second.getLongitudeMicrodegres() : b.second.getLatitudeMicrodegres();
+        return va < vb || (va == vb && a.first < b.first);
+    });
+    decouper(p_debut, milieu, p_premiereCellule, nbGauche);
+    decouper(milieu, p_fin, p_premiereCellule + nbGauche, p_nbCellules - nbGauche);
+}
+
+//! \brief numérote une station frontière, si elle ne l'est pas déjà
+unsigned int PartitionReseau::ajouterFrontiere(unsigned int p_station_id)
+{
+    auto it = m_indexFrontieres.find(p_station_id);
+    if (it != m_indexFrontieres.end()) return it->second;
+
+    unsigned int index = (unsigned int) m_stationsFrontieres.size();
+    m_indexFrontieres.insert({p_station_id, index});
+    m_stationsFrontieres.push_back(p_station_id);
+    m_celluleFrontiere.push_back(m_cellules.at(p_station_id));
+    return index;
+}
+
+/*!
+ * \brief relève les connexions, les enchaînements de bloc et les transferts à pied qui changent de cellule;
+ * \brief leurs extrémités sont les stations frontières
+ */
+void PartitionReseau::construireSurcouche(const DonneesGTFS &p_donnees)
+{
+    vector<tuple<unsigned int, unsigned int, unsigned int> > liens; //(de, départ, index dans m_liens)
+    vector<Lien> liensBruts;
+    auto ajouterLien = [&](unsigned int p_de, unsigned int p_vers, unsigned int p_depart, unsigned int p_arrivee)
+    {
+        unsigned int cde, cvers;
+        if (!getCellule(p_de, cde) || !getCellule(p_vers, cvers) || cde == cvers) return;
+        unsigned int de = ajouterFrontiere(p_de);
+        Lien l = {ajouterFrontiere(p_vers), p_depart, max(p_depart, p_arrivee)};
+        liens.push_back(make_tuple(de, p_depart, (unsigned int) liensBruts.size()));
+        liensBruts.push_back(l);
+    };
+
+    for (const auto &voyageM : p_donnees.getVoyages())
+    {
+        const Voyage &voyage = voyageM.second;
+        Arret precedent; //copie: la vue des arrêts réutilise l'arrêt courant
+        bool aucun = true;
+        for (const Arret &a : voyage.getArrets())
+        {
+            if (!aucun)
+                ajouterLien(precedent.getStationId(), a.getStationId(),
+                            precedent.getHeureDepart().getSecondesDepuisMinuit(),
+                            a.getHeureArrivee().getSecondesDepuisMinuit());
+            precedent = a;
+            aucun = false;
+        }
+
+        const Voyage *suivant = voyage.getVoyageSuivant();
+        if (!aucun && suivant && suivant->getNbArrets() > 0)
+        {
+            const Arret premier = suivant->getArret(0);
+            ajouterLien(precedent.getStationId(), premier.getStationId(),
+                        precedent.getHeureArrivee().getSecondesDepuisMinuit(),
+                        premier.getHeureArrivee().getSecondesDepuisMinuit());
+        }
+    }
+
+    vector<tuple<unsigned int, unsigned int, unsigned int> > marches; //(de, vers, durée)
+    for (const auto &t : p_donnees.getTransferts())
+    {
+        unsigned int cde, cvers;
+        if (!getCellule(get<0>(t), cde) || !getCellule(get<1>(t), cvers) || cde == cvers) continue;
+        unsigned int de = ajouterFrontiere(get<0>(t));
+        marches.push_back(make_tuple(de, ajouterFrontiere(get<1>(t)), get<2>(t)));
+    }
+
+    // Rangement par station frontière de départ (format CSR), les liens par heure de départ
+    const size_t nbFrontieres = m_stationsFrontieres.size();
+    sort(liens.begin(), liens.end());
+    m_liens.reserve(liens.size());
+    m_debutLiens.assign(nbFrontieres + 1, 0);
+    for (const auto &l : liens)
+    {
+        m_liens.push_back(liensBruts[get<2>(l)]);
+        ++m_debutLiens[get<0>(l) + 1];
+    }
+    sort(marches.begin(), marches.end());
+    m_marches.reserve(marches.size());
+    m_debutMarches.assign(nbFrontieres + 1, 0);
+    for (const auto &m : marches)
+    {
+        Marche marche = {get<1>(m), get<2>(m)};
+        m_marches.push_back(marche);
+        ++m_debutMarches[get<0>(m) + 1];
+    }
+    for (size_t f = 0; f < nbFrontieres; ++f)
+    {
+        m_debutLiens[f + 1] += m_debutLiens[f];
+        m_debutMarches[f + 1] += m_debutMarches[f];
+    }
+
+    m_frontieresParCellule.assign(m_nbCellules, vector<unsigned int>());
+    for (unsigned int f = 0; f < nbFrontieres; ++f)
+        m_frontieresParCellule[m_celluleFrontiere[f]].push_back(f);
+}
+
+//! \brief calcule un trajet avec un état de recherche temporaire
+ResultatOD PartitionReseau::calculerTrajet(const RequeteOD &p_requete) const
+{
+    EtatRecherche etat;
+    return calculerTrajet(p_requete, etat);
+}
+
+/*!
+ * \brief calcule l'heure d'arrivée au plus tôt à la destination de p_requete
+ * \brief Les cellules sont explorées tour à tour: une cellule l'est de nouveau chaque fois qu'une de ses stations
+ * \brief frontières est atteinte plus tôt par la surcouche, jusqu'à ce que plus rien ne s'améliore.
+ * \param[in] p_requete: la requête
+ * \param[in,out] p_etat: les étiquettes de travail, réutilisées d'une requête à l'autre par le même fil
+ * \return le résultat; trouve est faux si l'origine ou la destination est inconnue ou inatteignable
+ */
+ResultatOD PartitionReseau::calculerTrajet(const RequeteOD &p_requete, EtatRecherche &p_etat) const
+{
+    ResultatOD resultat = {false, Heure(0, 0, 0)};
+    p_etat.preparer(m_stationsFrontieres.size(), m_nbCellules);
+
+    unsigned int celluleOrigine, celluleDestination;
+    if (!getCellule(p_requete.origine, celluleOrigine) || !getCellule(p_requete.destination, celluleDestination))
+        return resultat;
+
+    auto itDestination = m_indexFrontieres.find(p_requete.destination);
+    const unsigned int destination = itDestination == m_indexFrontieres.end() ? INFINI : itDestination->second;
+    const bool marche = !(p_requete.profil & PROFIL_SANS_MARCHE);
+    unsigned int meilleure = INFINI;
+
+    p_etat.m_sources.clear();
+    SourceExploration origine = {p_requete.origine, p_requete.depart, true};
+    p_etat.m_sources.push_back(origine);
+    explorerCellule(celluleOrigine, p_requete, destination, meilleure, p_etat);
+
+    bool aExplorer = true;
+    while (aExplorer)
+    {
+        aExplorer = false;
+        while (!p_etat.m_aRelayer.empty())
+        {
+            const unsigned int f = p_etat.m_aRelayer.back();
+            p_etat.m_aRelayer.pop_back();
+            p_etat.m_enAttente[f] = 0;
+            relayer(f, marche, destination, meilleure, p_etat);
+        }
+        for (unsigned int c = 0; c < m_nbCellules; ++c)
+        {
+            if (p_etat.m_nouvelles[c].empty()) continue;
+            aExplorer = true;
+            p_etat.m_sources.clear();
+            for (unsigned int f : p_etat.m_nouvelles[c])
+            {
+                p_etat.m_nouvelle[f] = 0;
+                const unsigned int assise = p_etat.m_arriveeAssise[f], arrivee = p_etat.m_arrivee[f];
+                if (assise < meilleure)
+                {
+                    SourceExploration source = {m_stationsFrontieres[f], Heure(0, 0, 0).add_secondes(assise), true};
+                    p_etat.m_sources.push_back(source);
+                }
+                if (arrivee < min(assise, meilleure))
+                {
+                    SourceExploration source = {m_stationsFrontieres[f], Heure(0, 0, 0).add_secondes(arrivee), false};
+                    p_etat.m_sources.push_back(source);
+                }
+            }
+            p_etat.m_nouvelles[c].clear();
+            if (!p_etat.m_sources.empty())
+                explorerCellule(c, p_requete, destination, meilleure, p_etat);
+        }
+    }
+
+    if (meilleure != INFINI)
+    {
+        resultat.trouve = true;
+        resultat.arrivee = Heure(0, 0, 0).add_secondes(meilleure);
+    }
+    return resultat;
+}
+
+/*!
+ * \brief explore une cellule à partir de p_etat.m_sources, puis reporte l'arrivée à la destination et les
+ * \brief étiquettes de ses stations frontières
+ */
+void PartitionReseau::explorerCellule(unsigned int p_cellule, const RequeteOD &p_requete,
+                                      unsigned int p_destination, unsigned int &p_meilleure,
+                                      EtatRecherche &p_etat) const
+{
+    const Planificateur &planificateur = m_planificateurs[p_cellule];
+    Planificateur::EtatRecherche &etatCellule = p_etat.m_cellules[p_cellule];
+    planificateur.explorer(p_etat.m_sources, p_requete.destination, p_requete.profil,
+                           Heure(0, 0, 0).add_secondes(p_meilleure), etatCellule);
+
+    Heure h;
+    if (planificateur.getArrivee(etatCellule, p_requete.destination, h))
+        p_meilleure = min(p_meilleure, h.getSecondesDepuisMinuit());
+    for (unsigned int f : m_frontieresParCellule[p_cellule])
+    {
+        if (planificateur.getArriveeAssise(etatCellule, m_stationsFrontieres[f], h))
+            proposer(p_etat, f, h.getSecondesDepuisMinuit(), true, false, p_destination, p_meilleure);
+        if (planificateur.getArrivee(etatCellule, m_stationsFrontieres[f], h))
+            proposer(p_etat, f, h.getSecondesDepuisMinuit(), false, false, p_destination, p_meilleure);
+    }
+}
+
+//! \brief relâche les liens de la surcouche et les marches qui partent d'une station frontière
+void PartitionReseau::relayer(unsigned int p_frontiere, bool p_marche, unsigned int p_destination,
+                              unsigned int &p_meilleure, EtatRecherche &p_etat) const
+{
+    const unsigned int assise = p_etat.m_arriveeAssise[p_frontiere];
+    const unsigned int arrivee = min(p_etat.m_arrivee[p_frontiere], assise);
+
+    auto debut = m_liens.begin() + m_debutLiens[p_frontiere];
+    auto fin = m_liens.begin() + m_debutLiens[p_frontiere + 1];
+    auto l = lower_bound(debut, fin, arrivee, [](const Lien &p_lien, unsigned int h) { return p_lien.depart < h; });
+    for (; l != fin && l->depart < p_meilleure; ++l)
+        proposer(p_etat, l->vers, l->arrivee, true, true, p_destination, p_meilleure);
+
+    for (unsigned int m = m_debutMarches[p_frontiere];
+         p_marche && assise != INFINI && m < m_debutMarches[p_frontiere + 1]; ++m)
+        proposer(p_etat, m_marches[m].vers, assise + m_marches[m].duree, false, true, p_destination, p_meilleure);
+}
+
+/*!
+ * \brief améliore l'étiquette d'une station frontière; une arrivée à la destination améliore plutôt p_meilleure
+ * \param[in] p_parSurcouche: l'étiquette vient d'une autre cellule, qui devra donc être explorée de nouveau
+ */
+void PartitionReseau::proposer(EtatRecherche &p_etat, unsigned int p_frontiere, unsigned int p_heure, bool p_assise,
+                               bool p_parSurcouche, unsigned int p_destination, unsigned int &p_meilleure) const
+{
+    if (p_frontiere == p_destination)
+    {
+        p_meilleure = min(p_meilleure, p_heure);
+        return;
+    }
+    if (p_heure >= p_meilleure) return;
+
+    unsigned int &courante = p_assise ? p_etat.m_arriveeAssise[p_frontiere] : p_etat.m_arrivee[p_frontiere];
+    if (p_heure >= courante || (!p_assise && p_etat.m_arriveeAssise[p_frontiere] <= p_heure)) return;
+
+    if (p_etat.m_arrivee[p_frontiere] == INFINI && p_etat.m_arriveeAssise[p_frontiere] == INFINI)
+        p_etat.m_touchees.push_back(p_frontiere);
+    courante = p_heure;
+    if (!p_etat.m_enAttente[p_frontiere])
+    {
+        p_etat.m_enAttente[p_frontiere] = 1;
+        p_etat.m_aRelayer.push_back(p_frontiere);
+    }
+    if (p_parSurcouche && !p_etat.m_nouvelle[p_frontiere])
+    {
+        p_etat.m_nouvelle[p_frontiere] = 1;
+        p_etat.m_nouvelles[m_celluleFrontiere[p_frontiere]].push_back(p_frontiere);
+    }
+}
+
+unsigned int PartitionReseau::getNbCellules() const
+{
+    return m_nbCellules;
+}
+
+//! \return false si la station est inconnue
+bool PartitionReseau::getCellule(unsigned int p_station_id, unsigned int &p_cellule) const
+{
+    auto it = m_cellules.find(p_station_id);
+    if (it == m_cellules.end()) return false;
+    p_cellule = it->second;
+    return true;
+}
+
+//! \return les stop_id des stations frontières de la cellule
+std::vector<unsigned int> PartitionReseau::getStationsFrontieres(unsigned int p_cellule) const
+{
+    vector<unsigned int> stations;
+    for (unsigned int f : m_frontieresParCellule.at(p_cellule)) stations.push_back(m_stationsFrontieres[f]);
+    return stations;
+}
+
+//! \return le nombre de liens de la surcouche (connexions et enchaînements de bloc entre cellules)
+std::size_t PartitionReseau::getNbLiensFrontieres() const
+{
+    return m_liens.size();
+}
+
+const Planificateur &PartitionReseau::getPlanificateur(unsigned int p_cellule) const
+{
+    return m_planificateurs.at(p_cellule);
+}
@@ -0,0 +1,121 @@
+//
+// Découpage géographique du réseau en cellules interrogées séparément
+//
+
+#ifndef RTC_PARTITION_RESEAU_H
+#define RTC_PARTITION_RESEAU_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "coordonnees.h"
+#include "DonneesGTFS.h"
+#include "planificateur.h"
+
+/*!
+ * \class PartitionReseau
+ * \brief Répartit les stations en cellules géographiques, chacune servie par son propre Planificateur,
+ * et raccorde les cellules par une surcouche de liens entre stations frontières.
+ *
+ * Les cellules sont obtenues par découpage k-d: on coupe à la médiane le long de l'axe le plus étendu
+ * (la longitude est ramenée à la latitude moyenne), récursivement, jusqu'à obtenir le nombre de cellules voulu.
+ * Une station est frontière si elle est l'extrémité d'une connexion, d'un transfert à pied ou d'un
+ * enchaînement de bloc qui change de cellule. La surcouche garde ces liens, triés par heure de départ.
+ *
+ * Une requête explore d'abord la cellule de l'origine avec son planificateur. Les étiquettes des stations
+ * frontières sont ensuite relâchées le long de la surcouche, et chaque cellule où une étiquette s'est améliorée
+ * est explorée de nouveau, en un seul balayage à partir de ces seules stations, jusqu'à ce que plus rien ne
+ * s'améliore avant la meilleure arrivée connue à la destination. Les sources déjà explorées n'ont pas à l'être
+ * encore: leurs arrivées aux stations frontières et à la destination sont déjà notées.
+ *
+ * Un enchaînement de bloc d'une cellule à l'autre est traité comme une connexion ouverte à tous entre le dernier
+ * arrêt d'un voyage et le premier du suivant: c'est une relaxation, alors que le Planificateur global ne le permet
+ * qu'au voyageur resté assis.
+ *
+ * La partition ne modifie jamais ses données après construction; chaque fil l'interroge avec son propre
+ * EtatRecherche.
+ */
+class PartitionReseau
+{
+
+public:
+    /*!
+     * \class EtatRecherche
+     * \brief Étiquettes de travail d'une requête: une par station frontière, et un état par cellule
+     */
+    class EtatRecherche
+    {
+    public:
+        EtatRecherche();
+
+    private:
+        friend class PartitionReseau;
+        void preparer(std::size_t p_nbFrontieres, std::size_t p_nbCellules);
+
+        std::vector<Planificateur::EtatRecherche> m_cellules;
+        std::vector<unsigned int> m_arrivee;       //par station frontière, en secondes
+        std::vector<unsigned int> m_arriveeAssise; //arrivée en descendant d'un véhicule: une marche peut en partir
+        std::vector<unsigned int> m_touchees;
+        std::vector<unsigned char> m_enAttente;    //la station frontière est dans m_aRelayer
+        std::vector<unsigned int> m_aRelayer;      //stations frontières dont les liens sont à relâcher
+        std::vector<unsigned char> m_nouvelle;     //arrivée par la surcouche, pas encore explorée dans sa cellule
+        std::vector<std::vector<unsigned int> > m_nouvelles; //par cellule, les stations frontières à explorer
+        std::vector<SourceExploration> m_sources;
+    };
+
+    PartitionReseau(const DonneesGTFS &p_donnees, unsigned int p_nbCellules);
+
+    ResultatOD calculerTrajet(const RequeteOD &p_requete) const;
+    ResultatOD calculerTrajet(const RequeteOD &p_requete, EtatRecherche &p_etat) const;
+
+    unsigned int getNbCellules() const;
+    bool getCellule(unsigned int p_station_id, unsigned int &p_cellule) const;
+    std::vector<unsigned int> getStationsFrontieres(unsigned int p_cellule) const;
+    std::size_t getNbLiensFrontieres() const;
+    const Planificateur &getPlanificateur(unsigned int p_cellule) const;
+
+private:
+    struct Lien
+    {
+        unsigned int vers;    //index de la station frontière d'arrivée
+        unsigned int depart;  //en secondes
+        unsigned int arrivee;
+    };
+
+    struct Marche
+    {
+        unsigned int vers;
+        unsigned int duree;
+    };
+
+    typedef std::vector<std::pair<unsigned int, Coordonnees> > StationsPlacees;
+
+    static const unsigned int INFINI;
+
+    void decouper(StationsPlacees::iterator p_debut, StationsPlacees::iterator p_fin,
+                  unsigned int p_premiereCellule, unsigned int p_nbCellules);
+    void construireSurcouche(const DonneesGTFS &p_donnees);
+    unsigned int ajouterFrontiere(unsigned int p_station_id);
+    void explorerCellule(unsigned int p_cellule, const RequeteOD &p_requete, unsigned int p_destination,
+                         unsigned int &p_meilleure, EtatRecherche &p_etat) const;
+    void relayer(unsigned int p_frontiere, bool p_marche, unsigned int p_destination, unsigned int &p_meilleure,
+                 EtatRecherche &p_etat) const;
+    void proposer(EtatRecherche &p_etat, unsigned int p_frontiere, unsigned int p_heure, bool p_assise,
+                  bool p_parSurcouche, unsigned int p_destination, unsigned int &p_meilleure) const;
+
+    unsigned int m_nbCellules;
+    std::unordered_map<unsigned int, unsigned int> m_cellules; //stop_id -> cellule
+    std::vector<Planificateur> m_planificateurs;                //un par cellule
+
+    std::unordered_map<unsigned int, unsigned int> m_indexFrontieres; //stop_id -> index de station frontière
+    std::vector<unsigned int> m_stationsFrontieres;                   //index -> stop_id
+    std::vector<unsigned int> m_celluleFrontiere;                     //index -> cellule
+    std::vector<std::vector<unsigned int> > m_frontieresParCellule;   //cellule -> index, croissants
+    std::vector<unsigned int> m_debutLiens;  //m_liens[m_debutLiens[f], m_debutLiens[f+1]) partent de f
+    std::vector<Lien> m_liens;               //triés par heure de départ pour chaque station frontière
+    std::vector<unsigned int> m_debutMarches;
+    std::vector<Marche> m_marches;
+};
+
+#endif //RTC_PARTITION_RESEAU_H
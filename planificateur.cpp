@@ -0,0 +1,401 @@
+//
+// Planificateur de trajets origine-destination sur les données GTFS chargées
+//
+
+#include "planificateur.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+using namespace std;
+
+const unsigned int Planificateur::INFINI = numeric_limits<unsigned int>::max();
+
+Planificateur::EtatRecherche::EtatRecherche()
+{
+}
+
+/*!
+ * \brief prépare les étiquettes pour une nouvelle requête
+ * \brief seules les entrées touchées par la requête précédente sont remises à l'infini
+ * \param[in] p_nbStations: le nombre de stations du planificateur
+ * \param[in] p_nbVoyages: le nombre de voyages du planificateur
+ */
+void Planificateur::EtatRecherche::preparer(size_t p_nbStations, size_t p_nbVoyages)
+{
+    if (m_arrivee.size() != p_nbStations || m_voyageAtteint.size() != p_nbVoyages)
+    {
+        m_arrivee.assign(p_nbStations, INFINI);
+        m_arriveeAssise.assign(p_nbStations, INFINI);
+        m_voyageAtteint.assign(p_nbVoyages, 0);
+    } else
+    {
+        for (unsigned int s : m_stationsTouchees)
+        {
+            m_arrivee[s] = INFINI;
+            m_arriveeAssise[s] = INFINI;
+        }
+        for (unsigned int v : m_voyagesTouches) m_voyageAtteint[v] = 0;
+    }
+    m_stationsTouchees.clear();
+    m_voyagesTouches.clear();
+}
+
+/*!
+ * \brief construit le planificateur à partir des stations, des voyages et des transferts de p_donnees
+ * \param[in] p_donnees: les données GTFS; tous les arrêts et transferts doivent avoir été ajoutés
+ */
+Planificateur::Planificateur(const DonneesGTFS &p_donnees)
+        : m_nbVoyages(0), m_versionDonnees(p_donnees.getVersion())
+{
+    construire(p_donnees, [](unsigned int) { return true; });
+}
+
+/*!
+ * \brief construit un planificateur restreint à une partie des stations (ex.: une cellule de PartitionReseau)
+ * \brief Seules les connexions et les transferts entre deux stations gardées sont retenus, et seuls les voyages
+ * \brief ayant au moins une telle connexion sont numérotés.
+ * \param[in] p_donnees: les données GTFS; tous les arrêts et transferts doivent avoir été ajoutés
+ * \param[in] p_garderStation: indique si une station (stop_id) fait partie du planificateur
+ */
+Planificateur::Planificateur(const DonneesGTFS &p_donnees, const std::function<bool(unsigned int)> &p_garderStation)
+        : m_nbVoyages(0), m_versionDonnees(p_donnees.getVersion())
+{
+    construire(p_donnees, p_garderStation);
+}
+
+void Planificateur::construire(const DonneesGTFS &p_donnees, const std::function<bool(unsigned int)> &p_garderStation)
+{
+    for (const auto &stationM : p_donnees.getStations())
+    {
+        if (!p_garderStation(stationM.first)) continue;
+        unsigned int index = (unsigned int) m_indexStations.size();
+        m_indexStations.insert({stationM.first, index});
+    }
+
+    // Un voyage est retenu s'il relie deux stations gardées par au moins une connexion
+    vector<const Voyage *> voyages;
+    unordered_map<const Voyage *, unsigned int> indexVoyages;
+    for (const auto &voyageM : p_donnees.getVoyages())
+    {
+        Arret precedent; //copie: la vue des arrêts réutilise l'arrêt courant
+        bool premier = true;
+        for (const Arret &a : voyageM.second.getArrets())
+        {
+            unsigned int depart, arrivee;
+            if (!premier && indexStation(precedent.getStationId(), depart) &&
+                indexStation(a.getStationId(), arrivee))
+            {
+                indexVoyages.insert({&voyageM.second, (unsigned int) voyages.size()});
+                voyages.push_back(&voyageM.second);
+                break;
+            }
+            precedent = a;
+            premier = false;
+        }
+    }
+    // Le voyage suivant du bloc est le prochain voyage retenu de la chaîne: on reste assis entre les deux
+    for (const Voyage *voyage : voyages)
+    {
+        const Voyage *suivant = voyage->getVoyageSuivant();
+        while (suivant && !indexVoyages.count(suivant)) suivant = suivant->getVoyageSuivant();
+        m_voyageSuivant.push_back(suivant ? indexVoyages[suivant] : INFINI);
+    }
+
+    for (const Voyage *v : voyages)
+    {
+        const unsigned int voyage = (unsigned int) m_nbVoyages++;
+        Arret precedent;
+        bool premier = true;
+        for (const Arret &a : v->getArrets())
+        {
+            if (!premier)
+            {
+                unsigned int depart, arrivee;
+                if (indexStation(precedent.getStationId(), depart) && indexStation(a.getStationId(), arrivee))
+                {
+                    Connexion c = {depart, arrivee, enSecondes(precedent.getHeureDepart()),
+                                   enSecondes(a.getHeureArrivee()), voyage};
+                    m_connexions.push_back(c);
+                }
+            }
+            precedent = a;
+            premier = false;
+        }
+    }
+    stable_sort(m_connexions.begin(), m_connexions.end(), [](const Connexion &a, const Connexion &b)
+    {
+        return a.heure_depart < b.heure_depart;
+    });
+
+    // Les transferts à pied sont rangés par station de départ (format CSR)
+    vector<vector<Marche> > marchesParStation(m_indexStations.size());
+    for (const auto &t : p_donnees.getTransferts())
+    {
+        unsigned int de, vers;
+        if (indexStation(get<0>(t), de) && indexStation(get<1>(t), vers))
+        {
+            Marche m = {vers, get<2>(t)};
+            marchesParStation[de].push_back(m);
+        }
+    }
+    m_debutMarches.reserve(marchesParStation.size() + 1);
+    for (const auto &marches : marchesParStation)
+    {
+        m_debutMarches.push_back((unsigned int) m_marches.size());
+        m_marches.insert(m_marches.end(), marches.begin(), marches.end());
+    }
+    m_debutMarches.push_back((unsigned int) m_marches.size());
+}
+
+//! \brief calcule un trajet avec un état de recherche temporaire
+ResultatOD Planificateur::calculerTrajet(const RequeteOD &p_requete) const
+{
+    EtatRecherche etat;
+    return calculerTrajet(p_requete, etat);
+}
+
+/*!
+ * \brief calcule l'heure d'arrivée au plus tôt à la destination de p_requete
+ * \param[in] p_requete: la requête origine-destination
+ * \param[in,out] p_etat: les étiquettes de travail, réutilisées d'une requête à l'autre
+ * \return le résultat; trouve est faux si l'origine ou la destination est inconnue ou inatteignable
+ */
+ResultatOD Planificateur::calculerTrajet(const RequeteOD &p_requete, EtatRecherche &p_etat) const
+{
+    ResultatOD resultat = {false, Heure(0, 0, 0)};
+    p_etat.preparer(m_indexStations.size(), m_nbVoyages);
+
+    unsigned int origine, destination;
+    if (!indexStation(p_requete.origine, origine) || !indexStation(p_requete.destination, destination))
+        return resultat;
+
+    const bool marche = !(p_requete.profil & PROFIL_SANS_MARCHE);
+    const unsigned int depart = enSecondes(p_requete.depart);
+    partir(p_etat, origine, depart, marche);
+    balayer(p_etat, depart, marche, p_etat.m_arrivee[destination]);
+
+    if (p_etat.m_arrivee[destination] != INFINI)
+    {
+        resultat.trouve = true;
+        resultat.arrivee = Heure(0, 0, 0).add_secondes(p_etat.m_arrivee[destination]);
+    }
+    return resultat;
+}
+
+/*!
+ * \brief calcule les heures d'arrivée au plus tôt à toutes les stations à partir de plusieurs sources à la fois
+ * \brief Les connexions qui partent à p_limite ou après ne sont pas examinées, ni celles qui partent après
+ * \brief l'arrivée à p_destination si elle fait partie du planificateur: son arrivée lue ensuite est alors au plus
+ * \brief p_limite.
+ * \brief Les sources dont la station est inconnue du planificateur sont ignorées. Les heures se lisent ensuite avec
+ * \brief getArrivee et getArriveeAssise.
+ * \param[in] p_sources: les stations de départ, chacune avec son heure
+ * \param[in] p_destination: identifiant (stop_id) de la station visée
+ * \param[in] p_profil: combinaison de ProfilRecherche
+ * \param[in] p_limite: l'heure à partir de laquelle les arrivées ne sont plus utiles
+ * \param[in,out] p_etat: les étiquettes de travail, qui reçoivent les heures d'arrivée
+ */
+void Planificateur::explorer(const std::vector<SourceExploration> &p_sources, unsigned int p_destination,
+                             unsigned int p_profil, const Heure &p_limite, EtatRecherche &p_etat) const
+{
+    p_etat.preparer(m_indexStations.size(), m_nbVoyages);
+
+    const bool marche = !(p_profil & PROFIL_SANS_MARCHE);
+    unsigned int premierDepart = INFINI;
+    for (const auto &source : p_sources)
+    {
+        unsigned int station;
+        if (!indexStation(source.station, station)) continue;
+        const unsigned int depart = enSecondes(source.depart);
+        partir(p_etat, station, depart, marche && source.marche);
+        premierDepart = min(premierDepart, depart);
+    }
+    if (premierDepart == INFINI) return;
+
+    const unsigned int limite = enSecondes(p_limite);
+    unsigned int destination;
+    if (indexStation(p_destination, destination))
+    {
+        // Comme dans calculerTrajet, l'étiquette de la destination borne le balayage; elle part de p_limite
+        if (limite != INFINI) ameliorer(p_etat, destination, limite);
+        balayer(p_etat, premierDepart, marche, p_etat.m_arrivee[destination]);
+    } else
+        balayer(p_etat, premierDepart, marche, limite);
+}
+
+//! \brief lit l'heure d'arrivée au plus tôt à une station, après explorer
+//! \return false si la station est inconnue du planificateur ou n'a pas été atteinte
+bool Planificateur::getArrivee(const EtatRecherche &p_etat, unsigned int p_station_id, Heure &p_arrivee) const
+{
+    unsigned int station;
+    if (!indexStation(p_station_id, station) || station >= p_etat.m_arrivee.size() ||
+        p_etat.m_arrivee[station] == INFINI)
+        return false;
+    p_arrivee = Heure(0, 0, 0).add_secondes(p_etat.m_arrivee[station]);
+    return true;
+}
+
+//! \brief lit l'heure d'arrivée au plus tôt à une station en descendant d'un véhicule (ou au départ), après
+//! \brief explorer
+//! \brief C'est à partir de cette heure qu'une marche peut partir de la station.
+//! \return false si la station est inconnue du planificateur ou n'a pas été atteinte ainsi
+bool Planificateur::getArriveeAssise(const EtatRecherche &p_etat, unsigned int p_station_id, Heure &p_arrivee) const
+{
+    unsigned int station;
+    if (!indexStation(p_station_id, station) || station >= p_etat.m_arrivee.size() ||
+        p_etat.m_arriveeAssise[station] == INFINI)
+        return false;
+    p_arrivee = Heure(0, 0, 0).add_secondes(p_etat.m_arriveeAssise[station]);
+    return true;
+}
+
+/*!
+ * \brief calcule un lot de requêtes en parallèle sur un pool de fils à vol de travail
+ * \brief chaque fil réutilise ses propres étiquettes pour toutes les requêtes qu'il traite
+ * \param[in] p_requetes: les requêtes origine-destination
+ * \param[in] p_nbFils: le nombre de fils; 0 signifie le nombre de coeurs disponibles
+ * \return les résultats, dans le même ordre que p_requetes
+ */
+vector<ResultatOD> Planificateur::calculerTrajets(const vector<RequeteOD> &p_requetes, unsigned int p_nbFils) const
+{
+    PoolTravail pool(p_nbFils);
+    return calculerTrajets(p_requetes, pool);
+}
+
+/*!
+ * \brief calcule un lot de requêtes sur un pool existant, dont les fils restent disponibles pour les lots suivants
+ * \param[in] p_requetes: les requêtes origine-destination
+ * \param[in] p_pool: le pool de fils
+ * \return les résultats, dans le même ordre que p_requetes
+ */
+vector<ResultatOD> Planificateur::calculerTrajets(const vector<RequeteOD> &p_requetes, PoolTravail &p_pool) const
+{
+    ResultatOD defaut = {false, Heure(0, 0, 0)};
+    vector<ResultatOD> resultats(p_requetes.size(), defaut);
+
+    vector<EtatRecherche> etats(p_pool.getNbFils());
+    p_pool.executer(p_requetes.size(), [&](size_t p_tache, unsigned int p_fil)
+    {
+        resultats[p_tache] = calculerTrajet(p_requetes[p_tache], etats[p_fil]);
+    });
+    return resultats;
+}
+
+size_t Planificateur::getNbConnexions() const
+{
+    return m_connexions.size();
+}
+
+size_t Planificateur::getNbStations() const
+{
+    return m_indexStations.size();
+}
+
+size_t Planificateur::getNbVoyages() const
+{
+    return m_nbVoyages;
+}
+
+//! \brief retourne le nombre d'octets parcourus par une recherche: connexions, chaînes de blocs, transferts et
+//! \brief étiquettes d'un EtatRecherche (sans la table de correspondance des stop_id)
+size_t Planificateur::getTailleOctets() const
+{
+    return m_connexions.size() * sizeof(Connexion) + m_voyageSuivant.size() * sizeof(unsigned int) +
+           m_debutMarches.size() * sizeof(unsigned int) + m_marches.size() * sizeof(Marche) +
+           m_indexStations.size() * sizeof(unsigned int) + m_nbVoyages * sizeof(unsigned char);
+}
+
+//! \brief retourne la version des données GTFS à partir desquelles le planificateur a été construit
+unsigned long Planificateur::getVersionDonnees() const
+{
+    return m_versionDonnees;
+}
+
+unsigned int Planificateur::enSecondes(const Heure &p_heure)
+{
+    return p_heure.getSecondesDepuisMinuit();
+}
+
+bool Planificateur::indexStation(unsigned int p_station_id, unsigned int &p_index) const
+{
+    auto it = m_indexStations.find(p_station_id);
+    if (it == m_indexStations.end()) return false;
+    p_index = it->second;
+    return true;
+}
+
+/*!
+ * \brief place le voyageur à une station de départ, avec les marches qui en partent si p_marche
+ * \brief Le départ compte comme une arrivée assise: une marche peut en partir.
+ */
+void Planificateur::partir(EtatRecherche &p_etat, unsigned int p_station, unsigned int p_depart, bool p_marche) const
+{
+    ameliorer(p_etat, p_station, p_depart);
+    if (p_marche && p_depart < p_etat.m_arriveeAssise[p_station])
+        p_etat.m_arriveeAssise[p_station] = p_depart;
+    for (unsigned int m = m_debutMarches[p_station]; p_marche && m < m_debutMarches[p_station + 1]; ++m)
+    {
+        ameliorer(p_etat, m_marches[m].station, p_depart + m_marches[m].duree);
+    }
+}
+
+/*!
+ * \brief Connection Scan à partir des stations placées par partir: les connexions sont parcourues par heure de
+ * \brief départ, de p_depart jusqu'à la première qui part à p_borne ou après
+ * \brief Les marches partent de chaque arrivée en véhicule qui améliore m_arriveeAssise, même si la station
+ * \brief a déjà été atteinte plus tôt à pied: on ne peut pas enchaîner deux marches.
+ * \param[in] p_marche: les transferts à pied sont permis à la descente d'un véhicule
+ * \param[in] p_borne: lue à chaque connexion, elle peut être une étiquette de p_etat (ex.: l'arrivée à la
+ * \brief destination) qui diminue pendant le balayage
+ */
+void Planificateur::balayer(EtatRecherche &p_etat, unsigned int p_depart, bool p_marche,
+                            const unsigned int &p_borne) const
+{
+    auto premiere = lower_bound(m_connexions.begin(), m_connexions.end(), p_depart,
+                                [](const Connexion &c, unsigned int h) { return c.heure_depart < h; });
+    for (auto c = premiere; c != m_connexions.end(); ++c)
+    {
+        if (c->heure_depart >= p_borne)
+            break;
+
+        if (p_etat.m_voyageAtteint[c->voyage] || p_etat.m_arrivee[c->station_depart] <= c->heure_depart)
+        {
+            if (!p_etat.m_voyageAtteint[c->voyage])
+                monter(p_etat, c->voyage);
+            if (c->heure_arrivee < p_etat.m_arriveeAssise[c->station_arrivee])
+            {
+                ameliorer(p_etat, c->station_arrivee, c->heure_arrivee);
+                p_etat.m_arriveeAssise[c->station_arrivee] = c->heure_arrivee;
+                for (unsigned int m = m_debutMarches[c->station_arrivee];
+                     p_marche && m < m_debutMarches[c->station_arrivee + 1]; ++m)
+                {
+                    ameliorer(p_etat, m_marches[m].station, c->heure_arrivee + m_marches[m].duree);
+                }
+            }
+        }
+    }
+}
+
+void Planificateur::ameliorer(EtatRecherche &p_etat, unsigned int p_station, unsigned int p_heure) const
+{
+    if (p_heure < p_etat.m_arrivee[p_station])
+    {
+        if (p_etat.m_arrivee[p_station] == INFINI) p_etat.m_stationsTouchees.push_back(p_station);
+        p_etat.m_arrivee[p_station] = p_heure;
+    }
+}
+
+/*!
+ * \brief marque un voyage comme atteint, ainsi que les voyages suivants de son bloc:
+ * on peut rester assis dans le véhicule d'un voyage au suivant
+ */
+void Planificateur::monter(EtatRecherche &p_etat, unsigned int p_voyage) const
+{
+    for (unsigned int v = p_voyage; v != INFINI && !p_etat.m_voyageAtteint[v]; v = m_voyageSuivant[v])
+    {
+        p_etat.m_voyageAtteint[v] = 1;
+        p_etat.m_voyagesTouches.push_back(v);
+    }
+}
@@ -0,0 +1,150 @@
+//
+// Planificateur de trajets origine-destination sur les données GTFS chargées
+//
+
+#ifndef RTC_PLANIFICATEUR_H
+#define RTC_PLANIFICATEUR_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "auxiliaires.h"
+#include "DonneesGTFS.h"
+#include "pool_travail.h"
+
+/*!
+ * \enum ProfilRecherche
+ * \brief Options de recherche, combinables par un ou binaire dans RequeteOD::profil
+ */
+enum ProfilRecherche
+{
+    PROFIL_DEFAUT = 0,
+    PROFIL_SANS_MARCHE = 1 //ignore les transferts à pied entre stations (m_transferts)
+};
+
+/*!
+ * \struct RequeteOD
+ * \brief Une requête origine-destination: partir de la station origine à partir de l'heure depart pour atteindre la station destination
+ */
+struct RequeteOD
+{
+    unsigned int origine;     //identifiant (stop_id) de la station de départ
+    unsigned int destination; //identifiant (stop_id) de la station d'arrivée
+    Heure depart;             //heure à partir de laquelle on peut partir de l'origine
+    unsigned int profil;      //combinaison de ProfilRecherche
+};
+
+/*!
+ * \struct ResultatOD
+ * \brief Le résultat d'une requête origine-destination
+ */
+struct ResultatOD
+{
+    bool trouve;    //vrai ssi la destination est atteignable dans l'intervalle des données
+    Heure arrivee;  //heure d'arrivée au plus tôt à la destination (valide ssi trouve)
+};
+
+/*!
+ * \struct SourceExploration
+ * \brief Une station d'où part Planificateur::explorer, et à quelle heure
+ */
+struct SourceExploration
+{
+    unsigned int station; //identifiant (stop_id) de la station
+    Heure depart;
+    bool marche;          //faux si on vient d'y arriver à pied: pas de deuxième marche avant de monter
+};
+
+/*!
+ * \class Planificateur
+ * \brief Calcule des heures d'arrivée au plus tôt entre stations à l'aide de l'algorithme
+ * Connection Scan sur les arrêts et les transferts d'un objet DonneesGTFS.
+ *
+ * Les stations et les voyages sont renumérotés de façon dense; les connexions (paires d'arrêts
+ * consécutifs d'un même voyage) sont triées par heure de départ une fois pour toutes à la construction.
+ * Un voyage atteint rend aussi atteints les voyages suivants de son bloc (on reste assis dans le véhicule).
+ * Un planificateur peut être restreint à une partie des stations; explorer calcule alors les arrivées à partir
+ * de plusieurs sources, ce qui sert à raccorder les cellules de PartitionReseau.
+ * Le planificateur ne modifie jamais ses données après construction et peut donc être interrogé
+ * par plusieurs fils en même temps, chacun avec son propre EtatRecherche.
+ */
+class Planificateur
+{
+
+public:
+    /*!
+     * \class EtatRecherche
+     * \brief Étiquettes de travail d'une recherche, réutilisables d'une requête à l'autre
+     * Seules les entrées modifiées par la requête précédente sont réinitialisées.
+     */
+    class EtatRecherche
+    {
+    public:
+        EtatRecherche();
+
+    private:
+        friend class Planificateur;
+        void preparer(std::size_t p_nbStations, std::size_t p_nbVoyages);
+
+        std::vector<unsigned int> m_arrivee;        //heure d'arrivée au plus tôt par station (en secondes)
+        std::vector<unsigned int> m_arriveeAssise;  //arrivée en véhicule (ou au départ), d'où une marche peut partir
+        std::vector<unsigned char> m_voyageAtteint; //indique si on est à bord du voyage
+        std::vector<unsigned int> m_stationsTouchees;
+        std::vector<unsigned int> m_voyagesTouches;
+    };
+
+    explicit Planificateur(const DonneesGTFS &p_donnees);
+    Planificateur(const DonneesGTFS &p_donnees, const std::function<bool(unsigned int)> &p_garderStation);
+
+    ResultatOD calculerTrajet(const RequeteOD &p_requete) const;
+    ResultatOD calculerTrajet(const RequeteOD &p_requete, EtatRecherche &p_etat) const;
+    std::vector<ResultatOD> calculerTrajets(const std::vector<RequeteOD> &p_requetes, unsigned int p_nbFils = 0) const;
+    std::vector<ResultatOD> calculerTrajets(const std::vector<RequeteOD> &p_requetes, PoolTravail &p_pool) const;
+    void explorer(const std::vector<SourceExploration> &p_sources, unsigned int p_destination, unsigned int p_profil,
+                  const Heure &p_limite, EtatRecherche &p_etat) const;
+    bool getArrivee(const EtatRecherche &p_etat, unsigned int p_station_id, Heure &p_arrivee) const;
+    bool getArriveeAssise(const EtatRecherche &p_etat, unsigned int p_station_id, Heure &p_arrivee) const;
+
+    std::size_t getNbConnexions() const;
+    std::size_t getNbStations() const;
+    std::size_t getNbVoyages() const;
+    std::size_t getTailleOctets() const;
+    unsigned long getVersionDonnees() const;
+
+private:
+    struct Connexion
+    {
+        unsigned int station_depart;
+        unsigned int station_arrivee;
+        unsigned int heure_depart;
+        unsigned int heure_arrivee;
+        unsigned int voyage;
+    };
+
+    struct Marche
+    {
+        unsigned int station;
+        unsigned int duree;
+    };
+
+    static const unsigned int INFINI;
+
+    static unsigned int enSecondes(const Heure &p_heure);
+    void construire(const DonneesGTFS &p_donnees, const std::function<bool(unsigned int)> &p_garderStation);
+    void partir(EtatRecherche &p_etat, unsigned int p_station, unsigned int p_depart, bool p_marche) const;
+    void balayer(EtatRecherche &p_etat, unsigned int p_depart, bool p_marche, const unsigned int &p_borne) const;
+    bool indexStation(unsigned int p_station_id, unsigned int &p_index) const;
+    void ameliorer(EtatRecherche &p_etat, unsigned int p_station, unsigned int p_heure) const;
+    void monter(EtatRecherche &p_etat, unsigned int p_voyage) const;
+
+    std::unordered_map<unsigned int, unsigned int> m_indexStations; //stop_id -> index dense
+    std::vector<Connexion> m_connexions; //triées par heure de départ
+    std::vector<unsigned int> m_voyageSuivant; //voyage suivant du même bloc (véhicule), INFINI s'il n'y en a pas
+    std::vector<unsigned int> m_debutMarches; //m_marches[m_debutMarches[s], m_debutMarches[s+1]) partent de s
+    std::vector<Marche> m_marches;
+    std::size_t m_nbVoyages;
+    unsigned long m_versionDonnees; //DonneesGTFS::getVersion() au moment de la construction
+};
+
+#endif //RTC_PLANIFICATEUR_H
@@ -0,0 +1,195 @@
+//
+// Pool de fils d'exécution à vol de travail (work-stealing)
+//
+
+#include "pool_travail.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+/*!
+ * \brief Constructeur du pool: démarre les fils auxiliaires, qui attendent ensuite les lots de executer()
+ * \param[in] p_nbFils: le nombre de fils à utiliser, y compris le fil appelant; 0 signifie le nombre de coeurs
+ * \param[in] p_tailleBloc: le nombre de tâches consécutives regroupées dans un bloc, par défaut
+ */
+PoolTravail::PoolTravail(unsigned int p_nbFils, std::size_t p_tailleBloc)
+        : m_nbFils(p_nbFils ? p_nbFils : std::max(1u, std::thread::hardware_concurrency())),
+          m_tailleBloc(p_tailleBloc ? p_tailleBloc : 1),
+          m_files(m_nbFils), m_tache(nullptr), m_lot(0), m_actifs(0), m_arret(false)
+{
+    for (unsigned int f = 1; f < m_nbFils; ++f)
+    {
+        m_fils.push_back(std::thread(&PoolTravail::attendreLots, this, f));
+    }
+}
+
+//! \brief arrête et attend les fils auxiliaires
+PoolTravail::~PoolTravail()
+{
+    {
+        std::lock_guard<std::mutex> verrou(m_verrouLot);
+        m_arret = true;
+    }
+    m_reveil.notify_all();
+    for (auto &f : m_fils)
+    {
+        f.join();
+    }
+}
+
+unsigned int PoolTravail::getNbFils() const
+{
+    return m_nbFils;
+}
+
+/*!
+ * \brief Exécute p_tache pour chaque indice de [0, p_nbTaches) et attend la fin de toutes les tâches
+ * \param[in] p_nbTaches: le nombre de tâches
+ * \param[in] p_tache: la fonction appelée avec l'indice de la tâche et le numéro du fil (dans [0, getNbFils()))
+ * \param[in] p_tailleBloc: la taille des blocs de ce lot; 0 signifie celle donnée au constructeur
+ * \throws la première exception levée par une tâche, une fois tous les fils arrêtés; les tâches qui n'avaient
+ * pas encore commencé ne sont pas exécutées
+ */
+void PoolTravail::executer(std::size_t p_nbTaches, const Tache &p_tache, std::size_t p_tailleBloc)
+{
+    std::lock_guard<std::mutex> appel(m_verrouAppel);
+
+    // Répartition initiale: des blocs contigus pour chaque fil, afin de préserver la localité
+    const std::size_t tailleBloc = p_tailleBloc ? p_tailleBloc : m_tailleBloc;
+    std::size_t nbBlocs = (p_nbTaches + tailleBloc - 1) / tailleBloc;
+    for (std::size_t b = 0; b < nbBlocs; ++b)
+    {
+        std::size_t debut = b * tailleBloc;
+        std::size_t fin = std::min(p_nbTaches, debut + tailleBloc);
+        m_files[b * m_nbFils / nbBlocs].m_blocs.push_back(std::make_pair(debut, fin));
+    }
+
+    if (m_nbFils == 1)
+    {
+        try
+        {
+            travailler(0, p_tache);
+        } catch (...)
+        {
+            m_files[0].m_blocs.clear();
+            throw;
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> verrou(m_verrouLot);
+        m_tache = &p_tache;
+        m_erreur = nullptr;
+        m_actifs = m_nbFils - 1;
+        ++m_lot;
+    }
+    m_reveil.notify_all();
+
+    travaillerLot(0, p_tache);
+
+    std::exception_ptr erreur;
+    {
+        std::unique_lock<std::mutex> verrou(m_verrouLot);
+        m_finLot.wait(verrou, [this]() { return m_actifs == 0; });
+        m_tache = nullptr;
+        std::swap(erreur, m_erreur);
+    }
+    if (erreur)
+    {
+        viderFiles();
+        std::rethrow_exception(erreur);
+    }
+}
+
+/*!
+ * \brief Prend le prochain bloc dans la file du fil, sinon en vole un dans la file d'un autre fil
+ * \param[in] p_fil: le numéro du fil demandeur
+ * \param[out] p_bloc: le bloc obtenu
+ * \return false s'il ne reste plus aucun bloc dans aucune file
+ */
+bool PoolTravail::prendreBloc(unsigned int p_fil, std::pair<std::size_t, std::size_t> &p_bloc)
+{
+    {
+        FileBlocs &propre = m_files[p_fil];
+        std::lock_guard<std::mutex> verrou(propre.m_verrou);
+        if (!propre.m_blocs.empty())
+        {
+            p_bloc = propre.m_blocs.front();
+            propre.m_blocs.pop_front();
+            return true;
+        }
+    }
+    for (unsigned int i = 1; i < m_nbFils; ++i)
+    {
+        FileBlocs &victime = m_files[(p_fil + i) % m_nbFils];
+        std::lock_guard<std::mutex> verrou(victime.m_verrou);
+        if (!victime.m_blocs.empty())
+        {
+            p_bloc = victime.m_blocs.back();
+            victime.m_blocs.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolTravail::travailler(unsigned int p_fil, const Tache &p_tache)
+{
+    std::pair<std::size_t, std::size_t> bloc;
+    while (prendreBloc(p_fil, bloc))
+    {
+        for (std::size_t t = bloc.first; t < bloc.second; ++t)
+        {
+            p_tache(t, p_fil);
+        }
+    }
+}
+
+//! \brief exécute des blocs du lot courant; une exception vide les files pour que les autres fils s'arrêtent
+void PoolTravail::travaillerLot(unsigned int p_fil, const Tache &p_tache)
+{
+    try
+    {
+        travailler(p_fil, p_tache);
+    } catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> verrou(m_verrouLot);
+            if (!m_erreur) m_erreur = std::current_exception();
+        }
+        viderFiles();
+    }
+}
+
+//! \brief boucle d'un fil auxiliaire: attend chaque nouveau lot, y participe, puis le signale terminé
+void PoolTravail::attendreLots(unsigned int p_fil)
+{
+    unsigned long dernierLot = 0;
+    for (;;)
+    {
+        const Tache *tache;
+        {
+            std::unique_lock<std::mutex> verrou(m_verrouLot);
+            m_reveil.wait(verrou, [this, dernierLot]() { return m_arret || m_lot != dernierLot; });
+            if (m_arret) return;
+            dernierLot = m_lot;
+            tache = m_tache;
+        }
+
+        travaillerLot(p_fil, *tache);
+
+        std::lock_guard<std::mutex> verrou(m_verrouLot);
+        if (--m_actifs == 0) m_finLot.notify_one();
+    }
+}
+
+void PoolTravail::viderFiles()
+{
+    for (FileBlocs &file : m_files)
+    {
+        std::lock_guard<std::mutex> verrou(file.m_verrou);
+        file.m_blocs.clear();
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Pool de fils d'exécution à vol de travail (work-stealing)
+//
+
+#ifndef RTC_POOL_TRAVAIL_H
+#define RTC_POOL_TRAVAIL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*!
+ * \class PoolTravail
+ * \brief Exécute un lot de tâches indépendantes sur plusieurs fils avec vol de travail.
+ *
+ * Les indices de tâches [0, nbTaches) sont découpés en blocs répartis entre les files des fils.
+ * Chaque fil consomme sa propre file par l'avant; lorsqu'elle est vide, il vole un bloc à l'arrière
+ * de la file d'un autre fil. Chaque tâche reçoit aussi le numéro du fil qui l'exécute, ce qui permet
+ * à l'appelant de réutiliser un état de travail par fil.
+ *
+ * Les fils sont créés une seule fois par le constructeur et attendent les lots suivants entre deux appels
+ * à executer(); le fil appelant exécute lui-même les tâches du fil 0. Les appels concurrents à executer()
+ * sont exécutés l'un après l'autre; une tâche ne doit pas appeler executer() sur son propre pool.
+ */
+class PoolTravail
+{
+
+public:
+    typedef std::function<void(std::size_t p_tache, unsigned int p_fil)> Tache;
+
+    explicit PoolTravail(unsigned int p_nbFils = 0, std::size_t p_tailleBloc = 64);
+    ~PoolTravail();
+    PoolTravail(const PoolTravail &) = delete;
+    PoolTravail &operator=(const PoolTravail &) = delete;
+
+    unsigned int getNbFils() const;
+    void executer(std::size_t p_nbTaches, const Tache &p_tache, std::size_t p_tailleBloc = 0);
+
+private:
+    struct FileBlocs
+    {
+        std::mutex m_verrou;
+        std::deque<std::pair<std::size_t, std::size_t> > m_blocs; // intervalles [début, fin) de tâches
+    };
+
+    bool prendreBloc(unsigned int p_fil, std::pair<std::size_t, std::size_t> &p_bloc);
+    void travailler(unsigned int p_fil, const Tache &p_tache);
+    void travaillerLot(unsigned int p_fil, const Tache &p_tache);
+    void attendreLots(unsigned int p_fil);
+    void viderFiles();
+
+    unsigned int m_nbFils;
+    std::size_t m_tailleBloc;
+    std::vector<FileBlocs> m_files;
+
+    std::mutex m_verrouAppel;  //un seul lot à la fois
+    std::mutex m_verrouLot;    //protège les champs suivants
+    std::condition_variable m_reveil; //un nouveau lot est disponible, ou le pool est détruit
+    std::condition_variable m_finLot; //le dernier fil auxiliaire a terminé le lot
+    const Tache *m_tache;
+    unsigned long m_lot;       //numéro du lot courant
+    unsigned int m_actifs;     //fils auxiliaires qui n'ont pas terminé le lot courant
+    bool m_arret;
+    std::exception_ptr m_erreur; //première exception du lot courant
+    std::vector<std::thread> m_fils; //fils auxiliaires 1 à m_nbFils - 1
+};
+
+#endif //RTC_POOL_TRAVAIL_H
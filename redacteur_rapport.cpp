@@ -0,0 +1,124 @@
+//
+// Écriture tamponnée des rapports afficher* de DonneesGTFS
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
+#include "redacteur_rapport.h"
+
+using namespace std;
+
+//! \param[in] p_flux: le flux de sortie; il ne reçoit le rapport que par blocs de p_taille octets
+//! \param[in] p_taille: la taille du tampon
+RedacteurRapport::RedacteurRapport(std::ostream &p_flux, std::size_t p_taille)
+        : m_flux(&p_flux), m_descripteur(-1), m_tampon(p_taille > 64 ? p_taille : 64), m_position(0)
+{
+}
+
+//! \param[in] p_descripteur: un descripteur ouvert en écriture (ex.: STDOUT_FILENO); il n'est pas fermé
+//! \param[in] p_taille: la taille du tampon
+//! \note Si p_descripteur est aussi celui de std::cout, cout doit être vidé avant d'utiliser le rédacteur
+RedacteurRapport::RedacteurRapport(int p_descripteur, std::size_t p_taille)
+        : m_flux(nullptr), m_descripteur(p_descripteur), m_tampon(p_taille > 64 ? p_taille : 64), m_position(0)
+{
+}
+
+//! \brief écrit ce qui reste dans le tampon; une erreur d'écriture est alors ignorée
+RedacteurRapport::~RedacteurRapport()
+{
+    try
+    {
+        vider();
+    } catch (const exception &)
+    {
+    }
+}
+
+void RedacteurRapport::ecrire(const char *p_texte, std::size_t p_longueur)
+{
+    while (p_longueur > 0)
+    {
+        if (m_position == m_tampon.size()) vider();
+        const size_t n = min(p_longueur, m_tampon.size() - m_position);
+        memcpy(&m_tampon[m_position], p_texte, n);
+        m_position += n;
+        p_texte += n;
+        p_longueur -= n;
+    }
+}
+
+//! \brief écrit le contenu du tampon dans la destination
+//! \throws logic_error si l'écriture dans le descripteur échoue
+void RedacteurRapport::vider()
+{
+    if (m_position == 0) return;
+    if (m_flux)
+    {
+        m_flux->write(&m_tampon[0], (streamsize) m_position);
+    } else
+    {
+        size_t ecrits = 0;
+        while (ecrits < m_position)
+        {
+            const ssize_t n = ::write(m_descripteur, &m_tampon[ecrits], m_position - ecrits);
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                m_position = 0;
+                throw logic_error("Une erreur est survenue lors de l'écriture du rapport.");
+            }
+            ecrits += (size_t) n;
+        }
+    }
+    m_position = 0;
+}
+
+RedacteurRapport &RedacteurRapport::operator<<(unsigned long long p_entier)
+{
+    char chiffres[20];
+    size_t n = 0;
+    do
+    {
+        chiffres[sizeof(chiffres) - ++n] = (char) ('0' + p_entier % 10);
+        p_entier /= 10;
+    } while (p_entier);
+    ecrire(chiffres + sizeof(chiffres) - n, n);
+    return *this;
+}
+
+RedacteurRapport &RedacteurRapport::operator<<(double p_reel)
+{
+    char texte[32];
+    const int n = snprintf(texte, sizeof(texte), "%g", p_reel);
+    ecrire(texte, (size_t) n);
+    return *this;
+}
+
+//! \brief écrit une valeur sur au moins deux chiffres, comme les opérateurs << de Heure et Date
+void RedacteurRapport::deuxChiffres(unsigned int p_valeur)
+{
+    if (p_valeur < 10) *this << '0';
+    *this << p_valeur;
+}
+
+RedacteurRapport &RedacteurRapport::operator<<(const Heure &p_heure)
+{
+    deuxChiffres(p_heure.getHeures());
+    *this << ':';
+    deuxChiffres(p_heure.getMinutes());
+    *this << ':';
+    deuxChiffres(p_heure.getSecondes());
+    return *this;
+}
+
+RedacteurRapport &RedacteurRapport::operator<<(const Date &p_date)
+{
+    *this << p_date.getAn() << '-';
+    deuxChiffres(p_date.getMois());
+    *this << '-';
+    deuxChiffres(p_date.getJour());
+    return *this;
+}
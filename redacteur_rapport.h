@@ -0,0 +1,80 @@
+//
+// Écriture tamponnée des rapports afficher* de DonneesGTFS
+//
+
+#ifndef RTC_REDACTEUR_RAPPORT_H
+#define RTC_REDACTEUR_RAPPORT_H
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "auxiliaires.h"
+
+/*!
+ * \class RedacteurRapport
+ * \brief Accumule un rapport dans un grand tampon réutilisé et l'écrit par gros blocs, dans un flux ou directement
+ * dans un descripteur de fichier.
+ *
+ * Les entiers, les heures et les dates sont formatés à la main, sans passer par les facettes de iostream; les réels
+ * sont formatés comme le fait un ostream par défaut (%g, 6 chiffres significatifs). Le texte produit est identique
+ * à celui des opérateurs << correspondants. Rien n'est écrit avant que le tampon soit plein, ou avant vider() ou la
+ * destruction du rédacteur.
+ */
+class RedacteurRapport
+{
+
+public:
+    explicit RedacteurRapport(std::ostream &p_flux, std::size_t p_taille = 1 << 20);
+    explicit RedacteurRapport(int p_descripteur, std::size_t p_taille = 1 << 20);
+    ~RedacteurRapport();
+
+    RedacteurRapport &operator<<(char p_caractere)
+    {
+        if (m_position == m_tampon.size()) vider();
+        m_tampon[m_position++] = p_caractere;
+        return *this;
+    }
+
+    RedacteurRapport &operator<<(const char *p_texte)
+    {
+        ecrire(p_texte, std::strlen(p_texte));
+        return *this;
+    }
+
+    RedacteurRapport &operator<<(const std::string &p_texte)
+    {
+        ecrire(p_texte.data(), p_texte.size());
+        return *this;
+    }
+
+    RedacteurRapport &operator<<(unsigned long long p_entier);
+    RedacteurRapport &operator<<(unsigned long p_entier)
+    {
+        return *this << (unsigned long long) p_entier;
+    }
+    RedacteurRapport &operator<<(unsigned int p_entier)
+    {
+        return *this << (unsigned long long) p_entier;
+    }
+    RedacteurRapport &operator<<(double p_reel);
+    RedacteurRapport &operator<<(const Heure &p_heure);
+    RedacteurRapport &operator<<(const Date &p_date);
+
+    void ecrire(const char *p_texte, std::size_t p_longueur);
+    void vider();
+
+private:
+    RedacteurRapport(const RedacteurRapport &);
+    RedacteurRapport &operator=(const RedacteurRapport &);
+
+    void deuxChiffres(unsigned int p_valeur);
+
+    std::ostream *m_flux;   //nullptr si le rapport est écrit dans m_descripteur
+    int m_descripteur;
+    std::vector<char> m_tampon;
+    std::size_t m_position; //nombre d'octets en attente dans m_tampon
+};
+
+#endif //RTC_REDACTEUR_RAPPORT_H
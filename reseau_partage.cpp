@@ -0,0 +1,298 @@
+//
+// Réseau en lecture seule, projeté en mémoire (mmap) et partagé entre processus
+//
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include "reseau_partage.h"
+
+using namespace std;
+
+namespace
+{
+    const char MAGIE[8] = {'R', 'T', 'C', 'R', 'E', 'S', 'E', 'A'};
+    const uint32_t VERSION = 1;
+
+    static_assert(sizeof(StationPartagee) == 40, "disposition de StationPartagee");
+    static_assert(sizeof(VoyagePartage) == 32, "disposition de VoyagePartage");
+    static_assert(sizeof(ArretPartage) == 20, "disposition de ArretPartage");
+    static_assert(sizeof(TransfertPartage) == 12, "disposition de TransfertPartage");
+
+    uint32_t secondes(const Heure &p_heure)
+    {
+        return p_heure.getSecondesDepuisMinuit();
+    }
+
+    //! \brief ordre de std::string::compare, celui des trip_id dans m_voyages
+    int comparer(const char *p_a, size_t p_longueurA, const char *p_b, size_t p_longueurB)
+    {
+        const int c = memcmp(p_a, p_b, min(p_longueurA, p_longueurB));
+        if (c != 0) return c;
+        return p_longueurA < p_longueurB ? -1 : p_longueurA > p_longueurB ? 1 : 0;
+    }
+
+    class Textes
+    {
+    public:
+        //! \return la position de p_texte, après son ajout
+        uint32_t ajouter(const string &p_texte)
+        {
+            const uint32_t position = (uint32_t) m_octets.size();
+            m_octets.insert(m_octets.end(), p_texte.begin(), p_texte.end());
+            return position;
+        }
+
+        const vector<char> &getOctets() const
+        {
+            return m_octets;
+        }
+
+    private:
+        vector<char> m_octets;
+    };
+}
+
+//! \brief projette p_fichier en lecture seule
+//! \throws logic_error si le fichier ne peut être ouvert ou n'est pas un réseau partagé valide
+ReseauPartage::ReseauPartage(const std::string &p_fichier) : m_debut(nullptr), m_taille(0), m_entete(nullptr)
+{
+    const int descripteur = open(p_fichier.c_str(), O_RDONLY);
+    if (descripteur < 0) throw logic_error("Impossible d'ouvrir le fichier " + p_fichier + ".");
+    struct stat etat;
+    if (fstat(descripteur, &etat) != 0 || (size_t) etat.st_size < sizeof(EnTete))
+    {
+        close(descripteur);
+        throw logic_error("Le fichier " + p_fichier + " n'est pas un réseau partagé.");
+    }
+    m_taille = (size_t) etat.st_size;
+    void *projection = mmap(nullptr, m_taille, PROT_READ, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (projection == MAP_FAILED) throw logic_error("Impossible de projeter le fichier " + p_fichier + ".");
+    m_debut = static_cast<const char *>(projection);
+    m_entete = reinterpret_cast<const EnTete *>(m_debut);
+
+    // Chaque section doit tenir dans le fichier; le contenu des sections, écrit par ecrire(), n'est pas revérifié
+    const pair<const Section *, size_t> sections[] = {
+            {&m_entete->stations,         sizeof(StationPartagee)},
+            {&m_entete->voyages,          sizeof(VoyagePartage)},
+            {&m_entete->arrets,           sizeof(ArretPartage)},
+            {&m_entete->arretsParStation, sizeof(uint32_t)},
+            {&m_entete->transferts,       sizeof(TransfertPartage)},
+            {&m_entete->textes,           1}
+    };
+    bool valide = memcmp(m_entete->magie, MAGIE, sizeof(MAGIE)) == 0 && m_entete->version == VERSION;
+    for (const auto &s : sections)
+    {
+        valide = valide && s.first->position <= m_taille && s.first->nombre <= (m_taille - s.first->position) / s.second;
+    }
+    if (!valide)
+    {
+        munmap(const_cast<char *>(m_debut), m_taille);
+        throw logic_error("Le fichier " + p_fichier + " n'est pas un réseau partagé valide.");
+    }
+}
+
+ReseauPartage::~ReseauPartage()
+{
+    munmap(const_cast<char *>(m_debut), m_taille);
+}
+
+//! \brief écrit le réseau de p_donnees dans p_fichier
+//! \pre tous les arrêts ont été ajoutés
+//! \throws logic_error si le fichier ne peut être écrit
+void ReseauPartage::ecrire(const DonneesGTFS &p_donnees, const std::string &p_fichier)
+{
+    Textes textes;
+    vector<VoyagePartage> voyages;
+    vector<ArretPartage> arrets;
+    map<pair<const string *, unsigned int>, uint32_t> indicesArrets; //(voyage, numéro de séquence) -> indice
+
+    // m_voyages est déjà trié par trip_id, dans l'ordre de comparer()
+    for (const auto &voyageM : p_donnees.getVoyages())
+    {
+        const Voyage &voyage = voyageM.second;
+        VoyagePartage v;
+        v.id = textes.ajouter(voyageM.first);
+        v.longueurId = (uint32_t) voyageM.first.size();
+        v.destination = textes.ajouter(voyage.getDestination());
+        v.longueurDestination = (uint32_t) voyage.getDestination().size();
+        v.ligne = voyage.getLigne();
+        v.direction = voyage.getDirection();
+        v.premierArret = (uint32_t) arrets.size();
+        v.nbArrets = (uint32_t) voyage.getArrets().size();
+        for (const Arret &arret : voyage.getArrets())
+        {
+            indicesArrets[{&arret.getVoyageId(), arret.getNumeroSequence()}] = (uint32_t) arrets.size();
+            arrets.push_back(ArretPartage{arret.getStationId(), (uint32_t) voyages.size(),
+                                          arret.getNumeroSequence(), secondes(arret.getHeureArrivee()),
+                                          secondes(arret.getHeureDepart())});
+        }
+        voyages.push_back(v);
+    }
+
+    vector<StationPartagee> stations;
+    vector<uint32_t> arretsParStation;
+    for (const auto &stationM : p_donnees.getStations())
+    {
+        const Station &station = stationM.second;
+        StationPartagee s;
+        s.id = stationM.first;
+        s.nom = textes.ajouter(station.getNom());
+        s.longueurNom = (uint32_t) station.getNom().size();
+        s.premierArret = (uint32_t) arretsParStation.size();
+        s.reserve = 0;
+        s.latitude = station.getCoords().getLatitude();
+        s.longitude = station.getCoords().getLongitude();
+        for (const auto &arretM : station.getArrets())
+        {
+            auto it = indicesArrets.find({&arretM.second.getVoyageId(), arretM.second.getNumeroSequence()});
+            if (it != indicesArrets.end()) arretsParStation.push_back(it->second);
+        }
+        s.nbArrets = (uint32_t) arretsParStation.size() - s.premierArret;
+        stations.push_back(s);
+    }
+
+    vector<TransfertPartage> transferts;
+    for (const auto &t : p_donnees.getTransferts())
+    {
+        transferts.push_back(TransfertPartage{get<0>(t), get<1>(t), get<2>(t)});
+    }
+    stable_sort(transferts.begin(), transferts.end(),
+                [](const TransfertPartage &a, const TransfertPartage &b) { return a.depart < b.depart; });
+
+    // Sections alignées sur 8 octets, dans l'ordre de l'en-tête
+    EnTete entete;
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.magie, MAGIE, sizeof(MAGIE));
+    entete.version = VERSION;
+    uint64_t position = sizeof(EnTete);
+    auto placer = [&position](Section &p_section, size_t p_nombre, size_t p_taille) {
+        p_section.position = position;
+        p_section.nombre = p_nombre;
+        position = (position + p_nombre * p_taille + 7) / 8 * 8;
+    };
+    placer(entete.stations, stations.size(), sizeof(StationPartagee));
+    placer(entete.voyages, voyages.size(), sizeof(VoyagePartage));
+    placer(entete.arrets, arrets.size(), sizeof(ArretPartage));
+    placer(entete.arretsParStation, arretsParStation.size(), sizeof(uint32_t));
+    placer(entete.transferts, transferts.size(), sizeof(TransfertPartage));
+    placer(entete.textes, textes.getOctets().size(), 1);
+
+    ofstream fichier(p_fichier, ios::binary | ios::trunc);
+    if (!fichier) throw logic_error("Impossible de créer le fichier " + p_fichier + ".");
+    uint64_t ecrits = 0;
+    auto ecrireSection = [&](const Section &p_section, const void *p_donnees, size_t p_octets) {
+        static const char zeros[8] = {0};
+        fichier.write(zeros, (streamsize) (p_section.position - ecrits));
+        if (p_octets) fichier.write(static_cast<const char *>(p_donnees), (streamsize) p_octets);
+        ecrits = p_section.position + p_octets;
+    };
+    fichier.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    ecrits = sizeof(entete);
+    ecrireSection(entete.stations, stations.data(), stations.size() * sizeof(StationPartagee));
+    ecrireSection(entete.voyages, voyages.data(), voyages.size() * sizeof(VoyagePartage));
+    ecrireSection(entete.arrets, arrets.data(), arrets.size() * sizeof(ArretPartage));
+    ecrireSection(entete.arretsParStation, arretsParStation.data(), arretsParStation.size() * sizeof(uint32_t));
+    ecrireSection(entete.transferts, transferts.data(), transferts.size() * sizeof(TransfertPartage));
+    ecrireSection(entete.textes, textes.getOctets().data(), textes.getOctets().size());
+    fichier.flush();
+    if (!fichier) throw logic_error("Une erreur est survenue lors de l'écriture du fichier " + p_fichier + ".");
+}
+
+std::size_t ReseauPartage::getNbStations() const
+{
+    return (size_t) m_entete->stations.nombre;
+}
+
+std::size_t ReseauPartage::getNbVoyages() const
+{
+    return (size_t) m_entete->voyages.nombre;
+}
+
+std::size_t ReseauPartage::getNbArrets() const
+{
+    return (size_t) m_entete->arrets.nombre;
+}
+
+std::size_t ReseauPartage::getNbTransferts() const
+{
+    return (size_t) m_entete->transferts.nombre;
+}
+
+Plage<StationPartagee> ReseauPartage::getStations() const
+{
+    return section<StationPartagee>(m_entete->stations);
+}
+
+Plage<VoyagePartage> ReseauPartage::getVoyages() const
+{
+    return section<VoyagePartage>(m_entete->voyages);
+}
+
+//! \return la station d'identifiant p_id, nullptr si elle est absente
+const StationPartagee *ReseauPartage::trouverStation(std::uint32_t p_id) const
+{
+    const Plage<StationPartagee> stations = getStations();
+    const StationPartagee *it = lower_bound(stations.begin(), stations.end(), p_id,
+                                            [](const StationPartagee &s, uint32_t id) { return s.id < id; });
+    return it != stations.end() && it->id == p_id ? it : nullptr;
+}
+
+//! \return le voyage de trip_id p_id, nullptr s'il est absent
+const VoyagePartage *ReseauPartage::trouverVoyage(const std::string &p_id) const
+{
+    const Plage<VoyagePartage> voyages = getVoyages();
+    const char *textes = m_debut + m_entete->textes.position;
+    const VoyagePartage *it = lower_bound(voyages.begin(), voyages.end(), p_id,
+                                          [textes](const VoyagePartage &v, const string &id) {
+                                              return comparer(textes + v.id, v.longueurId, id.data(), id.size()) < 0;
+                                          });
+    if (it == voyages.end() || comparer(textes + it->id, it->longueurId, p_id.data(), p_id.size()) != 0)
+        return nullptr;
+    return it;
+}
+
+Plage<ArretPartage> ReseauPartage::getArretsDuVoyage(const VoyagePartage &p_voyage) const
+{
+    const ArretPartage *arrets = section<ArretPartage>(m_entete->arrets).begin();
+    return Plage<ArretPartage>{arrets + p_voyage.premierArret, arrets + p_voyage.premierArret + p_voyage.nbArrets};
+}
+
+//! \return les indices (pour getArret) des arrêts de la station, triés par heure d'arrivée
+Plage<std::uint32_t> ReseauPartage::getArretsDeStation(const StationPartagee &p_station) const
+{
+    const uint32_t *indices = section<uint32_t>(m_entete->arretsParStation).begin();
+    return Plage<uint32_t>{indices + p_station.premierArret, indices + p_station.premierArret + p_station.nbArrets};
+}
+
+const ArretPartage &ReseauPartage::getArret(std::uint32_t p_indice) const
+{
+    return section<ArretPartage>(m_entete->arrets).begin()[p_indice];
+}
+
+const VoyagePartage &ReseauPartage::getVoyage(std::uint32_t p_indice) const
+{
+    return getVoyages().begin()[p_indice];
+}
+
+Plage<TransfertPartage> ReseauPartage::getTransfertsDepuis(std::uint32_t p_station) const
+{
+    const Plage<TransfertPartage> transferts = section<TransfertPartage>(m_entete->transferts);
+    auto plage = equal_range(transferts.begin(), transferts.end(), TransfertPartage{p_station, 0, 0},
+                             [](const TransfertPartage &a, const TransfertPartage &b) { return a.depart < b.depart; });
+    return Plage<TransfertPartage>{plage.first, plage.second};
+}
+
+//! \brief copie un texte de la projection (nom de station, trip_id, destination)
+std::string ReseauPartage::texte(std::uint32_t p_position, std::uint32_t p_longueur) const
+{
+    return string(m_debut + m_entete->textes.position + p_position, p_longueur);
+}
@@ -0,0 +1,155 @@
+//
+// Réseau en lecture seule, projeté en mémoire (mmap) et partagé entre processus
+//
+
+#ifndef RTC_RESEAU_PARTAGE_H
+#define RTC_RESEAU_PARTAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "DonneesGTFS.h"
+
+// Enregistrements du fichier: tailles fixes, aucun pointeur; les textes sont des (position, longueur) dans la
+// section des textes, et les liens entre tables sont des indices.
+
+struct StationPartagee
+{
+    std::uint32_t id;
+    std::uint32_t nom;              //position du nom dans les textes
+    std::uint32_t longueurNom;
+    std::uint32_t premierArret;     //plage [premierArret, premierArret + nbArrets) de la table des arrêts par station
+    std::uint32_t nbArrets;
+    std::uint32_t reserve;
+    double latitude;
+    double longitude;
+};
+
+struct VoyagePartage
+{
+    std::uint32_t id;               //position du trip_id dans les textes
+    std::uint32_t longueurId;
+    std::uint32_t destination;
+    std::uint32_t longueurDestination;
+    std::uint32_t ligne;
+    std::uint32_t direction;
+    std::uint32_t premierArret;     //plage [premierArret, premierArret + nbArrets) de la table des arrêts
+    std::uint32_t nbArrets;
+};
+
+struct ArretPartage
+{
+    std::uint32_t station;
+    std::uint32_t voyage;           //indice dans la table des voyages
+    std::uint32_t numeroSequence;
+    std::uint32_t arrivee;          //secondes depuis minuit
+    std::uint32_t depart;
+};
+
+struct TransfertPartage
+{
+    std::uint32_t depart;
+    std::uint32_t arrivee;
+    std::uint32_t duree;            //secondes
+};
+
+/*!
+ * \struct Plage
+ * \brief Suite contiguë d'enregistrements dans la projection
+ */
+template<typename T>
+struct Plage
+{
+    const T *debut;
+    const T *fin;
+
+    const T *begin() const
+    {
+        return debut;
+    }
+
+    const T *end() const
+    {
+        return fin;
+    }
+
+    std::size_t size() const
+    {
+        return (std::size_t) (fin - debut);
+    }
+};
+
+/*!
+ * \class ReseauPartage
+ * \brief Stations, voyages, arrêts et transferts d'un DonneesGTFS dans un fichier interrogé sur place.
+ *
+ * Le fichier, écrit par ecrire(), ne contient que des positions relatives et des indices: il est projeté en lecture
+ * seule (MAP_SHARED) et interrogé sans aucune désérialisation. Plusieurs processus qui ouvrent le même fichier
+ * partagent donc une seule copie, celle du cache de pages. Les stations sont triées par identifiant, les voyages
+ * par trip_id et les transferts par station de départ; les recherches sont dichotomiques. Les arrêts d'un voyage
+ * sont contigus et triés par numéro de séquence; ceux d'une station sont donnés, triés par heure d'arrivée, par des
+ * indices dans la table des arrêts.
+ */
+class ReseauPartage
+{
+
+public:
+    explicit ReseauPartage(const std::string &p_fichier);
+    ~ReseauPartage();
+
+    static void ecrire(const DonneesGTFS &p_donnees, const std::string &p_fichier);
+
+    std::size_t getNbStations() const;
+    std::size_t getNbVoyages() const;
+    std::size_t getNbArrets() const;
+    std::size_t getNbTransferts() const;
+
+    Plage<StationPartagee> getStations() const;
+    Plage<VoyagePartage> getVoyages() const;
+
+    const StationPartagee *trouverStation(std::uint32_t p_id) const;
+    const VoyagePartage *trouverVoyage(const std::string &p_id) const;
+    Plage<ArretPartage> getArretsDuVoyage(const VoyagePartage &p_voyage) const;
+    Plage<std::uint32_t> getArretsDeStation(const StationPartagee &p_station) const;
+    const ArretPartage &getArret(std::uint32_t p_indice) const;
+    const VoyagePartage &getVoyage(std::uint32_t p_indice) const;
+    Plage<TransfertPartage> getTransfertsDepuis(std::uint32_t p_station) const;
+
+    std::string texte(std::uint32_t p_position, std::uint32_t p_longueur) const;
+
+private:
+    ReseauPartage(const ReseauPartage &);
+    ReseauPartage &operator=(const ReseauPartage &);
+
+    struct Section
+    {
+        std::uint64_t position;
+        std::uint64_t nombre;
+    };
+
+    struct EnTete
+    {
+        char magie[8];
+        std::uint32_t version;
+        std::uint32_t reserve;
+        Section stations;
+        Section voyages;
+        Section arrets;
+        Section arretsParStation;
+        Section transferts;
+        Section textes;
+    };
+
+    template<typename T>
+    Plage<T> section(const Section &p_section) const
+    {
+        const T *debut = reinterpret_cast<const T *>(m_debut + p_section.position);
+        return Plage<T>{debut, debut + p_section.nombre};
+    }
+
+    const char *m_debut;
+    std::size_t m_taille;
+    const EnTete *m_entete;
+};
+
+#endif //RTC_RESEAU_PARTAGE_H
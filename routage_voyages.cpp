@@ -0,0 +1,608 @@
+//
+// Routage "Trip-Based": transferts de voyage à voyage précalculés
+//
+
+#include "routage_voyages.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include "pool_travail.h"
+
+using namespace std;
+
+const unsigned int RoutageParVoyages::INFINI = numeric_limits<unsigned int>::max();
+const unsigned int RoutageParVoyages::DUREE_SEAU = 120;
+
+namespace
+{
+    const char MAGIQUE[4] = {'T', 'B', 'T', 'R'};
+    const uint32_t VERSION_FORMAT = 3;
+
+    unsigned int enSecondes(const Heure &p_heure)
+    {
+        return p_heure.getSecondesDepuisMinuit();
+    }
+
+    //! \brief abaisse p_etiquettes[p_station] à p_heure si c'est une amélioration
+    bool relaxer(vector<unsigned int> &p_etiquettes, vector<unsigned int> &p_touchees, unsigned int p_station,
+                 unsigned int p_heure)
+    {
+        if (p_heure >= p_etiquettes[p_station]) return false;
+        if (p_etiquettes[p_station] == numeric_limits<unsigned int>::max()) p_touchees.push_back(p_station);
+        p_etiquettes[p_station] = p_heure;
+        return true;
+    }
+
+    template<typename T>
+    void ecrire(ofstream &p_flux, const T &p_valeur)
+    {
+        p_flux.write(reinterpret_cast<const char *>(&p_valeur), sizeof(T));
+    }
+
+    template<typename T>
+    void lire(ifstream &p_flux, T &p_valeur)
+    {
+        p_flux.read(reinterpret_cast<char *>(&p_valeur), sizeof(T));
+    }
+}
+
+/*!
+ * \brief construit l'index des voyages et effectue le prétraitement des transferts
+ * \param[in] p_donnees: les données GTFS; tous les arrêts et transferts doivent avoir été ajoutés
+ * \param[in] p_nbFils: le nombre de fils du prétraitement; 0 signifie le nombre de coeurs disponibles
+ */
+RoutageParVoyages::RoutageParVoyages(const DonneesGTFS &p_donnees, unsigned int p_nbFils)
+{
+    construireIndex(p_donnees);
+    PoolTravail pool(p_nbFils);
+    pretraiter(pool);
+}
+
+/*!
+ * \brief construit l'index des voyages et effectue le prétraitement des transferts sur un pool existant
+ * \param[in] p_donnees: les données GTFS; tous les arrêts et transferts doivent avoir été ajoutés
+ * \param[in] p_pool: le pool de fils du prétraitement
+ */
+RoutageParVoyages::RoutageParVoyages(const DonneesGTFS &p_donnees, PoolTravail &p_pool)
+{
+    construireIndex(p_donnees);
+    pretraiter(p_pool);
+}
+
+/*!
+ * \brief construit l'index des voyages et recharge un prétraitement sauvegardé par sauvegarder()
+ * \param[in] p_donnees: les mêmes données GTFS que lors de la sauvegarde
+ * \param[in] p_fichierPretraitement: le fichier binaire de prétraitement
+ * \throws logic_error si le fichier est illisible ou ne correspond pas aux voyages et arrêts chargés
+ */
+RoutageParVoyages::RoutageParVoyages(const DonneesGTFS &p_donnees, const string &p_fichierPretraitement)
+{
+    construireIndex(p_donnees);
+
+    ifstream fichier(p_fichierPretraitement, ios::binary);
+    if (!fichier.good())
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+
+    char magique[4];
+    uint32_t version;
+    uint64_t sig, nbEvenements, nbTransferts;
+    fichier.read(magique, 4);
+    lire(fichier, version);
+    lire(fichier, sig);
+    lire(fichier, nbEvenements);
+    lire(fichier, nbTransferts);
+    if (!fichier || memcmp(magique, MAGIQUE, 4) != 0 || version != VERSION_FORMAT)
+        throw logic_error("Le fichier de prétraitement est invalide.");
+    if (sig != signature() || nbEvenements != m_evenements.size())
+        throw logic_error("Le fichier de prétraitement ne correspond pas aux voyages chargés.");
+
+    m_debutTransferts.resize(nbEvenements + 1);
+    m_transferts.resize(nbTransferts);
+    fichier.read(reinterpret_cast<char *>(m_debutTransferts.data()),
+                 m_debutTransferts.size() * sizeof(unsigned int));
+    fichier.read(reinterpret_cast<char *>(m_transferts.data()), m_transferts.size() * sizeof(Transfert));
+    if (!fichier || m_debutTransferts.back() != nbTransferts)
+        throw logic_error("Une erreur est survenue lors de la lecture du fichier.");
+}
+
+/*!
+ * \brief sauvegarde les transferts précalculés dans un fichier binaire
+ * \param[in] p_nomFichier: le nom du fichier à écrire
+ * \throws logic_error si un problème survient avec l'écriture du fichier
+ */
+void RoutageParVoyages::sauvegarder(const string &p_nomFichier) const
+{
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.good())
+        throw logic_error("Une erreur est survenue lors de l'écriture du fichier.");
+
+    fichier.write(MAGIQUE, 4);
+    ecrire(fichier, VERSION_FORMAT);
+    ecrire(fichier, signature());
+    ecrire(fichier, (uint64_t) m_evenements.size());
+    ecrire(fichier, (uint64_t) m_transferts.size());
+    fichier.write(reinterpret_cast<const char *>(m_debutTransferts.data()),
+                  m_debutTransferts.size() * sizeof(unsigned int));
+    fichier.write(reinterpret_cast<const char *>(m_transferts.data()), m_transferts.size() * sizeof(Transfert));
+    if (!fichier)
+        throw logic_error("Une erreur est survenue lors de l'écriture du fichier.");
+}
+
+//! \brief renumérote stations et voyages, puis range arrêts, départs et transferts à pied en tableaux plats
+void RoutageParVoyages::construireIndex(const DonneesGTFS &p_donnees)
+{
+    for (const auto &stationM : p_donnees.getStations())
+    {
+        m_indexStations.insert({stationM.first, (unsigned int) m_idsStations.size()});
+        m_idsStations.push_back(stationM.first);
+    }
+    const size_t nbStations = m_idsStations.size();
+
+    map<vector<unsigned int>, unsigned int> motifs;
+    vector<unsigned int> sequence;
+    vector<const Voyage *> voyages;
+    unordered_map<const Voyage *, unsigned int> indexVoyages;
+    m_debutVoyages.push_back(0);
+    for (const auto &voyageM : p_donnees.getVoyages())
+    {
+        sequence.clear();
+        for (const Arret &a : voyageM.second.getArrets())
+        {
+            unsigned int station;
+            if (indexStation(a.getStationId(), station))
+            {
+                Evenement e = {station, enSecondes(a.getHeureArrivee()), enSecondes(a.getHeureDepart())};
+                m_evenements.push_back(e);
+                sequence.push_back(station);
+            }
+        }
+        if (sequence.empty()) continue;
+        indexVoyages.insert({&voyageM.second, (unsigned int) voyages.size()});
+        voyages.push_back(&voyageM.second);
+        m_idsVoyages.push_back(voyageM.first);
+        m_motifs.push_back(motifs.insert({sequence, (unsigned int) motifs.size()}).first->second);
+        m_debutVoyages.push_back((unsigned int) m_evenements.size());
+    }
+    // Le voyage suivant du bloc est le prochain voyage retenu de la chaîne: on reste assis entre les deux
+    for (const Voyage *voyage : voyages)
+    {
+        const Voyage *suivant = voyage->getVoyageSuivant();
+        while (suivant && !indexVoyages.count(suivant)) suivant = suivant->getVoyageSuivant();
+        m_voyageSuivant.push_back(suivant ? indexVoyages[suivant] : INFINI);
+    }
+
+    // Voyages d'un même motif par heure de départ: chacun est relié au suivant s'il le domine
+    vector<vector<unsigned int> > parMotif(motifs.size());
+    for (unsigned int v = 0; v < m_idsVoyages.size(); ++v) parMotif[m_motifs[v]].push_back(v);
+    m_voyageDomine.assign(m_idsVoyages.size(), INFINI);
+    for (auto &voyagesMotif : parMotif)
+    {
+        stable_sort(voyagesMotif.begin(), voyagesMotif.end(), [this](unsigned int a, unsigned int b)
+        {
+            return m_evenements[m_debutVoyages[a]].depart < m_evenements[m_debutVoyages[b]].depart;
+        });
+        for (size_t i = 0; i + 1 < voyagesMotif.size(); ++i)
+        {
+            const Depart premier = {0, voyagesMotif[i], 0};
+            const Depart second = {0, voyagesMotif[i + 1], 0};
+            if (estDomine(premier, second))
+                m_voyageDomine[premier.voyage] = second.voyage;
+        }
+    }
+
+    // Départs par station: tous les arrêts sauf le dernier de chaque voyage
+    vector<vector<Depart> > departs(nbStations);
+    for (unsigned int v = 0; v < m_idsVoyages.size(); ++v)
+    {
+        for (unsigned int e = m_debutVoyages[v]; e + 1 < m_debutVoyages[v + 1]; ++e)
+        {
+            Depart d = {m_evenements[e].depart, v, e - m_debutVoyages[v]};
+            departs[m_evenements[e].station].push_back(d);
+        }
+    }
+    for (auto &d : departs)
+    {
+        m_debutDeparts.push_back((unsigned int) m_departs.size());
+        stable_sort(d.begin(), d.end(), [](const Depart &a, const Depart &b) { return a.heure < b.heure; });
+        m_departs.insert(m_departs.end(), d.begin(), d.end());
+    }
+    m_debutDeparts.push_back((unsigned int) m_departs.size());
+
+    vector<vector<Marche> > marches(nbStations), marchesInverses(nbStations);
+    for (const auto &t : p_donnees.getTransferts())
+    {
+        unsigned int de, vers;
+        if (indexStation(get<0>(t), de) && indexStation(get<1>(t), vers))
+        {
+            Marche m = {vers, get<2>(t)};
+            marches[de].push_back(m);
+            Marche mi = {de, get<2>(t)};
+            marchesInverses[vers].push_back(mi);
+        }
+    }
+    for (size_t s = 0; s < nbStations; ++s)
+    {
+        m_debutMarches.push_back((unsigned int) m_marches.size());
+        m_marches.insert(m_marches.end(), marches[s].begin(), marches[s].end());
+        m_debutMarchesInverses.push_back((unsigned int) m_marchesInverses.size());
+        m_marchesInverses.insert(m_marchesInverses.end(), marchesInverses[s].begin(), marchesInverses[s].end());
+    }
+    m_debutMarches.push_back((unsigned int) m_marches.size());
+    m_debutMarchesInverses.push_back((unsigned int) m_marchesInverses.size());
+}
+
+/*!
+ * \brief appelle p_visiter pour chaque départ non dominé à p_station à partir de p_heure
+ * \brief Un départ est dominé si un départ plus tôt du même motif, à la même position, arrive au plus tard
+ * en même temps à chacun des arrêts suivants; sans dépassement entre voyages d'un motif, seul le premier reste.
+ */
+template<typename F>
+void RoutageParVoyages::departsNonDomines(unsigned int p_station, unsigned int p_heure, F p_visiter) const
+{
+    auto debut = m_departs.begin() + m_debutDeparts[p_station];
+    auto fin = m_departs.begin() + m_debutDeparts[p_station + 1];
+    auto it = lower_bound(debut, fin, p_heure, [](const Depart &d, unsigned int h) { return d.heure < h; });
+
+    vector<pair<uint64_t, const Depart *> > retenus;
+    for (; it != fin; ++it)
+    {
+        uint64_t cle = ((uint64_t) m_motifs[it->voyage] << 32) | it->position;
+        bool domine = false;
+        for (const auto &r : retenus)
+        {
+            if (r.first == cle && estDomine(*r.second, *it))
+            {
+                domine = true;
+                break;
+            }
+        }
+        if (domine) continue;
+        retenus.push_back(make_pair(cle, &*it));
+        p_visiter(*it);
+    }
+}
+
+/*!
+ * \brief indique si embarquer à p_premier arrive au plus tard en même temps partout qu'embarquer à p_second
+ * \brief Si le voyage de p_second continue dans un autre voyage de son bloc, ce dernier doit partir de la station
+ * où p_second termine, après l'arrivée de p_premier: on y monte alors en descendant de p_premier.
+ */
+bool RoutageParVoyages::estDomine(const Depart &p_premier, const Depart &p_second) const
+{
+    const unsigned int a = m_debutVoyages[p_premier.voyage] + p_premier.position;
+    const unsigned int b = m_debutVoyages[p_second.voyage] + p_second.position;
+    const unsigned int nb = m_debutVoyages[p_second.voyage + 1] - b;
+    const unsigned int suivant = m_voyageSuivant[p_second.voyage];
+    if (suivant != INFINI && (m_evenements[m_debutVoyages[suivant]].station != m_evenements[b + nb - 1].station ||
+                              m_evenements[m_debutVoyages[suivant]].depart < m_evenements[a + nb - 1].arrivee))
+        return false;
+    for (unsigned int k = 1; k < nb; ++k)
+    {
+        if (m_evenements[a + k].arrivee > m_evenements[b + k].arrivee) return false;
+    }
+    return true;
+}
+
+//! \brief calcule en parallèle les transferts utiles de chaque voyage puis les range par événement
+void RoutageParVoyages::pretraiter(PoolTravail &p_pool)
+{
+    const size_t nbVoyages = m_idsVoyages.size();
+    vector<vector<vector<Transfert> > > parVoyage(nbVoyages);
+
+    vector<vector<unsigned int> > etiquettes(p_pool.getNbFils());
+    vector<vector<unsigned int> > touchees(p_pool.getNbFils());
+    p_pool.executer(nbVoyages, [&](size_t p_voyage, unsigned int p_fil)
+    {
+        if (etiquettes[p_fil].empty()) etiquettes[p_fil].assign(m_idsStations.size(), INFINI);
+        transfertsDuVoyage((unsigned int) p_voyage, etiquettes[p_fil], touchees[p_fil], parVoyage[p_voyage]);
+    }, 16);
+
+    m_debutTransferts.reserve(m_evenements.size() + 1);
+    for (size_t v = 0; v < nbVoyages; ++v)
+    {
+        for (auto &transferts : parVoyage[v])
+        {
+            // La requête cesse de parcourir les transferts d'un arrêt dès qu'ils arrivent trop tard
+            sort(transferts.begin(), transferts.end(),
+                 [](const Transfert &a, const Transfert &b) { return a.arrivee < b.arrivee; });
+            m_debutTransferts.push_back((unsigned int) m_transferts.size());
+            m_transferts.insert(m_transferts.end(), transferts.begin(), transferts.end());
+        }
+    }
+    m_debutTransferts.push_back((unsigned int) m_transferts.size());
+}
+
+/*!
+ * \brief calcule les transferts utiles à partir des arrêts d'un voyage
+ * \brief Les arrêts sont parcourus du dernier au premier; un transfert n'est conservé que s'il améliore
+ * l'heure d'arrivée en véhicule à au moins une station par rapport à ce qui est déjà atteignable en restant
+ * dans le voyage (et les voyages suivants de son bloc) ou par un transfert conservé au même arrêt.
+ * Les transferts d'un arrêt se suffisent ainsi à eux-mêmes, sans ceux des arrêts suivants: une requête peut
+ * ignorer ceux d'un arrêt dont la station a déjà été atteinte plus tôt en véhicule.
+ * Les marches qui suivent une arrivée n'ont pas à être comparées: elles partent aussi de l'arrivée plus tôt.
+ * \param[in] p_voyage: l'indice du voyage
+ * \param[in,out] p_etiquettes: étiquettes de travail par station, à l'infini en entrée et en sortie
+ * \param[in,out] p_touchees: liste de travail des stations touchées
+ * \param[out] p_parEvenement: les transferts conservés pour chaque arrêt du voyage
+ */
+void RoutageParVoyages::transfertsDuVoyage(unsigned int p_voyage, vector<unsigned int> &p_etiquettes,
+                                           vector<unsigned int> &p_touchees,
+                                           vector<vector<Transfert> > &p_parEvenement) const
+{
+    const unsigned int debutV = m_debutVoyages[p_voyage];
+    const unsigned int nb = m_debutVoyages[p_voyage + 1] - debutV;
+    p_parEvenement.assign(nb, vector<Transfert>());
+
+    // Arrivées en restant assis à partir de l'arrêt p_position du voyage p_suite, puis dans les voyages suivants
+    // comme si on y était monté au premier arrêt; les étiquettes remplacées sont notées dans p_annulation
+    typedef vector<pair<unsigned int, unsigned int> > Annulation;
+    Annulation annulation;
+    auto rouler = [&](unsigned int p_suite, unsigned int p_position, Annulation *p_annulation)
+    {
+        bool utile = false;
+        for (; p_suite != INFINI; p_suite = m_voyageSuivant[p_suite], p_position = 1)
+        {
+            for (unsigned int k = m_debutVoyages[p_suite] + p_position; k < m_debutVoyages[p_suite + 1]; ++k)
+            {
+                const Evenement &f = m_evenements[k];
+                if (p_annulation && f.arrivee < p_etiquettes[f.station])
+                    p_annulation->push_back(make_pair(f.station, p_etiquettes[f.station]));
+                utile |= relaxer(p_etiquettes, p_touchees, f.station, f.arrivee);
+            }
+        }
+        return utile;
+    };
+    rouler(m_voyageSuivant[p_voyage], 1, nullptr);
+
+    for (unsigned int i = nb; i-- > 1;)
+    {
+        const Evenement &e = m_evenements[debutV + i];
+        relaxer(p_etiquettes, p_touchees, e.station, e.arrivee);
+
+        auto candidat = [&](const Depart &d)
+        {
+            if (d.voyage == p_voyage) return;
+            if (rouler(d.voyage, d.position + 1, &annulation))
+            {
+                Transfert t = {d.voyage, d.position, m_evenements[m_debutVoyages[d.voyage] + d.position + 1].arrivee};
+                p_parEvenement[i].push_back(t);
+            }
+        };
+
+        departsNonDomines(e.station, e.arrivee, candidat);
+        for (unsigned int m = m_debutMarches[e.station]; m < m_debutMarches[e.station + 1]; ++m)
+        {
+            departsNonDomines(m_marches[m].station, e.arrivee + m_marches[m].duree, candidat);
+        }
+        while (!annulation.empty())
+        {
+            p_etiquettes[annulation.back().first] = annulation.back().second;
+            annulation.pop_back();
+        }
+    }
+
+    for (unsigned int s : p_touchees) p_etiquettes[s] = INFINI;
+    p_touchees.clear();
+}
+
+//! \brief calcule un trajet avec un état de recherche temporaire
+ResultatOD RoutageParVoyages::calculerTrajet(const RequeteOD &p_requete) const
+{
+    EtatRecherche etat;
+    return calculerTrajet(p_requete, etat);
+}
+
+/*!
+ * \brief calcule l'heure d'arrivée au plus tôt à la destination de p_requete par parcours en largeur des segments
+ * \param[in] p_requete: la requête origine-destination
+ * \param[in,out] p_etat: l'état de travail, réutilisé d'une requête à l'autre
+ * \return le résultat; trouve est faux si l'origine ou la destination est inconnue ou inatteignable
+ */
+ResultatOD RoutageParVoyages::calculerTrajet(const RequeteOD &p_requete, EtatRecherche &p_etat) const
+{
+    ResultatOD resultat = {false, Heure(0, 0, 0)};
+
+    if (p_etat.m_indexAtteint.size() != m_idsVoyages.size())
+        p_etat.m_indexAtteint.assign(m_idsVoyages.size(), INFINI);
+    if (p_etat.m_marcheVersDestination.size() != m_idsStations.size())
+    {
+        p_etat.m_marcheVersDestination.assign(m_idsStations.size(), INFINI);
+        p_etat.m_arriveeAssise.assign(m_idsStations.size(), INFINI);
+    }
+    for (unsigned int v : p_etat.m_voyagesTouches) p_etat.m_indexAtteint[v] = INFINI;
+    for (unsigned int s : p_etat.m_stationsCibles) p_etat.m_marcheVersDestination[s] = INFINI;
+    for (unsigned int s : p_etat.m_stationsTouchees) p_etat.m_arriveeAssise[s] = INFINI;
+    p_etat.m_voyagesTouches.clear();
+    p_etat.m_stationsCibles.clear();
+    p_etat.m_stationsTouchees.clear();
+
+    unsigned int origine, destination;
+    if (!indexStation(p_requete.origine, origine) || !indexStation(p_requete.destination, destination))
+        return resultat;
+
+    // Stations à partir desquelles on atteint la destination, avec la durée de marche
+    vector<unsigned int> &versDestination = p_etat.m_marcheVersDestination;
+    relaxer(versDestination, p_etat.m_stationsCibles, destination, 0);
+    for (unsigned int m = m_debutMarchesInverses[destination]; m < m_debutMarchesInverses[destination + 1]; ++m)
+    {
+        relaxer(versDestination, p_etat.m_stationsCibles, m_marchesInverses[m].station, m_marchesInverses[m].duree);
+    }
+
+    const unsigned int depart = enSecondes(p_requete.depart);
+    unsigned int meilleure = versDestination[origine] == INFINI ? INFINI : depart + versDestination[origine];
+
+    // Les segments attendent dans le seau de l'heure d'arrivée de leur premier arrêt à parcourir
+    typedef EtatRecherche::Segment Segment;
+    vector<vector<Segment> > &seaux = p_etat.m_seaux;
+    size_t enAttente = 0;
+    vector<unsigned int> &indexAtteint = p_etat.m_indexAtteint;
+    auto atteindre = [&](unsigned int p_voyage, unsigned int p_debut)
+    {
+        if (indexAtteint[p_voyage] == INFINI) p_etat.m_voyagesTouches.push_back(p_voyage);
+        indexAtteint[p_voyage] = p_debut;
+    };
+    // Monter dans p_voyage pour en parcourir les arrivées à partir de p_debut, la première étant p_arrivee; le
+    // voyage suivant du bloc n'est atteint qu'au bout du parcours
+    auto embarquer = [&](unsigned int p_voyage, unsigned int p_debut, unsigned int p_arrivee)
+    {
+        const unsigned int atteint = indexAtteint[p_voyage];
+        if (p_debut >= atteint) return;
+        atteindre(p_voyage, p_debut);
+        // Un segment qui n'arrive nulle part avant la meilleure arrivée connue n'a pas à être parcouru
+        if (p_arrivee >= meilleure) return;
+        const unsigned int base = m_debutVoyages[p_voyage];
+        Segment s = {p_voyage, base + p_debut, atteint == INFINI ? m_debutVoyages[p_voyage + 1] : base + atteint};
+        const size_t seau = (p_arrivee - depart) / DUREE_SEAU;
+        if (seau >= seaux.size()) seaux.resize(seau + 1);
+        seaux[seau].push_back(s);
+        ++enAttente;
+    };
+
+    auto embarquerInitial = [&](unsigned int p_station, unsigned int p_heure)
+    {
+        const Depart *d = m_departs.data() + m_debutDeparts[p_station];
+        const Depart *fin = m_departs.data() + m_debutDeparts[p_station + 1];
+        d = lower_bound(d, fin, p_heure, [](const Depart &a, unsigned int h) { return a.heure < h; });
+        for (; d != fin && d->heure < meilleure; ++d)
+        {
+            const unsigned int position = d->position + 1;
+            embarquer(d->voyage, position, m_evenements[m_debutVoyages[d->voyage] + position].arrivee);
+            // Les voyages plus tard du motif dominés par celui-ci n'ont pas à être montés à la même station
+            for (unsigned int v = m_voyageDomine[d->voyage]; v != INFINI && position < indexAtteint[v];
+                 v = m_voyageDomine[v])
+            {
+                atteindre(v, position);
+            }
+        }
+    };
+    embarquerInitial(origine, depart);
+    for (unsigned int m = m_debutMarches[origine]; m < m_debutMarches[origine + 1]; ++m)
+    {
+        embarquerInitial(m_marches[m].station, depart + m_marches[m].duree);
+    }
+
+    // Les seaux sont vidés dans l'ordre des heures, ce qui trouve tôt une arrivée à la destination et borne
+    // ensuite le parcours; chaque segment est parcouru en entier
+    for (size_t seau = 0; seau < seaux.size() && enAttente > 0; ++seau)
+    {
+        if (depart + seau * DUREE_SEAU >= meilleure) break;
+        for (size_t i = 0; i < seaux[seau].size(); ++i)
+        {
+            const Segment s = seaux[seau][i];
+            --enAttente;
+            unsigned int k = s.debut;
+            for (; k < s.fin; ++k)
+            {
+                const Evenement &e = m_evenements[k];
+                if (e.arrivee >= meilleure) break;
+                if (versDestination[e.station] != INFINI)
+                    meilleure = min(meilleure, e.arrivee + versDestination[e.station]);
+                // Une arrivée plus tôt à la même station a déjà offert ces transferts, ou mieux en restant assis
+                if (!relaxer(p_etat.m_arriveeAssise, p_etat.m_stationsTouchees, e.station, e.arrivee)) continue;
+                // Les transferts d'un arrêt sont triés par heure d'arrivée au premier arrêt parcouru
+                for (unsigned int t = m_debutTransferts[k]; t < m_debutTransferts[k + 1]; ++t)
+                {
+                    const Transfert &tr = m_transferts[t];
+                    if (tr.arrivee >= meilleure) break;
+                    embarquer(tr.voyage, tr.position + 1, tr.arrivee);
+                }
+            }
+            // Au bout du voyage, on reste assis dans le voyage suivant du bloc, comme si on y était monté au premier
+            // arrêt
+            const unsigned int suite = m_voyageSuivant[s.voyage];
+            if (k == m_debutVoyages[s.voyage + 1] && suite != INFINI)
+                embarquer(suite, 1, m_evenements[m_debutVoyages[suite] + 1].arrivee);
+        }
+    }
+    for (vector<Segment> &segments : seaux) segments.clear();
+
+    if (meilleure != INFINI)
+    {
+        resultat.trouve = true;
+        resultat.arrivee = Heure(0, 0, 0).add_secondes(meilleure);
+    }
+    return resultat;
+}
+
+/*!
+ * \brief calcule un lot de requêtes en parallèle; chaque fil réutilise son propre état de recherche
+ * \param[in] p_requetes: les requêtes origine-destination
+ * \param[in] p_nbFils: le nombre de fils; 0 signifie le nombre de coeurs disponibles
+ * \return les résultats, dans le même ordre que p_requetes
+ */
+vector<ResultatOD> RoutageParVoyages::calculerTrajets(const vector<RequeteOD> &p_requetes,
+                                                      unsigned int p_nbFils) const
+{
+    PoolTravail pool(p_nbFils);
+    return calculerTrajets(p_requetes, pool);
+}
+
+/*!
+ * \brief calcule un lot de requêtes sur un pool existant, dont les fils restent disponibles pour les lots suivants
+ * \param[in] p_requetes: les requêtes origine-destination
+ * \param[in] p_pool: le pool de fils
+ * \return les résultats, dans le même ordre que p_requetes
+ */
+vector<ResultatOD> RoutageParVoyages::calculerTrajets(const vector<RequeteOD> &p_requetes, PoolTravail &p_pool) const
+{
+    ResultatOD defaut = {false, Heure(0, 0, 0)};
+    vector<ResultatOD> resultats(p_requetes.size(), defaut);
+
+    vector<EtatRecherche> etats(p_pool.getNbFils());
+    p_pool.executer(p_requetes.size(), [&](size_t p_tache, unsigned int p_fil)
+    {
+        resultats[p_tache] = calculerTrajet(p_requetes[p_tache], etats[p_fil]);
+    });
+    return resultats;
+}
+
+size_t RoutageParVoyages::getNbVoyages() const
+{
+    return m_idsVoyages.size();
+}
+
+size_t RoutageParVoyages::getNbTransferts() const
+{
+    return m_transferts.size();
+}
+
+//! \brief empreinte (FNV-1a) des voyages, arrêts, blocs et transferts à pied
+//! \brief pour valider un prétraitement sauvegardé
+uint64_t RoutageParVoyages::signature() const
+{
+    uint64_t h = 14695981039346656037ULL;
+    auto melanger = [&h](const void *p_octets, size_t p_taille)
+    {
+        const unsigned char *o = static_cast<const unsigned char *>(p_octets);
+        for (size_t i = 0; i < p_taille; ++i)
+        {
+            h = (h ^ o[i]) * 1099511628211ULL;
+        }
+    };
+    for (const string &id : m_idsVoyages) melanger(id.data(), id.size() + 1);
+    for (const Evenement &e : m_evenements)
+    {
+        melanger(&m_idsStations[e.station], sizeof(unsigned int));
+        melanger(&e.arrivee, sizeof(unsigned int));
+        melanger(&e.depart, sizeof(unsigned int));
+    }
+    for (unsigned int suivant : m_voyageSuivant) melanger(&suivant, sizeof(unsigned int));
+    for (const Marche &m : m_marches)
+    {
+        melanger(&m_idsStations[m.station], sizeof(unsigned int));
+        melanger(&m.duree, sizeof(unsigned int));
+    }
+    return h;
+}
+
+bool RoutageParVoyages::indexStation(unsigned int p_station_id, unsigned int &p_index) const
+{
+    auto it = m_indexStations.find(p_station_id);
+    if (it == m_indexStations.end()) return false;
+    p_index = it->second;
+    return true;
+}
@@ -0,0 +1,146 @@
+//
+// Routage "Trip-Based": transferts de voyage à voyage précalculés
+//
+
+#ifndef RTC_ROUTAGE_VOYAGES_H
+#define RTC_ROUTAGE_VOYAGES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "DonneesGTFS.h"
+#include "planificateur.h"
+
+/*!
+ * \class RoutageParVoyages
+ * \brief Routage Trip-Based sur les voyages chargés dans un objet DonneesGTFS.
+ *
+ * Le prétraitement calcule, pour chaque arrêt de chaque voyage, les transferts utiles vers un arrêt d'un autre
+ * voyage (à la même station ou par un transfert à pied de m_transferts). Pour chaque motif (suite de stations),
+ * seuls les voyages non dominés par un voyage plus tôt du même motif sont retenus, puis les transferts qui
+ * n'améliorent, par rapport au reste du voyage, l'arrivée en véhicule à aucune station sont élagués: seule une
+ * arrivée en véhicule permet de repartir à pied. Une requête parcourt ensuite des segments de voyages rangés dans
+ * des seaux de DUREE_SEAU secondes selon l'heure d'arrivée à leur premier arrêt, les plus tôt d'abord, ce qui
+ * trouve vite une arrivée à la destination et borne le reste du parcours. Les transferts d'un arrêt ne sont
+ * parcourus que s'il arrive à sa station plus tôt que tous les arrêts déjà parcourus, et seulement jusqu'au premier
+ * qui arrive après la meilleure arrivée connue. Au départ, monter dans un voyage rend atteints, à partir du même
+ * arrêt, les voyages plus tard du même motif qu'il domine.
+ *
+ * Comme pour le Planificateur, on reste assis dans le véhicule: au bout d'un voyage parcouru, le voyage suivant de
+ * son bloc est atteint comme si on y était monté au premier arrêt.
+ *
+ * Ce n'est pas toujours plus rapide que le Planificateur: une requête parcourt surtout des transferts, alors que
+ * le balayage des connexions du Planificateur est très compact. Mesuré avec bench_requetes (20000 requêtes, 1 fil):
+ * environ 2,6 fois le débit du Planificateur sur le réseau du RTC, mais environ 0,92 fois sur un réseau
+ * synthétique dense en correspondances (generateur_gtfs).
+ *
+ * Le prétraitement s'exécute en parallèle, au besoin sur un PoolTravail fourni par l'appelant, et peut être
+ * sauvegardé dans un fichier binaire, puis rechargé tant que les voyages et arrêts chargés sont identiques.
+ * Le champ profil des requêtes n'est pas pris en compte: les transferts à pied font partie du prétraitement.
+ */
+class RoutageParVoyages
+{
+
+public:
+    /*!
+     * \class EtatRecherche
+     * \brief État de travail d'une requête, réutilisable d'une requête à l'autre par un même fil
+     */
+    class EtatRecherche
+    {
+    private:
+        friend class RoutageParVoyages;
+        struct Segment
+        {
+            unsigned int voyage;
+            unsigned int debut; //premier événement (index dans m_evenements) dont l'arrivée est à parcourir
+            unsigned int fin;   //événement (exclu) où commence un segment précédent du même voyage
+        };
+        std::vector<std::vector<Segment> > m_seaux; //segments en attente, par tranche de DUREE_SEAU secondes
+        std::vector<unsigned int> m_indexAtteint; //par voyage, premier arrêt dont l'arrivée est déjà parcourue
+        std::vector<unsigned int> m_voyagesTouches;
+        std::vector<unsigned int> m_marcheVersDestination; //durée de marche vers la destination, par station
+        std::vector<unsigned int> m_stationsCibles;
+        std::vector<unsigned int> m_arriveeAssise; //arrivée en véhicule dont les transferts sont déjà parcourus
+        std::vector<unsigned int> m_stationsTouchees;
+    };
+
+    RoutageParVoyages(const DonneesGTFS &p_donnees, unsigned int p_nbFils = 0);
+    RoutageParVoyages(const DonneesGTFS &p_donnees, PoolTravail &p_pool);
+    RoutageParVoyages(const DonneesGTFS &p_donnees, const std::string &p_fichierPretraitement);
+
+    void sauvegarder(const std::string &p_nomFichier) const;
+
+    ResultatOD calculerTrajet(const RequeteOD &p_requete) const;
+    ResultatOD calculerTrajet(const RequeteOD &p_requete, EtatRecherche &p_etat) const;
+    std::vector<ResultatOD> calculerTrajets(const std::vector<RequeteOD> &p_requetes, unsigned int p_nbFils = 0) const;
+    std::vector<ResultatOD> calculerTrajets(const std::vector<RequeteOD> &p_requetes, PoolTravail &p_pool) const;
+
+    std::size_t getNbVoyages() const;
+    std::size_t getNbTransferts() const;
+
+private:
+    struct Evenement //un arrêt d'un voyage
+    {
+        unsigned int station;
+        unsigned int arrivee;
+        unsigned int depart;
+    };
+
+    struct Depart //un départ possible à une station
+    {
+        unsigned int heure;
+        unsigned int voyage;
+        unsigned int position;
+    };
+
+    struct Transfert //vers l'arrêt position du voyage voyage
+    {
+        unsigned int voyage;
+        unsigned int position;
+        unsigned int arrivee; //arrivée à l'arrêt position + 1, le premier parcouru après le transfert
+    };
+
+    struct Marche
+    {
+        unsigned int station;
+        unsigned int duree;
+    };
+
+    static const unsigned int INFINI;
+    static const unsigned int DUREE_SEAU;
+
+    void construireIndex(const DonneesGTFS &p_donnees);
+    void pretraiter(PoolTravail &p_pool);
+    void transfertsDuVoyage(unsigned int p_voyage, std::vector<unsigned int> &p_etiquettes,
+                            std::vector<unsigned int> &p_touchees,
+                            std::vector<std::vector<Transfert> > &p_parEvenement) const;
+    template<typename F>
+    void departsNonDomines(unsigned int p_station, unsigned int p_heure, F p_visiter) const;
+    bool estDomine(const Depart &p_premier, const Depart &p_second) const;
+    std::uint64_t signature() const;
+    bool indexStation(unsigned int p_station_id, unsigned int &p_index) const;
+
+    std::unordered_map<unsigned int, unsigned int> m_indexStations; //stop_id -> index dense
+    std::vector<unsigned int> m_idsStations;
+
+    std::vector<std::string> m_idsVoyages;
+    std::vector<unsigned int> m_motifs; //motif (suite de stations) de chaque voyage
+    std::vector<unsigned int> m_voyageSuivant; //voyage suivant du même bloc (véhicule), INFINI s'il n'y en a pas
+    std::vector<unsigned int> m_voyageDomine;  //voyage suivant du même motif dominé partout par celui-ci, ou INFINI
+    std::vector<unsigned int> m_debutVoyages; //m_evenements[m_debutVoyages[v], m_debutVoyages[v+1]) sont les arrêts de v
+    std::vector<Evenement> m_evenements;
+
+    std::vector<unsigned int> m_debutDeparts; //départs par station, triés par heure
+    std::vector<Depart> m_departs;
+    std::vector<unsigned int> m_debutMarches; //transferts à pied par station de départ
+    std::vector<Marche> m_marches;
+    std::vector<unsigned int> m_debutMarchesInverses; //transferts à pied par station d'arrivée
+    std::vector<Marche> m_marchesInverses;
+
+    std::vector<unsigned int> m_debutTransferts; //transferts précalculés par événement
+    std::vector<Transfert> m_transferts;
+};
+
+#endif //RTC_ROUTAGE_VOYAGES_H
@@ -0,0 +1,295 @@
+//
+// Schémas typés des fichiers GTFS: colonnes déclarées à la compilation, résolues une fois par fichier
+//
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include "schemas_gtfs.h"
+
+using namespace std;
+
+const Colonne<RangeeRoutes> RangeeRoutes::COLONNES[] = {
+        RTC_COLONNE(RangeeRoutes, route_id, true),
+        RTC_COLONNE(RangeeRoutes, route_short_name, true),
+        RTC_COLONNE(RangeeRoutes, route_desc, true),
+        RTC_COLONNE(RangeeRoutes, route_color, true)
+};
+const size_t RangeeRoutes::NB_COLONNES = sizeof(RangeeRoutes::COLONNES) / sizeof(RangeeRoutes::COLONNES[0]);
+
+const Colonne<RangeeStops> RangeeStops::COLONNES[] = {
+        RTC_COLONNE(RangeeStops, stop_id, true),
+        RTC_COLONNE(RangeeStops, stop_name, true),
+        RTC_COLONNE(RangeeStops, stop_desc, true),
+        RTC_COLONNE(RangeeStops, stop_lat, true),
+        RTC_COLONNE(RangeeStops, stop_lon, true)
+};
+const size_t RangeeStops::NB_COLONNES = sizeof(RangeeStops::COLONNES) / sizeof(RangeeStops::COLONNES[0]);
+
+const Colonne<RangeeCalendarDates> RangeeCalendarDates::COLONNES[] = {
+        RTC_COLONNE(RangeeCalendarDates, service_id, true),
+        RTC_COLONNE(RangeeCalendarDates, date, true),
+        RTC_COLONNE(RangeeCalendarDates, exception_type, true)
+};
+const size_t RangeeCalendarDates::NB_COLONNES =
+        sizeof(RangeeCalendarDates::COLONNES) / sizeof(RangeeCalendarDates::COLONNES[0]);
+
+const Colonne<RangeeTrips> RangeeTrips::COLONNES[] = {
+        RTC_COLONNE(RangeeTrips, route_id, true),
+        RTC_COLONNE(RangeeTrips, service_id, true),
+        RTC_COLONNE(RangeeTrips, trip_id, true),
+        RTC_COLONNE(RangeeTrips, trip_headsign, true),
+        RTC_COLONNE(RangeeTrips, direction_id, false),
+        RTC_COLONNE(RangeeTrips, block_id, false)
+};
+const size_t RangeeTrips::NB_COLONNES = sizeof(RangeeTrips::COLONNES) / sizeof(RangeeTrips::COLONNES[0]);
+
+const Colonne<RangeeStopTimes> RangeeStopTimes::COLONNES[] = {
+        RTC_COLONNE(RangeeStopTimes, trip_id, true),
+        RTC_COLONNE(RangeeStopTimes, arrival_time, true),
+        RTC_COLONNE(RangeeStopTimes, departure_time, true),
+        RTC_COLONNE(RangeeStopTimes, stop_id, true),
+        RTC_COLONNE(RangeeStopTimes, stop_sequence, true)
+};
+const size_t RangeeStopTimes::NB_COLONNES = sizeof(RangeeStopTimes::COLONNES) / sizeof(RangeeStopTimes::COLONNES[0]);
+
+const Colonne<RangeeTransfers> RangeeTransfers::COLONNES[] = {
+        RTC_COLONNE(RangeeTransfers, from_stop_id, true),
+        RTC_COLONNE(RangeeTransfers, to_stop_id, true),
+        RTC_COLONNE(RangeeTransfers, min_transfer_time, false)
+};
+const size_t RangeeTransfers::NB_COLONNES = sizeof(RangeeTransfers::COLONNES) / sizeof(RangeeTransfers::COLONNES[0]);
+
+namespace
+{
+    const char *const NOMBRE_INVALIDE = "nombre invalide";
+    const char *const HORS_LIMITES = "valeur hors limites";
+    const char *const HEURE_INVALIDE = "heure invalide";
+
+    bool estChiffre(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    const char *sauterEspaces(const char *c, const char *p_fin)
+    {
+        while (c < p_fin && (*c == ' ' || *c == '\t')) ++c;
+        return c;
+    }
+
+    //! \brief convertit un entier décimal au début de [p_debut, p_fin[ comme stoi: espaces et signe permis, le reste
+    //! \brief du champ est ignoré
+    //! \param[out] p_suite: la position qui suit le dernier chiffre lu
+    //! \return nullptr, ou la raison de l'échec
+    const char *lireEntier(const char *p_debut, const char *p_fin, unsigned int &p_valeur, const char *&p_suite)
+    {
+        const char *c = sauterEspaces(p_debut, p_fin);
+        bool negatif = false;
+        if (c < p_fin && (*c == '-' || *c == '+'))
+        {
+            negatif = *c == '-';
+            ++c;
+        }
+        if (c == p_fin || *c < '0' || *c > '9') return NOMBRE_INVALIDE;
+        long long valeur = 0;
+        for (; c < p_fin && *c >= '0' && *c <= '9'; ++c)
+        {
+            valeur = valeur * 10 + (*c - '0');
+            if (valeur > (long long) INT_MAX + 1) return HORS_LIMITES;
+        }
+        if (negatif) valeur = -valeur;
+        if (valeur > INT_MAX) return HORS_LIMITES;
+        p_valeur = (unsigned int) (int) valeur;
+        p_suite = c;
+        return nullptr;
+    }
+
+    //! \brief repli pour les réels que lireReel ne convertit pas exactement (plus de 19 chiffres significatifs ou
+    //! \brief exposant au-delà de 10^22); strtod exige une chaîne terminée par '\0'
+    const char *lireReelStrtod(const LecteurCSV::Champ &p_champ, double &p_valeur)
+    {
+        char tampon[64];
+        string long_champ;
+        const char *texte = tampon;
+        if (p_champ.longueur < sizeof(tampon))
+        {
+            memcpy(tampon, p_champ.debut, p_champ.longueur);
+            tampon[p_champ.longueur] = '\0';
+        }
+        else
+        {
+            long_champ.assign(p_champ.debut, p_champ.longueur);
+            texte = long_champ.c_str();
+        }
+        char *fin;
+        errno = 0;
+        const double valeur = strtod(texte, &fin);
+        if (fin == texte) return NOMBRE_INVALIDE;
+        if (errno == ERANGE) return HORS_LIMITES;
+        p_valeur = valeur;
+        return nullptr;
+    }
+
+    /*!
+     * \brief convertit un réel décimal ([signe] chiffres [. chiffres] [e [signe] chiffres]) au début du champ
+     *
+     * Les chiffres significatifs sont accumulés dans un entier m et l'exposant décimal dans e. Si m < 2^53 et
+     * |e| <= 22, m et 10^|e| sont des doubles exacts et une seule multiplication ou division, correctement arrondie,
+     * donne le même résultat que strtod; c'est le cas de toutes les coordonnées GTFS. Sinon, strtod prend le relais.
+     */
+    const char *lireReel(const LecteurCSV::Champ &p_champ, double &p_valeur)
+    {
+        static const double PUISSANCES[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        const char *fin = p_champ.debut + p_champ.longueur;
+        const char *c = sauterEspaces(p_champ.debut, fin);
+        bool negatif = false;
+        if (c < fin && (*c == '-' || *c == '+'))
+        {
+            negatif = *c == '-';
+            ++c;
+        }
+
+        unsigned long long mantisse = 0;
+        int chiffres = 0;      //chiffres significatifs accumulés dans mantisse
+        int exposant = 0;
+        bool unChiffre = false;
+        bool exact = true;
+        for (; c < fin && *c >= '0' && *c <= '9'; ++c)
+        {
+            unChiffre = true;
+            if (chiffres < 19)
+            {
+                mantisse = mantisse * 10 + (unsigned) (*c - '0');
+                if (mantisse) ++chiffres;
+            } else
+            {
+                ++exposant;
+                exact = false;
+            }
+        }
+        if (c < fin && *c == '.')
+        {
+            for (++c; c < fin && *c >= '0' && *c <= '9'; ++c)
+            {
+                unChiffre = true;
+                if (chiffres < 19)
+                {
+                    mantisse = mantisse * 10 + (unsigned) (*c - '0');
+                    if (mantisse) ++chiffres;
+                    --exposant;
+                } else if (*c != '0')
+                {
+                    exact = false;
+                }
+            }
+        }
+        if (!unChiffre) return lireReelStrtod(p_champ, p_valeur); //inf, nan, 0x...: laissés à strtod
+        if (c < fin && (*c == 'e' || *c == 'E'))
+        {
+            const char *suite = c + 1;
+            bool exposantNegatif = false;
+            if (suite < fin && (*suite == '-' || *suite == '+'))
+            {
+                exposantNegatif = *suite == '-';
+                ++suite;
+            }
+            if (suite < fin && *suite >= '0' && *suite <= '9')
+            {
+                int valeur = 0;
+                for (; suite < fin && *suite >= '0' && *suite <= '9'; ++suite)
+                {
+                    if (valeur < 100000) valeur = valeur * 10 + (*suite - '0');
+                }
+                exposant += exposantNegatif ? -valeur : valeur;
+            }
+        }
+
+        if (!exact || mantisse > (1ULL << 53) || exposant < -22 || exposant > 22)
+            return lireReelStrtod(p_champ, p_valeur);
+        double valeur = (double) mantisse;
+        valeur = exposant < 0 ? valeur / PUISSANCES[-exposant] : valeur * PUISSANCES[exposant];
+        p_valeur = negatif ? -valeur : valeur;
+        return nullptr;
+    }
+}
+
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, std::string &p_valeur)
+{
+    p_valeur.assign(p_champ.debut, p_champ.longueur);
+    return nullptr;
+}
+
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, unsigned int &p_valeur)
+{
+    const char *suite;
+    return lireEntier(p_champ.debut, p_champ.debut + p_champ.longueur, p_valeur, suite);
+}
+
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, double &p_valeur)
+{
+    return lireReel(p_champ, p_valeur);
+}
+
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, HeureGTFS &p_valeur)
+{
+    // Forme usuelle H:MM:SS ou HH:MM:SS: lue directement, sans recherche des ':' ni boucle sur les chiffres
+    const char *h = p_champ.debut;
+    const size_t n = p_champ.longueur;
+    if (n >= 7 && estChiffre(h[0]))
+    {
+        const size_t d = estChiffre(h[1]) ? 2 : 1; //position du premier ':'
+        if (n >= d + 6 && h[d] == ':' && estChiffre(h[d + 1]) && estChiffre(h[d + 2]) && h[d + 3] == ':' &&
+            estChiffre(h[d + 4]) && estChiffre(h[d + 5]) && (n == d + 6 || !estChiffre(h[d + 6])))
+        {
+            p_valeur.heures = d == 2 ? (unsigned) (h[0] - '0') * 10 + (unsigned) (h[1] - '0') : (unsigned) (h[0] - '0');
+            p_valeur.minutes = (unsigned) (h[d + 1] - '0') * 10 + (unsigned) (h[d + 2] - '0');
+            p_valeur.secondes = (unsigned) (h[d + 4] - '0') * 10 + (unsigned) (h[d + 5] - '0');
+            return nullptr;
+        }
+    }
+
+    const char *fin = p_champ.debut + p_champ.longueur;
+    unsigned int *parties[] = {&p_valeur.heures, &p_valeur.minutes, &p_valeur.secondes};
+    const char *c = p_champ.debut;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        if (i > 0)
+        {
+            c = static_cast<const char *>(memchr(c, ':', (size_t) (fin - c)));
+            if (!c) return HEURE_INVALIDE;
+            ++c;
+        }
+        if (lireEntier(c, fin, *parties[i], c)) return HEURE_INVALIDE;
+    }
+    return nullptr;
+}
+
+//! \brief découpe l'en-tête en noms de colonnes, sans guillemets, '\r' ni marque d'ordre d'octets UTF-8
+std::vector<std::string> nomsColonnes(const std::string &p_entete)
+{
+    vector<string> noms;
+    string::size_type debut = 0;
+    if (p_entete.compare(0, 3, "\xEF\xBB\xBF") == 0) debut = 3;
+    for (;;)
+    {
+        string::size_type fin = p_entete.find(',', debut);
+        string nom = p_entete.substr(debut, fin == string::npos ? string::npos : fin - debut);
+        string propre;
+        for (char c : nom)
+            if (c != '"' && c != '\r') propre += c;
+        noms.push_back(propre);
+        if (fin == string::npos) break;
+        debut = fin + 1;
+    }
+    return noms;
+}
+
+//! \return la position de p_nom dans p_noms, -1 s'il en est absent
+int positionColonne(const std::vector<std::string> &p_noms, const char *p_nom)
+{
+    for (size_t i = 0; i < p_noms.size(); ++i)
+        if (p_noms[i] == p_nom) return (int) i;
+    return -1;
+}
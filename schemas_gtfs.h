@@ -0,0 +1,273 @@
+//
+// Schémas typés des fichiers GTFS: colonnes déclarées à la compilation, résolues une fois par fichier
+//
+
+#ifndef RTC_SCHEMAS_GTFS_H
+#define RTC_SCHEMAS_GTFS_H
+
+#include <cstddef>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "diagnostics_chargement.h"
+#include "lecteur_csv.h"
+
+/*!
+ * \struct HeureGTFS
+ * \brief Une heure HH:MM:SS de stop_times.txt; les heures peuvent dépasser 24
+ */
+struct HeureGTFS
+{
+    unsigned int heures = 0;
+    unsigned int minutes = 0;
+    unsigned int secondes = 0;
+};
+
+// Conversions d'un champ vers le type d'un membre, à la manière de from_chars: ni exception, ni allocation, ni
+// dépendance à la locale. Comme stoi et stod, les espaces et le signe sont permis au début et seul le préfixe
+// numérique compte. Chacune retourne nullptr si la conversion réussit, sinon la raison de l'échec.
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, std::string &p_valeur);
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, unsigned int &p_valeur);
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, double &p_valeur);
+const char *convertirChamp(const LecteurCSV::Champ &p_champ, HeureGTFS &p_valeur);
+
+/*!
+ * \struct Colonne
+ * \brief Une colonne d'un schéma: son nom dans l'en-tête et la conversion vers son membre de la rangée
+ *
+ * Les colonnes se déclarent avec RTC_COLONNE, qui instancie une conversion propre au type du membre: aucune
+ * recherche par nom ni conversion générique n'a lieu pendant la lecture des rangées.
+ */
+template<typename Rangee>
+struct Colonne
+{
+    const char *nom;
+    bool obligatoire;
+    const char *(*convertir)(const LecteurCSV::Champ &, Rangee &); //nullptr, ou la raison de l'échec
+    void (*reinitialiser)(Rangee &);
+};
+
+template<typename Rangee, typename T, T Rangee::*Membre>
+const char *convertirMembre(const LecteurCSV::Champ &p_champ, Rangee &p_rangee)
+{
+    return convertirChamp(p_champ, p_rangee.*Membre);
+}
+
+template<typename Rangee, typename T, T Rangee::*Membre>
+void reinitialiserMembre(Rangee &p_rangee)
+{
+    p_rangee.*Membre = T();
+}
+
+#define RTC_COLONNE(Rangee, membre, obligatoire) \
+    {#membre, obligatoire, &convertirMembre<Rangee, decltype(Rangee::membre), &Rangee::membre>, \
+     &reinitialiserMembre<Rangee, decltype(Rangee::membre), &Rangee::membre>}
+
+// Une rangée par fichier GTFS; les membres portent le nom de leur colonne et seules les colonnes utilisées par
+// DonneesGTFS sont déclarées. Une colonne facultative absente ou vide vaut la valeur par défaut du membre.
+
+struct RangeeRoutes
+{
+    unsigned int route_id = 0;
+    std::string route_short_name;
+    std::string route_desc;
+    std::string route_color;
+    static const Colonne<RangeeRoutes> COLONNES[];
+    static const std::size_t NB_COLONNES;
+};
+
+struct RangeeStops
+{
+    unsigned int stop_id = 0;
+    std::string stop_name;
+    std::string stop_desc;
+    double stop_lat = 0;
+    double stop_lon = 0;
+    static const Colonne<RangeeStops> COLONNES[];
+    static const std::size_t NB_COLONNES;
+};
+
+struct RangeeCalendarDates
+{
+    std::string service_id;
+    unsigned int date = 0; //AAAAMMJJ
+    unsigned int exception_type = 0;
+    static const Colonne<RangeeCalendarDates> COLONNES[];
+    static const std::size_t NB_COLONNES;
+};
+
+struct RangeeTrips
+{
+    unsigned int route_id = 0;
+    std::string service_id;
+    std::string trip_id;
+    std::string trip_headsign;
+    unsigned int direction_id = 0;
+    std::string block_id;
+    static const Colonne<RangeeTrips> COLONNES[];
+    static const std::size_t NB_COLONNES;
+};
+
+struct RangeeStopTimes
+{
+    std::string trip_id;
+    HeureGTFS arrival_time;
+    HeureGTFS departure_time;
+    unsigned int stop_id = 0;
+    unsigned int stop_sequence = 0;
+    static const Colonne<RangeeStopTimes> COLONNES[];
+    static const std::size_t NB_COLONNES;
+};
+
+struct RangeeTransfers
+{
+    unsigned int from_stop_id = 0;
+    unsigned int to_stop_id = 0;
+    unsigned int min_transfer_time = 0;
+    static const Colonne<RangeeTransfers> COLONNES[];
+    static const std::size_t NB_COLONNES;
+};
+
+std::vector<std::string> nomsColonnes(const std::string &p_entete);
+int positionColonne(const std::vector<std::string> &p_noms, const char *p_nom);
+
+/*!
+ * \class LecteurTable
+ * \brief Lit les rangées typées d'un fichier GTFS selon le schéma Rangee::COLONNES.
+ *
+ * Les positions des colonnes sont trouvées une seule fois, dans l'en-tête, quel que soit leur ordre dans le
+ * fichier; seules les colonnes jusqu'à la dernière colonne du schéma sont découpées (voir LecteurCSV). Avec une
+ * colonne clé, le prédicat est évalué sur le champ brut avant toute conversion.
+ *
+ * Un champ qui ne se convertit pas est signalé aux diagnostics donnés par signalerA(), qui sautent la rangée ou
+ * lèvent une logic_error selon leur politique; sans diagnostics, il lève une logic_error.
+ */
+template<typename Rangee>
+class LecteurTable
+{
+
+public:
+    LecteurTable(std::istream &p_flux, const char *p_colonneCle = nullptr);
+
+    bool suivante(Rangee &p_rangee);
+    template<typename Predicat>
+    bool suivante(Rangee &p_rangee, Predicat p_garder);
+
+    void signalerA(DiagnosticsChargement &p_diagnostics, const char *p_fichier);
+
+    unsigned long long getNbLignes() const
+    {
+        return m_lecteur.getNbLignes();
+    }
+
+    unsigned long long getNbOctets() const
+    {
+        return m_lecteur.getNbOctets();
+    }
+
+private:
+    bool convertir(Rangee &p_rangee) const;
+    void signaler(std::size_t p_colonne, const char *p_raison) const;
+
+    LecteurCSV m_lecteur;
+    std::vector<int> m_positions; //position dans le fichier de chaque colonne du schéma, -1 si absente
+    unsigned int m_cle;
+    DiagnosticsChargement *m_diagnostics;
+    const char *m_fichier;
+};
+
+//! \brief lit l'en-tête et y trouve les colonnes du schéma
+//! \param[in] p_colonneCle: le nom de la colonne examinée par le prédicat de suivante(), s'il y a lieu
+//! \throws logic_error si une colonne obligatoire ou la colonne clé est absente de l'en-tête
+template<typename Rangee>
+LecteurTable<Rangee>::LecteurTable(std::istream &p_flux, const char *p_colonneCle)
+        : m_lecteur(p_flux, 0), m_cle(0), m_diagnostics(nullptr), m_fichier("")
+{
+    const std::vector<std::string> noms = nomsColonnes(m_lecteur.getEntete());
+    int derniere = 0;
+    for (std::size_t i = 0; i < Rangee::NB_COLONNES; ++i)
+    {
+        const Colonne<Rangee> &colonne = Rangee::COLONNES[i];
+        const int position = positionColonne(noms, colonne.nom);
+        if (position < 0 && colonne.obligatoire)
+            throw std::logic_error(std::string("La colonne ") + colonne.nom + " est absente de l'en-tête.");
+        m_positions.push_back(position);
+        if (position > derniere) derniere = position;
+    }
+    if (p_colonneCle)
+    {
+        const int position = positionColonne(noms, p_colonneCle);
+        if (position < 0)
+            throw std::logic_error(std::string("La colonne ") + p_colonneCle + " est absente de l'en-tête.");
+        m_cle = (unsigned int) position;
+        if (position > derniere) derniere = position;
+    }
+    m_lecteur.setDerniereColonne((unsigned int) derniere);
+}
+
+//! \brief lit la prochaine rangée dont tous les champs se convertissent
+//! \return false à la fin du flux
+//! \throws logic_error si un champ ne se convertit pas et que la politique n'est pas de sauter la rangée
+template<typename Rangee>
+bool LecteurTable<Rangee>::suivante(Rangee &p_rangee)
+{
+    while (m_lecteur.suivante())
+    {
+        if (convertir(p_rangee)) return true;
+    }
+    return false;
+}
+
+//! \brief lit la prochaine rangée dont le champ de la colonne clé satisfait p_garder
+//! \return false à la fin du flux
+template<typename Rangee>
+template<typename Predicat>
+bool LecteurTable<Rangee>::suivante(Rangee &p_rangee, Predicat p_garder)
+{
+    while (m_lecteur.suivante(m_cle, p_garder))
+    {
+        if (convertir(p_rangee)) return true;
+    }
+    return false;
+}
+
+//! \brief envoie les champs invalides à p_diagnostics, sous le nom de fichier p_fichier (qui doit survivre au lecteur)
+template<typename Rangee>
+void LecteurTable<Rangee>::signalerA(DiagnosticsChargement &p_diagnostics, const char *p_fichier)
+{
+    m_diagnostics = &p_diagnostics;
+    m_fichier = p_fichier;
+}
+
+//! \return false si un champ ne se convertit pas; la rangée est alors incomplète
+template<typename Rangee>
+bool LecteurTable<Rangee>::convertir(Rangee &p_rangee) const
+{
+    for (std::size_t i = 0; i < Rangee::NB_COLONNES; ++i)
+    {
+        const Colonne<Rangee> &colonne = Rangee::COLONNES[i];
+        const int position = m_positions[i];
+        if (position < 0 || (!colonne.obligatoire && m_lecteur[(unsigned int) position].longueur == 0))
+        {
+            colonne.reinitialiser(p_rangee);
+        } else if (const char *raison = colonne.convertir(m_lecteur[(unsigned int) position], p_rangee))
+        {
+            signaler(i, raison);
+            return false;
+        }
+    }
+    return true;
+}
+
+//! \throws logic_error si la politique des diagnostics est d'échouer, ou s'il n'y a pas de diagnostics
+template<typename Rangee>
+void LecteurTable<Rangee>::signaler(std::size_t p_colonne, const char *p_raison) const
+{
+    DiagnosticChamp diagnostic{m_fichier, m_lecteur.getNbLignes() + 1, Rangee::COLONNES[p_colonne].nom, p_raison,
+                               m_lecteur[(unsigned int) m_positions[p_colonne]].str()};
+    if (!m_diagnostics) throw std::logic_error("Champ invalide: " + diagnostic.texte());
+    m_diagnostics->signaler(diagnostic);
+}
+
+#endif //RTC_SCHEMAS_GTFS_H
@@ -4,6 +4,8 @@
 //
 
 #include "station.h"
+#include <algorithm>
+#include "voyage.h"
 
 /*!
  * \brief Constructeur de la classe Station.
@@ -70,13 +72,22 @@ unsigned int Station::getId() const
     return m_id;
 }
 
-void Station::addArret(const Arret::Ptr &p_arret)
+/*!
+ * \brief ajoute un arrêt à la station, après ceux qui arrivent à la même heure
+ * \param[in] p_voyage: le voyage de l'arrêt, qui doit survivre à la station
+ * \param[in] p_position: le rang de l'arrêt dans p_voyage (et non son numéro de séquence)
+ * \param[in] p_heure_arrivee: l'heure d'arrivée de l'arrêt
+ */
+void Station::addArret(const Voyage &p_voyage, unsigned int p_position, const Heure &p_heure_arrivee)
 {
-    m_arrets.insert({p_arret->getHeureArrivee(), p_arret});
+    std::vector<Arrets::Passage> &passages = m_arrets.m_passages;
+    auto position = std::upper_bound(passages.begin(), passages.end(), p_heure_arrivee,
+                                     [](const Heure &h, const Arrets::Passage &p) { return h < p.arrivee; });
+    passages.insert(position, Arrets::Passage{&p_voyage, p_position, p_heure_arrivee});
 }
 
-//! \brief retourne le conteneur m_arrets par référence constante
-const std::multimap<Heure, Arret::Ptr> &Station::getArrets() const
+//! \brief retourne la vue m_arrets par référence constante
+const Station::Arrets &Station::getArrets() const
 {
     return m_arrets;
 }
@@ -86,6 +97,48 @@ unsigned int Station::getNbArrets() const
     return (unsigned int) m_arrets.size();
 }
 
+Station::Arrets::const_iterator Station::Arrets::begin() const
+{
+    return const_iterator(m_passages.data(), m_passages.data() + m_passages.size());
+}
+
+Station::Arrets::const_iterator Station::Arrets::end() const
+{
+    const Passage *fin = m_passages.data() + m_passages.size();
+    return const_iterator(fin, fin);
+}
+
+std::size_t Station::Arrets::size() const
+{
+    return m_passages.size();
+}
+
+bool Station::Arrets::empty() const
+{
+    return m_passages.empty();
+}
+
+Station::Arrets::const_iterator::const_iterator(const Passage *p_passage, const Passage *p_fin)
+        : m_passage(p_passage), m_fin(p_fin)
+{
+    lire();
+}
+
+Station::Arrets::const_iterator &Station::Arrets::const_iterator::operator++()
+{
+    ++m_passage;
+    lire();
+    return *this;
+}
+
+//! \brief relit l'arrêt courant dans les horaires de son voyage
+void Station::Arrets::const_iterator::lire()
+{
+    if (m_passage == m_fin) return;
+    m_courant.first = m_passage->arrivee;
+    m_courant.second = m_passage->voyage->getArret(m_passage->position);
+}
+
 
 
 
@@ -6,24 +6,84 @@
 #ifndef RTC_STATION_H
 #define RTC_STATION_H
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
 #include <unordered_set>
 #include <iostream>
+#include "arene.h"
 #include "coordonnees.h"
 #include "arret.h"
 #include "auxiliaires.h"
 
+class Voyage;
+
 /*!
  * \class Station
  * \brief Classe représentant une station. Une station est un emplacement physique où un bus effectue des arrêts.
  * \note Sa déclaration nécessite la déclaration partielle des classe Ligne et Voyage, en raison de références circulaires avec ces classes.
+ *
+ * Une station ne garde de ses arrêts que le voyage et le rang de chacun: l'arrêt est relu dans les horaires du
+ * voyage (voir HorairesCompresses), qui doit donc survivre à la station.
  */
 class Station {
 
 
 public:
+    /*!
+     * \class Arrets
+     * \brief Vue sur les arrêts d'une station, triés par heure d'arrivée: des paires (heure d'arrivée, arrêt)
+     * \note La paire référencée par un itérateur change quand on l'avance: copier l'Arret à garder.
+     */
+    class Arrets
+    {
+    private:
+        struct Passage //un arrêt d'un voyage à la station
+        {
+            const Voyage *voyage;
+            unsigned int position; //rang de l'arrêt dans le voyage
+            Heure arrivee;
+        };
+
+    public:
+        class const_iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef std::pair<Heure, Arret> value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const value_type *pointer;
+            typedef const value_type &reference;
+
+            const value_type &operator*() const { return m_courant; }
+            const value_type *operator->() const { return &m_courant; }
+            const_iterator &operator++();
+            bool operator==(const const_iterator &p_autre) const { return m_passage == p_autre.m_passage; }
+            bool operator!=(const const_iterator &p_autre) const { return m_passage != p_autre.m_passage; }
+
+        private:
+            friend class Arrets;
+            const_iterator(const Passage *p_passage, const Passage *p_fin);
+            void lire();
+
+            const Passage *m_passage;
+            const Passage *m_fin;
+            value_type m_courant;
+        };
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        std::size_t size() const;
+        bool empty() const;
+
+    private:
+        friend class Station;
+        std::vector<Passage> m_passages;
+    };
+
     Station(unsigned int p_id, const std::string & p_nom, const std::string & p_description,const Coordonnees & p_coords);
     Station();
     friend std::ostream& operator<<(std::ostream& flux, const Station& p_station);
@@ -31,18 +91,21 @@ public:
 	const std::string& getDescription() const;
 	const std::string& getNom() const;
 	unsigned int getId() const;
-    void addArret(const Arret::Ptr & p_arret);
+    void addArret(const Voyage & p_voyage, unsigned int p_position, const Heure & p_heure_arrivee);
     unsigned int getNbArrets() const;
-    const std::multimap<Heure, Arret::Ptr> & getArrets() const;
+    const Arrets & getArrets() const;
 
 private:
     unsigned int m_id;
     std::string m_nom;
     std::string m_description;
     Coordonnees m_coords;
-    std::multimap<Heure, Arret::Ptr> m_arrets;
+    Arrets m_arrets;
 
 };
 
+//! \brief stations par identifiant, dont les nœuds sont puisés dans l'arène de DonneesGTFS
+typedef std::map<unsigned int, Station, std::less<unsigned int>, AllocateurArene<std::pair<const unsigned int, Station> > >
+        TableStations;
 
 #endif //RTC_STATION_H
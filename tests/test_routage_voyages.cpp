@@ -0,0 +1,155 @@
+//
+// Test de régression du routage Trip-Based: mêmes heures d'arrivée que le Planificateur
+//
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "DonneesGTFS.h"
+#include "planificateur.h"
+#include "routage_voyages.h"
+
+using namespace std;
+
+namespace
+{
+    void ecrireFichier(const string &p_nomFichier, const string &p_contenu)
+    {
+        ofstream fichier(p_nomFichier, ios::trunc);
+        fichier << p_contenu;
+        if (!fichier)
+        {
+            cerr << "Impossible d'écrire " << p_nomFichier << endl;
+            exit(1);
+        }
+    }
+
+    /*!
+     * \brief écrit un petit réseau qui réunit les cas où le routage Trip-Based s'est déjà trompé:
+     * \brief - de 9, on marche vers 6, mais on ne peut pas marcher de nouveau vers 10 sans être revenu à 6 en
+     *          véhicule: par la boucle 1-1 (6, 7, 6, 8), ou plus tôt par 1-3 jusqu'à 7 puis 1-4 (7, 6, 8), dans
+     *          lequel on pouvait aussi monter à 6 directement (1-2 ne sert qu'à garder 9 et 10);
+     * \brief - 2-1 suit 2-0 dans le bloc B2 mais part d'une autre station (haut-le-pied): on y reste assis;
+     * \brief - 2-2 et 2-3 ont le même motif que 2-0; 2-3 dépasse 2-2.
+     */
+    void ecrireReseau(const string &p_dossier)
+    {
+        ecrireFichier(p_dossier + "/routes.txt",
+                      "route_id,agency_id,route_short_name,route_long_name,route_desc,route_type,route_url,"
+                      "route_color,route_text_color\n"
+                      "1,T,\"1\",,\"Boucle\",3,,97BF0D,FFFFFF\n"
+                      "2,T,\"2\",,\"Bloc\",3,,013888,FFFFFF\n");
+        string stops = "stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,wheelchair_boarding\n";
+        for (int s = 1; s <= 10; ++s)
+        {
+            stops += to_string(s) + ",\"Arret " + to_string(s) + "\",,46.80" + to_string(s) + ",-71.20" +
+                     to_string(s) + ",,0,1\n";
+        }
+        ecrireFichier(p_dossier + "/stops.txt", stops);
+        ecrireFichier(p_dossier + "/calendar_dates.txt", "service_id,date,exception_type\nS,20170818,1\n");
+        ecrireFichier(p_dossier + "/trips.txt",
+                      "route_id,service_id,trip_id,trip_headsign,trip_short_name,direction_id,block_id,shape_id,"
+                      "wheelchair_accessible\n"
+                      "1,S,1-1,\"8\",,0,,,1\n"
+                      "1,S,1-2,\"10\",,0,,,1\n"
+                      "1,S,1-3,\"7\",,0,,,1\n"
+                      "1,S,1-4,\"8\",,0,,,1\n"
+                      "2,S,2-0,\"3\",,0,B2,,1\n"
+                      "2,S,2-1,\"5\",,0,B2,,1\n"
+                      "2,S,2-2,\"3\",,0,,,1\n"
+                      "2,S,2-3,\"3\",,0,,,1\n");
+        ecrireFichier(p_dossier + "/stop_times.txt",
+                      "trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type\n"
+                      "1-1,08:05:00,08:05:00,6,1,0,0\n"
+                      "1-1,08:10:00,08:10:00,7,2,0,0\n"
+                      "1-1,08:20:00,08:20:00,6,3,0,0\n"
+                      "1-1,08:30:00,08:30:00,8,4,0,0\n"
+                      "1-2,11:00:00,11:00:00,9,1,0,0\n"
+                      "1-2,11:10:00,11:10:00,10,2,0,0\n"
+                      "1-3,08:02:00,08:02:00,6,1,0,0\n"
+                      "1-3,08:05:00,08:05:00,7,2,0,0\n"
+                      "1-4,08:10:00,08:10:00,7,1,0,0\n"
+                      "1-4,08:15:00,08:15:00,6,2,0,0\n"
+                      "1-4,08:20:00,08:20:00,8,3,0,0\n"
+                      "2-0,08:00:00,08:00:00,1,1,0,0\n"
+                      "2-0,08:05:00,08:05:00,2,2,0,0\n"
+                      "2-0,08:10:00,08:10:00,3,3,0,0\n"
+                      "2-1,08:20:00,08:20:00,4,1,0,0\n"
+                      "2-1,08:30:00,08:30:00,5,2,0,0\n"
+                      "2-2,08:02:00,08:02:00,1,1,0,0\n"
+                      "2-2,08:12:00,08:12:00,2,2,0,0\n"
+                      "2-2,08:14:00,08:14:00,3,3,0,0\n"
+                      "2-3,08:03:00,08:03:00,1,1,0,0\n"
+                      "2-3,08:06:00,08:06:00,2,2,0,0\n"
+                      "2-3,08:08:00,08:08:00,3,3,0,0\n");
+        ecrireFichier(p_dossier + "/transfers.txt",
+                      "from_stop_id,to_stop_id,transfer_type,min_transfer_time\n"
+                      "9,6,2,60\n"
+                      "6,10,2,60\n"
+                      "3,7,2,120\n"
+                      "8,1,2,300\n");
+    }
+
+    bool verifier(const RoutageParVoyages &p_routage, unsigned int p_origine, unsigned int p_destination,
+                  const Heure &p_depart, const Heure &p_attendue)
+    {
+        RequeteOD requete = {p_origine, p_destination, p_depart, PROFIL_DEFAUT};
+        ResultatOD resultat = p_routage.calculerTrajet(requete);
+        if (resultat.trouve && resultat.arrivee == p_attendue) return true;
+        cerr << p_origine << " -> " << p_destination << " à " << p_depart << ": attendu " << p_attendue << ", obtenu "
+             << (resultat.trouve ? resultat.arrivee : Heure(0, 0, 0)) << endl;
+        return false;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const string dossier = argc > 1 ? argv[1] : ".";
+    ecrireReseau(dossier);
+
+    Date date(2017, 8, 18);
+    Heure debut(8, 0, 0);
+    DonneesGTFS donnees(date, debut, debut.add_secondes(4 * 3600));
+    donnees.ajouterLignes(dossier + "/routes.txt");
+    donnees.ajouterStations(dossier + "/stops.txt");
+    donnees.ajouterServices(dossier + "/calendar_dates.txt");
+    donnees.ajouterVoyagesDeLaDate(dossier + "/trips.txt");
+    donnees.ajouterArretsDesVoyagesDeLaDate(dossier + "/stop_times.txt");
+    donnees.ajouterTransferts(dossier + "/transfers.txt");
+
+    Planificateur planificateur(donnees);
+    RoutageParVoyages routage(donnees, 1);
+
+    bool succes = true;
+    succes &= verifier(routage, 9, 10, Heure(8, 0, 0), Heure(8, 16, 0)); //retour assis à 6, puis marche vers 10
+    succes &= verifier(routage, 9, 10, Heure(8, 6, 0), Heure(11, 10, 0)); //plus de retour assis à 6: 1-2
+    succes &= verifier(routage, 1, 5, Heure(8, 0, 0), Heure(8, 30, 0));  //assis de 2-0 à 2-1
+    succes &= verifier(routage, 1, 3, Heure(8, 1, 0), Heure(8, 8, 0));   //2-3 dépasse 2-2
+
+    size_t nbRequetes = 0, nbDifferences = 0;
+    for (unsigned int origine = 1; origine <= 10; ++origine)
+    {
+        for (unsigned int destination = 1; destination <= 10; ++destination)
+        {
+            for (unsigned int secondes = 0; secondes <= 40 * 60; secondes += 30)
+            {
+                RequeteOD requete = {origine, destination, debut.add_secondes(secondes), PROFIL_DEFAUT};
+                ResultatOD attendu = planificateur.calculerTrajet(requete);
+                ResultatOD obtenu = routage.calculerTrajet(requete);
+                ++nbRequetes;
+                if (attendu.trouve != obtenu.trouve || (attendu.trouve && !(attendu.arrivee == obtenu.arrivee)))
+                {
+                    if (nbDifferences++ < 5)
+                        cerr << origine << " -> " << destination << " à " << requete.depart << ": Planificateur "
+                             << (attendu.trouve ? attendu.arrivee : Heure(0, 0, 0)) << ", Trip-Based "
+                             << (obtenu.trouve ? obtenu.arrivee : Heure(0, 0, 0)) << endl;
+                }
+            }
+        }
+    }
+    cout << nbRequetes << " requetes, " << nbDifferences << " differences" << endl;
+
+    return succes && nbDifferences == 0 ? 0 : 1;
+}
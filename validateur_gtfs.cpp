@@ -0,0 +1,422 @@
+//
+// Vérifications de cohérence d'un GTFS, faites en parallèle et hors des chemins de chargement
+//
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "pool_travail.h"
+#include "schemas_gtfs.h"
+#include "validateur_gtfs.h"
+
+using namespace std;
+
+namespace
+{
+    Anomalie anomalie(TypeAnomalie p_type, const string &p_source, unsigned long long p_ligne,
+                      const string &p_identifiant, const string &p_detail)
+    {
+        return Anomalie{p_type, p_source, p_ligne, p_identifiant, p_detail};
+    }
+
+    unsigned int enSecondes(const HeureGTFS &p_heure)
+    {
+        return (p_heure.heures * 60 + p_heure.minutes) * 60 + p_heure.secondes;
+    }
+
+    string texteSequence(const RangeeStopTimes &p_rangee)
+    {
+        return "stop_sequence " + to_string(p_rangee.stop_sequence);
+    }
+
+    //! \brief vérifie un voyage chargé: ligne, service, et pour chaque arrêt station, heures et intervalle
+    void validerVoyage(const DonneesGTFS &p_donnees, const Voyage &p_voyage, vector<Anomalie> &p_anomalies)
+    {
+        const string id = p_voyage.getId();
+        if (!p_donnees.getLignes().count(p_voyage.getLigne()))
+            p_anomalies.push_back(anomalie(TypeAnomalie::LIGNE_INCONNUE, "voyages", 0, id,
+                                           "ligne " + to_string(p_voyage.getLigne())));
+        if (!p_donnees.getServices().count(p_voyage.getServiceId()))
+            p_anomalies.push_back(anomalie(TypeAnomalie::HORS_FENETRE, "voyages", 0, id,
+                                           "service " + p_voyage.getServiceId() + " absent de la date"));
+
+        Arret precedent; //copie de l'arrêt précédent: la vue réutilise l'arrêt courant
+        bool premier = true;
+        auto sequence = [](const Arret &p_arret) { return "arrêt " + to_string(p_arret.getNumeroSequence()); };
+        for (const Arret &a : p_voyage.getArrets())
+        {
+            if (!p_donnees.getStations().count(a.getStationId()))
+                p_anomalies.push_back(anomalie(TypeAnomalie::STATION_INCONNUE, "voyages", 0, id,
+                                               sequence(a) + ": station " + to_string(a.getStationId())));
+            if (a.getHeureDepart() < a.getHeureArrivee())
+                p_anomalies.push_back(anomalie(TypeAnomalie::HEURES_NON_CROISSANTES, "voyages", 0, id,
+                                               sequence(a) + ": départ avant l'arrivée"));
+            if (!premier && a.getHeureArrivee() < precedent.getHeureDepart())
+                p_anomalies.push_back(anomalie(TypeAnomalie::HEURES_NON_CROISSANTES, "voyages", 0, id,
+                                               sequence(a) + ": arrivée avant le départ de l'arrêt précédent"));
+            if (a.getHeureDepart() < p_donnees.getTempsDebut() || a.getHeureArrivee() >= p_donnees.getTempsFin())
+                p_anomalies.push_back(anomalie(TypeAnomalie::HORS_FENETRE, "voyages", 0, id,
+                                               sequence(a) + ": hors de l'intervalle de temps"));
+            precedent = a;
+            premier = false;
+        }
+    }
+
+    void validerTransferts(const DonneesGTFS &p_donnees, vector<Anomalie> &p_anomalies)
+    {
+        for (const auto &t : p_donnees.getTransferts())
+        {
+            for (unsigned int station : {get<0>(t), get<1>(t)})
+            {
+                if (!p_donnees.getStations().count(station))
+                    p_anomalies.push_back(anomalie(TypeAnomalie::STATION_INCONNUE, "transferts", 0,
+                                                   to_string(station), "transfert " + to_string(get<0>(t)) + " -> " +
+                                                                       to_string(get<1>(t))));
+            }
+        }
+    }
+
+    /*!
+     * \brief Ce que la première vague de validerFichiers retient pour la seconde
+     */
+    struct IdentifiantsGTFS
+    {
+        unordered_set<unsigned int> stations;
+        unordered_set<unsigned int> lignes;
+        unordered_set<string> voyages;
+        vector<tuple<unsigned long long, unsigned int, string> > referencesLignes; //(ligne, route_id, trip_id) de trips.txt
+    };
+
+    //! \brief ouvre p_dossier/p_nom; un fichier absent n'est pas validé, comme il n'est pas chargé
+    bool ouvrir(const string &p_dossier, const char *p_nom, ifstream &p_fichier)
+    {
+        p_fichier.open(p_dossier + "/" + p_nom, ios::binary);
+        return p_fichier.good();
+    }
+
+    void validerStops(const string &p_dossier, IdentifiantsGTFS &p_ids, vector<Anomalie> &p_anomalies)
+    {
+        ifstream fichier;
+        if (!ouvrir(p_dossier, "stops.txt", fichier)) return;
+        LecteurTable<RangeeStops> lecteur(fichier);
+        RangeeStops rangee;
+        while (lecteur.suivante(rangee))
+        {
+            if (!p_ids.stations.insert(rangee.stop_id).second)
+                p_anomalies.push_back(anomalie(TypeAnomalie::IDENTIFIANT_EN_DOUBLE, "stops.txt",
+                                               lecteur.getNbLignes() + 1, to_string(rangee.stop_id), "stop_id"));
+        }
+    }
+
+    void validerRoutes(const string &p_dossier, IdentifiantsGTFS &p_ids, vector<Anomalie> &p_anomalies)
+    {
+        ifstream fichier;
+        if (!ouvrir(p_dossier, "routes.txt", fichier)) return;
+        LecteurTable<RangeeRoutes> lecteur(fichier);
+        RangeeRoutes rangee;
+        CategorieBus categorie;
+        while (lecteur.suivante(rangee))
+        {
+            const unsigned long long ligne = lecteur.getNbLignes() + 1;
+            if (!p_ids.lignes.insert(rangee.route_id).second)
+                p_anomalies.push_back(anomalie(TypeAnomalie::IDENTIFIANT_EN_DOUBLE, "routes.txt", ligne,
+                                               to_string(rangee.route_id), "route_id"));
+            if (!Ligne::couleurConnue(rangee.route_color, categorie))
+                p_anomalies.push_back(anomalie(TypeAnomalie::COULEUR_INCONNUE, "routes.txt", ligne,
+                                               to_string(rangee.route_id), "couleur " + rangee.route_color));
+        }
+    }
+
+    void validerTrips(const string &p_dossier, IdentifiantsGTFS &p_ids, vector<Anomalie> &p_anomalies)
+    {
+        ifstream fichier;
+        if (!ouvrir(p_dossier, "trips.txt", fichier)) return;
+        LecteurTable<RangeeTrips> lecteur(fichier);
+        RangeeTrips rangee;
+        while (lecteur.suivante(rangee))
+        {
+            const unsigned long long ligne = lecteur.getNbLignes() + 1;
+            if (!p_ids.voyages.insert(rangee.trip_id).second)
+                p_anomalies.push_back(anomalie(TypeAnomalie::IDENTIFIANT_EN_DOUBLE, "trips.txt", ligne,
+                                               rangee.trip_id, "trip_id"));
+            p_ids.referencesLignes.push_back(make_tuple(ligne, rangee.route_id, rangee.trip_id));
+        }
+    }
+
+    //! \brief références de trips.txt vers routes.txt, une fois les deux fichiers lus
+    void validerReferencesLignes(const IdentifiantsGTFS &p_ids, vector<Anomalie> &p_anomalies)
+    {
+        for (const auto &reference : p_ids.referencesLignes)
+        {
+            if (!p_ids.lignes.count(get<1>(reference)))
+                p_anomalies.push_back(anomalie(TypeAnomalie::LIGNE_INCONNUE, "trips.txt", get<0>(reference),
+                                               get<2>(reference), "route_id " + to_string(get<1>(reference))));
+        }
+    }
+
+    //! \brief références et ordre des rangées de stop_times.txt: numéros de séquence strictement croissants et
+    //! \brief heures non décroissantes d'une rangée à la suivante d'un même voyage
+    void validerStopTimes(const string &p_dossier, const IdentifiantsGTFS &p_ids, vector<Anomalie> &p_anomalies)
+    {
+        ifstream fichier;
+        if (!ouvrir(p_dossier, "stop_times.txt", fichier)) return;
+        LecteurTable<RangeeStopTimes> lecteur(fichier);
+        RangeeStopTimes rangee;
+
+        struct Dernier
+        {
+            unsigned int sequence;
+            unsigned int depart;
+        };
+        unordered_map<string, Dernier> derniers(p_ids.voyages.size());
+
+        while (lecteur.suivante(rangee))
+        {
+            const unsigned long long ligne = lecteur.getNbLignes() + 1;
+            const unsigned int arrivee = enSecondes(rangee.arrival_time);
+            const unsigned int depart = enSecondes(rangee.departure_time);
+
+            if (!p_ids.voyages.count(rangee.trip_id))
+                p_anomalies.push_back(anomalie(TypeAnomalie::VOYAGE_INCONNU, "stop_times.txt", ligne,
+                                               rangee.trip_id, "trip_id"));
+            if (!p_ids.stations.count(rangee.stop_id))
+                p_anomalies.push_back(anomalie(TypeAnomalie::STATION_INCONNUE, "stop_times.txt", ligne,
+                                               rangee.trip_id, "stop_id " + to_string(rangee.stop_id)));
+            if (depart < arrivee)
+                p_anomalies.push_back(anomalie(TypeAnomalie::HEURES_NON_CROISSANTES, "stop_times.txt", ligne,
+                                               rangee.trip_id, texteSequence(rangee) + ": départ avant l'arrivée"));
+
+            auto dernier = derniers.find(rangee.trip_id);
+            if (dernier == derniers.end())
+            {
+                derniers.insert({rangee.trip_id, Dernier{rangee.stop_sequence, depart}});
+                continue;
+            }
+            if (rangee.stop_sequence <= dernier->second.sequence)
+                p_anomalies.push_back(anomalie(TypeAnomalie::SEQUENCE_NON_CROISSANTE, "stop_times.txt", ligne,
+                                               rangee.trip_id, texteSequence(rangee) + " après " +
+                                                               to_string(dernier->second.sequence)));
+            else if (arrivee < dernier->second.depart)
+                p_anomalies.push_back(anomalie(TypeAnomalie::HEURES_NON_CROISSANTES, "stop_times.txt", ligne,
+                                               rangee.trip_id,
+                                               texteSequence(rangee) + ": arrivée avant le départ de l'arrêt précédent"));
+            dernier->second = Dernier{rangee.stop_sequence, depart};
+        }
+    }
+
+    void validerTransfers(const string &p_dossier, const IdentifiantsGTFS &p_ids, vector<Anomalie> &p_anomalies)
+    {
+        ifstream fichier;
+        if (!ouvrir(p_dossier, "transfers.txt", fichier)) return;
+        LecteurTable<RangeeTransfers> lecteur(fichier);
+        RangeeTransfers rangee;
+        while (lecteur.suivante(rangee))
+        {
+            for (unsigned int station : {rangee.from_stop_id, rangee.to_stop_id})
+            {
+                if (!p_ids.stations.count(station))
+                    p_anomalies.push_back(anomalie(TypeAnomalie::STATION_INCONNUE, "transfers.txt",
+                                                   lecteur.getNbLignes() + 1, to_string(station), "stop_id"));
+            }
+        }
+    }
+}
+
+RapportValidation::RapportValidation()
+{
+    fill(m_nbParType, m_nbParType + NB_TYPES, 0);
+}
+
+void RapportValidation::ajouter(const Anomalie &p_anomalie)
+{
+    m_anomalies.push_back(p_anomalie);
+    ++m_nbParType[(size_t) p_anomalie.type];
+}
+
+void RapportValidation::fusionner(const std::vector<Anomalie> &p_anomalies)
+{
+    for (const Anomalie &a : p_anomalies)
+    {
+        ajouter(a);
+    }
+}
+
+//! \brief ordonne les anomalies par source, ligne, identifiant puis type; le rapport ne dépend donc pas de la
+//! \brief répartition du travail entre les fils
+void RapportValidation::trier()
+{
+    stable_sort(m_anomalies.begin(), m_anomalies.end(), [](const Anomalie &a, const Anomalie &b) {
+        if (a.source != b.source) return a.source < b.source;
+        if (a.ligne != b.ligne) return a.ligne < b.ligne;
+        if (a.identifiant != b.identifiant) return a.identifiant < b.identifiant;
+        return a.type < b.type;
+    });
+}
+
+bool RapportValidation::estValide() const
+{
+    return m_anomalies.empty();
+}
+
+std::size_t RapportValidation::getNbAnomalies() const
+{
+    return m_anomalies.size();
+}
+
+std::size_t RapportValidation::getNbAnomalies(TypeAnomalie p_type) const
+{
+    return m_nbParType[(size_t) p_type];
+}
+
+const std::vector<Anomalie> &RapportValidation::getAnomalies() const
+{
+    return m_anomalies;
+}
+
+const char *RapportValidation::nomType(TypeAnomalie p_type)
+{
+    switch (p_type)
+    {
+        case TypeAnomalie::SEQUENCE_NON_CROISSANTE:
+            return "SEQUENCE_NON_CROISSANTE";
+        case TypeAnomalie::HEURES_NON_CROISSANTES:
+            return "HEURES_NON_CROISSANTES";
+        case TypeAnomalie::STATION_INCONNUE:
+            return "STATION_INCONNUE";
+        case TypeAnomalie::LIGNE_INCONNUE:
+            return "LIGNE_INCONNUE";
+        case TypeAnomalie::VOYAGE_INCONNU:
+            return "VOYAGE_INCONNU";
+        case TypeAnomalie::IDENTIFIANT_EN_DOUBLE:
+            return "IDENTIFIANT_EN_DOUBLE";
+        case TypeAnomalie::COULEUR_INCONNUE:
+            return "COULEUR_INCONNUE";
+        case TypeAnomalie::HORS_FENETRE:
+            return "HORS_FENETRE";
+    }
+    return "?";
+}
+
+//! \brief écrit le nombre d'anomalies par type, puis une anomalie par ligne au format "source:ligne: TYPE id: détail"
+void RapportValidation::afficher(RedacteurRapport &p_redacteur) const
+{
+    p_redacteur << "VALIDATION: " << (unsigned long) m_anomalies.size() << " anomalie(s)\n";
+    for (size_t t = 0; t < NB_TYPES; ++t)
+    {
+        if (m_nbParType[t])
+            p_redacteur << "  " << nomType((TypeAnomalie) t) << ": " << (unsigned long) m_nbParType[t] << '\n';
+    }
+    for (const Anomalie &a : m_anomalies)
+    {
+        p_redacteur << a.source << ':';
+        if (a.ligne) p_redacteur << a.ligne << ':';
+        p_redacteur << ' ' << nomType(a.type) << ' ' << a.identifiant << ": " << a.detail << '\n';
+    }
+}
+
+/*!
+ * \brief Valide à la fois les données chargées et les fichiers dont elles proviennent, les deux en parallèle
+ * \param[in] p_donnees: les données chargées à partir de p_dossier
+ * \param[in] p_dossier: le dossier GTFS
+ * \param[in] p_nbFils: le nombre de fils de chaque validation; 0 signifie le nombre de coeurs disponibles
+ * \return le rapport trié des deux validations
+ */
+RapportValidation ValidateurGTFS::valider(const DonneesGTFS &p_donnees, const std::string &p_dossier,
+                                          unsigned int p_nbFils)
+{
+    future<RapportValidation> fichiers = async(launch::async, [&]() {
+        return validerFichiers(p_dossier, p_nbFils);
+    });
+    RapportValidation rapport = validerDonnees(p_donnees, p_nbFils);
+    rapport.fusionner(fichiers.get().getAnomalies());
+    rapport.trier();
+    return rapport;
+}
+
+/*!
+ * \brief Valide les voyages, leurs arrêts et les transferts déjà chargés, répartis sur un PoolTravail
+ * \param[in] p_donnees: les données à valider; elles ne doivent pas être modifiées pendant la validation
+ * \param[in] p_nbFils: le nombre de fils; 0 signifie le nombre de coeurs disponibles
+ * \return le rapport trié
+ */
+RapportValidation ValidateurGTFS::validerDonnees(const DonneesGTFS &p_donnees, unsigned int p_nbFils)
+{
+    vector<const Voyage *> voyages;
+    voyages.reserve(p_donnees.getVoyages().size());
+    for (const auto &v : p_donnees.getVoyages())
+    {
+        voyages.push_back(&v.second);
+    }
+
+    PoolTravail pool(p_nbFils);
+    vector<vector<Anomalie> > parFil(pool.getNbFils());
+    // Une tâche par voyage, et une dernière pour les transferts
+    pool.executer(voyages.size() + 1, [&](size_t p_tache, unsigned int p_fil) {
+        if (p_tache < voyages.size())
+            validerVoyage(p_donnees, *voyages[p_tache], parFil[p_fil]);
+        else
+            validerTransferts(p_donnees, parFil[p_fil]);
+    });
+
+    RapportValidation rapport;
+    for (const vector<Anomalie> &anomalies : parFil)
+    {
+        rapport.fusionner(anomalies);
+    }
+    rapport.trier();
+    return rapport;
+}
+
+/*!
+ * \brief Relit les fichiers d'un dossier GTFS: stops.txt, routes.txt et trips.txt en parallèle, puis les références
+ * \brief de trips.txt, stop_times.txt et transfers.txt en parallèle
+ * \param[in] p_dossier: le dossier GTFS; les fichiers absents ne sont pas validés
+ * \param[in] p_nbFils: le nombre de fils; 0 signifie le nombre de coeurs disponibles
+ * \return le rapport trié
+ * \throws logic_error si une colonne obligatoire manque à l'en-tête d'un fichier
+ */
+RapportValidation ValidateurGTFS::validerFichiers(const std::string &p_dossier, unsigned int p_nbFils)
+{
+    IdentifiantsGTFS ids;
+    vector<vector<Anomalie> > parFichier(6);
+    PoolTravail pool(p_nbFils, 1);
+
+    pool.executer(3, [&](size_t p_tache, unsigned int) {
+        switch (p_tache)
+        {
+            case 0:
+                validerStops(p_dossier, ids, parFichier[0]);
+                break;
+            case 1:
+                validerRoutes(p_dossier, ids, parFichier[1]);
+                break;
+            default:
+                validerTrips(p_dossier, ids, parFichier[2]);
+        }
+    });
+    pool.executer(3, [&](size_t p_tache, unsigned int) {
+        switch (p_tache)
+        {
+            case 0:
+                validerReferencesLignes(ids, parFichier[3]);
+                break;
+            case 1:
+                validerStopTimes(p_dossier, ids, parFichier[4]);
+                break;
+            default:
+                validerTransfers(p_dossier, ids, parFichier[5]);
+        }
+    });
+
+    RapportValidation rapport;
+    for (const vector<Anomalie> &anomalies : parFichier)
+    {
+        rapport.fusionner(anomalies);
+    }
+    rapport.trier();
+    return rapport;
+}
@@ -0,0 +1,92 @@
+//
+// Vérifications de cohérence d'un GTFS, faites en parallèle et hors des chemins de chargement
+//
+
+#ifndef RTC_VALIDATEUR_GTFS_H
+#define RTC_VALIDATEUR_GTFS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "DonneesGTFS.h"
+#include "redacteur_rapport.h"
+
+/*!
+ * \enum TypeAnomalie
+ * \brief Nature d'une incohérence relevée par ValidateurGTFS
+ */
+enum class TypeAnomalie
+{
+    SEQUENCE_NON_CROISSANTE,  //stop_sequence qui ne croît pas d'une rangée à la suivante d'un même voyage
+    HEURES_NON_CROISSANTES,   //départ avant l'arrivée, ou arrivée avant le départ de l'arrêt précédent
+    STATION_INCONNUE,         //stop_id sans station
+    LIGNE_INCONNUE,           //route_id sans ligne
+    VOYAGE_INCONNU,           //trip_id de stop_times.txt absent de trips.txt
+    IDENTIFIANT_EN_DOUBLE,    //stop_id, route_id ou trip_id déjà vu dans le même fichier
+    COULEUR_INCONNUE,         //route_color sans catégorie de bus (chargée comme CategorieBus::LEBUS)
+    HORS_FENETRE              //voyage hors des services de la date, ou arrêt hors de [now1, now2)
+};
+
+/*!
+ * \struct Anomalie
+ * \brief Une incohérence: sa nature, où elle a été trouvée et l'objet en cause
+ */
+struct Anomalie
+{
+    TypeAnomalie type;
+    std::string source;       //nom du fichier, ou "voyages"/"transferts" pour les données déjà chargées
+    unsigned long long ligne; //numéro de ligne dans le fichier (l'en-tête est la ligne 1), 0 pour les données chargées
+    std::string identifiant;  //identifiant de l'objet en cause (trip_id, stop_id, route_id)
+    std::string detail;
+};
+
+/*!
+ * \class RapportValidation
+ * \brief Anomalies relevées par ValidateurGTFS, triées par source, ligne et identifiant
+ */
+class RapportValidation
+{
+
+public:
+    RapportValidation();
+
+    void ajouter(const Anomalie &p_anomalie);
+    void fusionner(const std::vector<Anomalie> &p_anomalies);
+    void trier();
+
+    bool estValide() const;
+    std::size_t getNbAnomalies() const;
+    std::size_t getNbAnomalies(TypeAnomalie p_type) const;
+    const std::vector<Anomalie> &getAnomalies() const;
+
+    void afficher(RedacteurRapport &p_redacteur) const;
+    static const char *nomType(TypeAnomalie p_type);
+
+private:
+    static const std::size_t NB_TYPES = (std::size_t) TypeAnomalie::HORS_FENETRE + 1;
+
+    std::vector<Anomalie> m_anomalies;
+    std::size_t m_nbParType[NB_TYPES];
+};
+
+/*!
+ * \class ValidateurGTFS
+ * \brief Vérifie la cohérence d'un GTFS sans rien lever: chaque incohérence devient une Anomalie du rapport.
+ *
+ * Le chargement de DonneesGTFS ne fait plus ces vérifications (ordre des heures des arrêts, couleurs des lignes);
+ * elles sont regroupées ici et réparties sur un PoolTravail. validerDonnees() parcourt les voyages déjà chargés (heures, lignes, stations, services et
+ * intervalle de la date) et les transferts; validerFichiers() relit les fichiers d'un dossier GTFS pour ce que le
+ * chargement ne garde pas: identifiants en double, couleurs inconnues, références pendantes et ordre des rangées de
+ * stop_times.txt. stops.txt, routes.txt et trips.txt sont lus en parallèle, puis stop_times.txt et transfers.txt.
+ */
+class ValidateurGTFS
+{
+
+public:
+    static RapportValidation valider(const DonneesGTFS &p_donnees, const std::string &p_dossier,
+                                     unsigned int p_nbFils = 0);
+    static RapportValidation validerDonnees(const DonneesGTFS &p_donnees, unsigned int p_nbFils = 0);
+    static RapportValidation validerFichiers(const std::string &p_dossier, unsigned int p_nbFils = 0);
+};
+
+#endif //RTC_VALIDATEUR_GTFS_H
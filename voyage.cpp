@@ -4,6 +4,9 @@
 //
 
 #include "voyage.h"
+#include <algorithm>
+#include <stdexcept>
+#include "horaires_compresses.h"
 
 /*!
  * \brief Constructeur de la classes Voyage
@@ -11,21 +14,41 @@
  * \param[in] p_ligne_id : identificateur de la ligne desservie par le voyage
  * \param[in] p_service_id: identificateur du service auquel ce voyage appartient
  * \param[in] p_destination: destination du voyage
+ * \param[in] p_direction: sens du voyage sur sa ligne (direction_id, 0 ou 1)
+ * \param[in] p_bloc: identificateur du bloc (block_id) du véhicule; vide si inconnu
  */
 Voyage::Voyage(const std::string &p_id, unsigned int p_ligne_id, const std::string &p_service_id,
-               const std::string &p_destination) :
-        m_id(p_id), m_ligne(p_ligne_id), m_service_id(p_service_id), m_destination(p_destination)
+               const std::string &p_destination, unsigned int p_direction, const std::string &p_bloc) :
+        m_id(p_id), m_ligne(p_ligne_id), m_service_id(p_service_id), m_destination(p_destination),
+        m_direction(p_direction), m_bloc(p_bloc), m_precedent(nullptr), m_suivant(nullptr), m_horaires(nullptr),
+        m_motif(0), m_profil(0), m_debut(0), m_nbArrets(0)
 {
 }
 
-Voyage::Voyage()
+Voyage::Voyage() : m_ligne(0), m_direction(0), m_precedent(nullptr), m_suivant(nullptr), m_horaires(nullptr),
+                   m_motif(0), m_profil(0), m_debut(0), m_nbArrets(0)
 {
 }
 
-//! \brief retourne le conteneur m_arrets par référence constante
-const std::set<Arret::Ptr, Voyage::compArret> &Voyage::getArrets() const
+//! \brief retourne une vue sur les arrêts du voyage, triés par numéro de séquence
+//! \note la vue n'est valide que tant que le voyage existe et qu'on ne lui ajoute pas d'arrêt
+Voyage::Arrets Voyage::getArrets() const
 {
-    return m_arrets;
+    return Arrets(this);
+}
+
+/*!
+ * \brief retourne un arrêt du voyage
+ * \param[in] p_position: le rang de l'arrêt dans le voyage (0 pour le premier), et non son numéro de séquence
+ * \return l'arrêt, décodé depuis le début du profil de temps si le voyage est compressé
+ * \exception std::logic_error si le voyage a moins de p_position + 1 arrêts
+ */
+Arret Voyage::getArret(unsigned int p_position) const
+{
+    if (p_position >= getNbArrets()) throw std::logic_error("position d'arret hors du voyage");
+    Arrets::const_iterator it = getArrets().begin();
+    for (unsigned int k = 0; k < p_position; ++k) ++it;
+    return *it;
 }
 
 const std::string &Voyage::getDestination() const
@@ -33,7 +56,7 @@ const std::string &Voyage::getDestination() const
     return m_destination;
 }
 
-std::string Voyage::getId() const
+const std::string &Voyage::getId() const
 {
     return m_id;
 }
@@ -48,6 +71,41 @@ std::string Voyage::getServiceId() const
     return m_service_id;
 }
 
+unsigned int Voyage::getDirection() const
+{
+    return m_direction;
+}
+
+const std::string &Voyage::getBloc() const
+{
+    return m_bloc;
+}
+
+/*!
+ * \brief retourne le voyage effectué juste avant celui-ci par le même véhicule (même bloc)
+ * \return le voyage précédent, ou nullptr si ce voyage est le premier de son bloc ou n'a pas de bloc
+ */
+const Voyage *Voyage::getVoyagePrecedent() const
+{
+    return m_precedent;
+}
+
+/*!
+ * \brief retourne le voyage effectué juste après celui-ci par le même véhicule (même bloc)
+ * \return le voyage suivant, ou nullptr si ce voyage est le dernier de son bloc ou n'a pas de bloc
+ */
+const Voyage *Voyage::getVoyageSuivant() const
+{
+    return m_suivant;
+}
+
+//! \brief assigne les voisins du voyage dans la chaîne de son bloc
+void Voyage::setVoisinsDeBloc(const Voyage *p_precedent, const Voyage *p_suivant)
+{
+    m_precedent = p_precedent;
+    m_suivant = p_suivant;
+}
+
 /*!
  * \brief retourne l'heure de départ du voyage, ie l'heure d'arrivée du premier arret dans m_arret
  * \return l'heure de départ
@@ -56,8 +114,8 @@ std::string Voyage::getServiceId() const
  */
 Heure Voyage::getHeureDepart() const
 {
-    if (m_arrets.size() == 0) throw std::logic_error("aucun arret pour ce voyage");
-    return (*(m_arrets.begin()))->getHeureArrivee();
+    if (getNbArrets() == 0) throw std::logic_error("aucun arret pour ce voyage");
+    return getArrets().begin()->getHeureArrivee();
 }
 
 /*!
@@ -68,13 +126,44 @@ Heure Voyage::getHeureDepart() const
  */
 Heure Voyage::getHeureFin() const
 {
-    if (m_arrets.size() == 0) throw std::logic_error("aucun arret pour ce voyage");
-    return (*(--m_arrets.end()))->getHeureArrivee();
+    if (getNbArrets() == 0) throw std::logic_error("aucun arret pour ce voyage");
+    return getArret(getNbArrets() - 1).getHeureArrivee();
 }
 
-void Voyage::ajouterArret(const Arret::Ptr &p_arret)
+/*!
+ * \brief ajoute un arrêt au voyage, à son rang selon son numéro de séquence
+ * \brief Un arrêt dont le numéro de séquence est déjà présent est ignoré. Si le voyage était compressé, ses arrêts
+ * \brief redeviennent bruts jusqu'à la prochaine compression.
+ * \note La cohérence des heures avec les numéros de séquence n'est vérifiée ni ici ni au chargement:
+ * \note ValidateurGTFS la rapporte (HEURES_NON_CROISSANTES)
+ * \param[in] p_arret: l'arrêt; seuls sa station, ses heures et son numéro de séquence sont gardés
+ */
+void Voyage::ajouterArret(const Arret &p_arret)
 {
-    m_arrets.insert(p_arret);
+    decompresser();
+    ArretBrut brut = {p_arret.getStationId(), p_arret.getNumeroSequence(),
+                      p_arret.getHeureArrivee().getSecondesDepuisMinuit(),
+                      p_arret.getHeureDepart().getSecondesDepuisMinuit()};
+    auto position = std::lower_bound(m_arretsBruts.begin(), m_arretsBruts.end(), brut,
+                                     [](const ArretBrut &a, const ArretBrut &b) { return a.sequence < b.sequence; });
+    if (position == m_arretsBruts.end() || position->sequence != brut.sequence)
+        m_arretsBruts.insert(position, brut);
+}
+
+//! \brief remet les arrêts d'un voyage compressé sous forme brute, pour pouvoir en ajouter
+void Voyage::decompresser()
+{
+    if (!m_horaires) return;
+    std::vector<ArretBrut> bruts;
+    bruts.reserve(m_nbArrets);
+    for (const Arret &a : getArrets())
+    {
+        bruts.push_back({a.getStationId(), a.getNumeroSequence(), a.getHeureArrivee().getSecondesDepuisMinuit(),
+                         a.getHeureDepart().getSecondesDepuisMinuit()});
+    }
+    m_arretsBruts.swap(bruts);
+    m_horaires = nullptr;
+    m_nbArrets = 0;
 }
 
 
@@ -114,14 +203,64 @@ std::ostream &operator<<(std::ostream &flux, const Voyage &p_voyage)
 
 unsigned int Voyage::getNbArrets() const
 {
-    return (unsigned int) m_arrets.size();
+    return m_horaires ? m_nbArrets : (unsigned int) m_arretsBruts.size();
 }
 
-//! \brief //foncteur de comparaison pour les arrets de m_arrets
-bool Voyage::compArret::operator()(Arret::Ptr i, Arret::Ptr j) const
+Voyage::Arrets::Arrets(const Voyage *p_voyage) : m_voyage(p_voyage)
 {
-    bool rep = i->getNumeroSequence() < j->getNumeroSequence();
-    if (rep && i->getHeureDepart() > j->getHeureArrivee())
-        throw std::logic_error("Incohérence des numéros de séquences avec les heures");
-    return rep;
+}
+
+Voyage::Arrets::const_iterator Voyage::Arrets::begin() const
+{
+    return const_iterator(m_voyage, 0);
+}
+
+Voyage::Arrets::const_iterator Voyage::Arrets::end() const
+{
+    return const_iterator(m_voyage, m_voyage->getNbArrets());
+}
+
+std::size_t Voyage::Arrets::size() const
+{
+    return m_voyage->getNbArrets();
+}
+
+bool Voyage::Arrets::empty() const
+{
+    return m_voyage->getNbArrets() == 0;
+}
+
+Voyage::Arrets::const_iterator::const_iterator(const Voyage *p_voyage, unsigned int p_position)
+        : m_voyage(p_voyage), m_position(p_position), m_octets(nullptr)
+{
+    if (m_voyage->m_horaires && m_position == 0) m_octets = m_voyage->m_horaires->m_profils.data() + m_voyage->m_profil;
+    lire();
+}
+
+Voyage::Arrets::const_iterator &Voyage::Arrets::const_iterator::operator++()
+{
+    ++m_position;
+    lire();
+    return *this;
+}
+
+//! \brief reconstruit l'arrêt courant; dans un voyage compressé, l'arrivée suit le départ de l'arrêt précédent
+void Voyage::Arrets::const_iterator::lire()
+{
+    if (m_position >= m_voyage->getNbArrets()) return;
+
+    const HorairesCompresses *horaires = m_voyage->m_horaires;
+    if (!horaires)
+    {
+        const ArretBrut &brut = m_voyage->m_arretsBruts[m_position];
+        m_arret = Arret(brut.station, Heure(0, 0, brut.arrivee), Heure(0, 0, brut.depart), brut.sequence,
+                        m_voyage->m_id);
+        return;
+    }
+    const HorairesCompresses::ArretMotif &arret = horaires->m_arretsMotifs[m_voyage->m_motif + m_position];
+    unsigned int arrivee = m_voyage->m_debut;
+    if (m_position > 0)
+        arrivee = m_arret.getHeureDepart().getSecondesDepuisMinuit() + HorairesCompresses::decoder(m_octets);
+    const unsigned int depart = arrivee + HorairesCompresses::decoder(m_octets);
+    m_arret = Arret(arret.station, Heure(0, 0, arrivee), Heure(0, 0, depart), arret.sequence, m_voyage->m_id);
 }
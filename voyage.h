@@ -6,50 +6,129 @@
 #ifndef RTC_VOYAGE_H
 #define RTC_VOYAGE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
-#include <set>
-#include <memory>
+#include <map>
+#include <vector>
+#include "arene.h"
 #include "arret.h"
 #include "auxiliaires.h"
 
+class HorairesCompresses;
+
 /*!
  * \class Voyage
  * \brief Classe permettant de décrire un voyage
  * \note Sa déclaration nécessite la déclaration partielle des classe Ligne et Station, en raison de références circulaires avec ces classes.
+ *
+ * Les arrêts ajoutés par ajouterArret sont gardés tels quels jusqu'à ce que DonneesGTFS compresse le voyage
+ * (HorairesCompresses::compresser); ils sont ensuite lus dans le motif et le profil de temps partagés.
  */
 class Voyage {
 
 public:
 
-    struct compArret //foncteur de comparaison pour m_arrets
+    /*!
+     * \class Arrets
+     * \brief Vue sur les arrêts d'un voyage, triés par numéro de séquence, reconstruits au fil du parcours
+     * \note L'arrêt référencé par un itérateur change quand on l'avance: copier l'Arret à garder.
+     */
+    class Arrets
     {
-        bool operator() (Arret::Ptr i, Arret::Ptr j) const;
+    public:
+        class const_iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef Arret value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Arret *pointer;
+            typedef const Arret &reference;
+
+            const Arret &operator*() const { return m_arret; }
+            const Arret *operator->() const { return &m_arret; }
+            const_iterator &operator++();
+            bool operator==(const const_iterator &p_autre) const { return m_position == p_autre.m_position; }
+            bool operator!=(const const_iterator &p_autre) const { return m_position != p_autre.m_position; }
+
+        private:
+            friend class Arrets;
+            const_iterator(const Voyage *p_voyage, unsigned int p_position);
+            void lire();
+
+            const Voyage *m_voyage;
+            unsigned int m_position;
+            const std::uint8_t *m_octets; //prochain temps du profil, si le voyage est compressé
+            Arret m_arret;
+        };
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        std::size_t size() const;
+        bool empty() const;
+
+    private:
+        friend class Voyage;
+        explicit Arrets(const Voyage *p_voyage);
+        const Voyage *m_voyage;
     };
 
-    Voyage(const std::string & p_id, unsigned int p_ligne_id, const std::string & p_service_id, const std::string & p_destination);
+    Voyage(const std::string & p_id, unsigned int p_ligne_id, const std::string & p_service_id, const std::string & p_destination,
+           unsigned int p_direction = 0, const std::string & p_bloc = "");
     Voyage();
-	const std::set<Arret::Ptr, compArret> & getArrets() const;
+	Arrets getArrets() const;
+	Arret getArret(unsigned int p_position) const;
     unsigned int getNbArrets() const;
 	const std::string& getDestination() const;
-	std::string getId() const;
+	const std::string& getId() const;
 	unsigned int getLigne() const;
 	std::string getServiceId() const;
+	unsigned int getDirection() const;
+	const std::string& getBloc() const;
+	const Voyage* getVoyagePrecedent() const;
+	const Voyage* getVoyageSuivant() const;
+	void setVoisinsDeBloc(const Voyage * p_precedent, const Voyage * p_suivant);
 	Heure getHeureDepart() const;
 	Heure getHeureFin() const;
-    void ajouterArret(const Arret::Ptr & p_arret);
+    void ajouterArret(const Arret & p_arret);
 	bool operator< (const Voyage & p_other) const;
 	bool operator> (const Voyage & p_other) const;
 	friend std::ostream & operator<<(std::ostream & flux, const Voyage & p_voyage);
 
 private:
+    friend class HorairesCompresses;
+
+    struct ArretBrut //arrêt pas encore compressé, en secondes
+    {
+        unsigned int station;
+        unsigned int sequence;
+        unsigned int arrivee;
+        unsigned int depart;
+    };
+
+    void decompresser();
 
     std::string m_id;
 	unsigned int m_ligne;
 	std::string m_service_id;
 	std::string m_destination;
-	std::set<Arret::Ptr, compArret> m_arrets;
+	unsigned int m_direction;
+	std::string m_bloc; //block_id: les voyages d'un même bloc sont effectués par le même véhicule
+	const Voyage * m_precedent; //voyage précédent du même bloc, nullptr s'il n'y en a pas
+	const Voyage * m_suivant; //voyage suivant du même bloc, nullptr s'il n'y en a pas
+	const HorairesCompresses * m_horaires; //horaires qui contiennent les arrêts, nullptr tant qu'ils sont bruts
+	unsigned int m_motif;   //début du motif dans les horaires
+	unsigned int m_profil;  //début du profil de temps dans les horaires
+	unsigned int m_debut;   //heure d'arrivée au premier arrêt, en secondes
+	unsigned int m_nbArrets;
+	std::vector<ArretBrut> m_arretsBruts; //triés par numéro de séquence; vide une fois compressé
 
 };
 
+//! \brief voyages par trip_id, dont les nœuds sont puisés dans l'arène de DonneesGTFS
+typedef std::map<std::string, Voyage, std::less<std::string>, AllocateurArene<std::pair<const std::string, Voyage> > >
+        TableVoyages;
 
 #endif //RTC_VOYAGE_H